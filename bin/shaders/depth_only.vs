@@ -0,0 +1,16 @@
+#version 410 core                                                 
+                                                                 
+uniform mat4 projectionMatrix;                                    
+uniform mat4 viewMatrix;                                           
+uniform mat4 modelMatrix;                                          
+                                                                 
+in vec3 in_Position;                                               
+                                                                 
+out vec4 pass_Coordinates;                                         
+                                                                 
+void main(void)                                                   
+{                                                                 
+	// the same transformation as image_renderer.vs
+	pass_Coordinates = projectionMatrix * viewMatrix * modelMatrix * vec4(in_Position, 1.0);
+	gl_Position = pass_Coordinates;
+}
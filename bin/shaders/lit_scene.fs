@@ -10,7 +10,7 @@ in vec3 pass_Position;
 in vec4 pass_Color;   
 
 // The material parameters
-uniform struct LightSource {
+struct LightSource {
     vec3 position;
 	vec3 direction;
 	vec3 color;
@@ -21,11 +21,16 @@ uniform struct LightSource {
 	float k2;    //attenuation
 	bool used;
 	int  type;  //0:point, 1:spot, 2:directional
-} light[MAX_LIGHTS];
+};
+
+// The lights, one buffer for all programs, see cs557::LightSource
+layout(std140) uniform LightBlock {
+	LightSource light[MAX_LIGHTS];
+};
 
 
 // The material parameters
-uniform struct Material {
+struct Material {
     vec3  diffColor;
  	float diffInt;
  	vec3  ambColor;
@@ -33,7 +38,12 @@ uniform struct Material {
  	vec3  specColor;
  	float specInt;
  	float shininess;
-} mat[1];
+};
+
+// The material, one buffer for all programs, see cs557::Material
+layout(std140) uniform MaterialBlock {
+	Material mat[1];
+};
 
 
 out vec4 color;       
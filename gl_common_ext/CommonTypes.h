@@ -20,6 +20,11 @@ May 2nd, 2019, RR
 
 July 4th, 2019, RR
 - Added storage for textures
+
+Oct 19, 2026, RR
+- Material and LightSource resolve the uniform locations once per program.
+- Added uniform buffer objects for programs that declare the light and material uniform blocks. 
+- Added ReleaseProgramUniforms(), which drops the cached locations of a deleted program.
 */
 
 
@@ -32,6 +37,9 @@ July 4th, 2019, RR
 #include <string>
 #include <strstream>
 #include <sstream>
+#include <vector>
+#include <map>
+#include <cstring>
 
 // GLEW include
 #include <GL/glew.h>
@@ -49,6 +57,136 @@ July 4th, 2019, RR
 namespace cs557{
 
 
+/*
+A uniform buffer object for a std140 uniform block, shared by all programs that declare the block. 
+The buffer is bound to a fixed binding point. A copy of its content skips updates that do not change it. 
+*/
+typedef struct _UniformBlock
+{
+	std::string			name; // the name of the block in the shader code
+	unsigned int		binding; // the binding point
+	unsigned int		buffer; // the buffer object, 0 until a program uses the block
+	std::vector<char>	data; // the buffer content
+
+
+	_UniformBlock(std::string block_name, unsigned int binding_point){
+		name = block_name;
+		binding = binding_point;
+		buffer = 0;
+	}
+
+
+	/*
+	Connect the block of a program with the buffer. 
+	@param program_id - the shader program id as integer
+	@return true - if the program declares the block, false otherwise. 
+	*/
+	inline bool attach(int program_id)
+	{
+		GLuint index = glGetUniformBlockIndex(program_id, name.c_str());
+		if (index == GL_INVALID_INDEX) return false;
+
+		glUniformBlockBinding(program_id, index, binding);
+
+		GLint size = 0;
+		glGetActiveUniformBlockiv(program_id, index, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+		if (buffer == 0) glGenBuffers(1, &buffer);
+		if (size > (GLint)data.size()) {
+			data.resize(size, 0);
+			glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+			glBufferData(GL_UNIFORM_BUFFER, data.size(), &data[0], GL_DYNAMIC_DRAW);
+			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		}
+		glBindBufferBase(GL_UNIFORM_BUFFER, binding, buffer);
+		return true;
+	}
+
+
+	/*
+	Write a part of the block with one glBufferSubData call, if it changed. 
+	@param offset - the offset in bytes.
+	@param src - the data in std140 layout.
+	@param size - the size in bytes.
+	*/
+	inline void update(int offset, const void* src, int size)
+	{
+		if (offset < 0 || offset + size > (int)data.size()) return;
+		if (memcmp(&data[offset], src, size) == 0) return;
+
+		memcpy(&data[offset], src, size);
+		glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+		glBufferSubData(GL_UNIFORM_BUFFER, offset, size, src);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	}
+
+}UniformBlock;
+
+
+/*
+The light and the material block. One instance of each for the entire application. 
+*/
+inline UniformBlock& LightBlock(void) { static UniformBlock block("LightBlock", 1); return block; }
+inline UniformBlock& MaterialBlock(void) { static UniformBlock block("MaterialBlock", 2); return block; }
+
+
+/*
+The uniform locations of a shader program, resolved once per program. 
+*/
+typedef struct _ProgramUniforms
+{
+	bool							with_light_block;
+	bool							with_material_block;
+	std::vector<int>				mat; // the locations of mat[0], empty until the first material is applied
+	std::map<int, std::vector<int> > light; // the locations per light index
+
+	_ProgramUniforms(){
+		with_light_block = false;
+		with_material_block = false;
+	}
+
+}ProgramUniforms;
+
+
+/*
+The uniform locations of all programs, by program id.
+*/
+inline std::map<int, ProgramUniforms>& ProgramUniformsTable(void)
+{
+	static std::map<int, ProgramUniforms> programs;
+	return programs;
+}
+
+
+/*
+Forget the uniform locations of a program. The driver can give the id of a deleted program 
+to the next program, so call it after glDeleteProgram() or after linking the program again.
+CreateShaderProgram() and DeleteShaderProgram() in ShaderProgram.h call it.
+@param program_id - the shader program id as integer
+*/
+inline void ReleaseProgramUniforms(int program_id)
+{
+	ProgramUniformsTable().erase(program_id);
+}
+
+
+/*
+Return the uniform locations of a shader program. The first call connects the uniform blocks of the program.
+@param program_id - the shader program id as integer
+*/
+inline ProgramUniforms& GetProgramUniforms(int program_id)
+{
+	std::map<int, ProgramUniforms>& programs = ProgramUniformsTable();
+
+	auto it = programs.find(program_id);
+	if (it == programs.end()) {
+		it = programs.insert(std::make_pair(program_id, ProgramUniforms())).first;
+		it->second.with_light_block = LightBlock().attach(program_id);
+		it->second.with_material_block = MaterialBlock().attach(program_id);
+	}
+	return it->second;
+}
+
+
 /*
 This struct is a helper which contains material data. 
 Note that this struct expects to find a struct datatype in the glsl
@@ -118,15 +256,37 @@ typedef struct Material
     */
     inline void apply(int program_id )
     {
+        ProgramUniforms& u = GetProgramUniforms(program_id);
+
+        // the material block in std140 layout
+        if(u.with_material_block){
+            float block[13];
+            memcpy(&block[0], &diffuse_mat[0], 3 * sizeof(float)); block[3] = diffuse_int;
+            memcpy(&block[4], &ambient_mat[0], 3 * sizeof(float)); block[7] = ambient_int;
+            memcpy(&block[8], &specular_mat[0], 3 * sizeof(float)); block[11] = specular_int;
+            block[12] = specular_s;
+            MaterialBlock().update(0, block, sizeof(block));
+            return;
+        }
 
+        // the uniform variables, the locations are resolved with the first call for this program
+        if(u.mat.empty()){
+            const char* names[7] = {"mat[0].diffColor", "mat[0].diffInt", "mat[0].ambColor", "mat[0].ambInt", "mat[0].specColor", "mat[0].specInt", "mat[0].shininess"};
+            for(int i=0; i<7; i++){
+                checkName(program_id, names[i]);
+                u.mat.push_back(glGetUniformLocation(program_id, names[i]));
+            }
+        }
+
+        // location -1 is ignored by glUniform
         glUseProgram(program_id );
-        if(checkName(program_id, "mat[0].diffColor")) glUniform3fv(glGetUniformLocation(program_id , "mat[0].diffColor"), 1, &diffuse_mat[0]);
-        if(checkName(program_id, "mat[0].diffInt")) glUniform1f(glGetUniformLocation(program_id , "mat[0].diffInt"), diffuse_int);
-        if(checkName(program_id, "mat[0].ambColor")) glUniform3fv(glGetUniformLocation(program_id , "mat[0].ambColor"), 1, &ambient_mat[0]);
-        if(checkName(program_id, "mat[0].ambInt")) glUniform1f(glGetUniformLocation(program_id , "mat[0].ambInt"), ambient_int);
-        if(checkName(program_id, "mat[0].specColor")) glUniform3fv(glGetUniformLocation(program_id , "mat[0].specColor"), 1, &specular_mat[0]);
-        if(checkName(program_id, "mat[0].specInt")) glUniform1f(glGetUniformLocation(program_id , "mat[0].specInt"), specular_int);
-        if(checkName(program_id, "mat[0].shininess")) glUniform1f(glGetUniformLocation(program_id , "mat[0].shininess"), specular_s);
+        glUniform3fv(u.mat[0], 1, &diffuse_mat[0]);
+        glUniform1f(u.mat[1], diffuse_int);
+        glUniform3fv(u.mat[2], 1, &ambient_mat[0]);
+        glUniform1f(u.mat[3], ambient_int);
+        glUniform3fv(u.mat[4], 1, &specular_mat[0]);
+        glUniform1f(u.mat[5], specular_int);
+        glUniform1f(u.mat[6], specular_s);
 
         glUseProgram(0);
     }
@@ -260,17 +420,49 @@ typedef struct _LightSource
 		}
 
 
+        ProgramUniforms& u = GetProgramUniforms(shader_program_id);
+
+        // light[index] of the light block in std140 layout, 80 bytes per light
+        if(u.with_light_block){
+            float block[18];
+            int32_t flags[2] = { (int32_t)used, (int32_t)type };
+            memset(block, 0, sizeof(block));
+            memcpy(&block[0], &pos[0], 3 * sizeof(float));
+            memcpy(&block[4], &dir[0], 3 * sizeof(float));
+            memcpy(&block[8], &color[0], 3 * sizeof(float));
+            block[11] = intensity;
+            block[12] = cutoff_in;
+            block[13] = cutoff_out;
+            block[14] = k1;
+            block[15] = k2;
+            memcpy(&block[16], flags, sizeof(flags));
+            LightBlock().update(index * 80, block, sizeof(block));
+            return;
+        }
+
+        // the uniform variables, the locations are resolved with the first call for this program and index
+        std::vector<int>& loc = u.light[index];
+        if(loc.empty()){
+            const char* names[10] = {"position", "direction", "color", "intensity", "used", "type", "cutoff_in", "cutoff_out", "k1", "k2"};
+            for(int i=0; i<10; i++){
+                std::string name = getVariableName("light", index, names[i]);
+                checkName(shader_program_id, name);
+                loc.push_back(glGetUniformLocation(shader_program_id, name.c_str()));
+            }
+        }
+
+        // location -1 is ignored by glUniform
         glUseProgram(shader_program_id );
-        if(checkName(shader_program_id, getVariableName("light", index, "position") )) glUniform3fv(glGetUniformLocation(shader_program_id , getVariableName("light", index, "position").c_str()), 1, &pos[0]);
-        if(checkName(shader_program_id, getVariableName("light", index, "direction") )) glUniform3fv(glGetUniformLocation(shader_program_id , getVariableName("light", index, "direction").c_str()), 1, &dir[0]);
-        if(checkName(shader_program_id, getVariableName("light", index, "color") )) glUniform3fv(glGetUniformLocation(shader_program_id , getVariableName("light", index, "color").c_str()), 1, &color[0]);
-        if(checkName(shader_program_id, getVariableName("light", index, "intensity") )) glUniform1f(glGetUniformLocation(shader_program_id , getVariableName("light", index, "intensity").c_str()), intensity);
-        if(checkName(shader_program_id, getVariableName("light", index, "used") )) glUniform1i(glGetUniformLocation(shader_program_id , getVariableName("light", index, "used").c_str()), (int)used);
-        if(checkName(shader_program_id, getVariableName("light", index, "type") )) glUniform1i(glGetUniformLocation(shader_program_id , getVariableName("light", index, "type").c_str()), (int)type);
-        if(checkName(shader_program_id, getVariableName("light", index, "cutoff_in") )) glUniform1f(glGetUniformLocation(shader_program_id , getVariableName("light", index, "cutoff_in").c_str()), cutoff_in);
-        if(checkName(shader_program_id, getVariableName("light", index, "cutoff_out") )) glUniform1f(glGetUniformLocation(shader_program_id , getVariableName("light", index, "cutoff_out").c_str()), cutoff_out);
-        if(checkName(shader_program_id, getVariableName("light", index, "k1") )) glUniform1f(glGetUniformLocation(shader_program_id , getVariableName("light", index, "k1").c_str()), k1);
-        if(checkName(shader_program_id, getVariableName("light", index, "k2") )) glUniform1f(glGetUniformLocation(shader_program_id , getVariableName("light", index, "k2").c_str()), k2);
+        glUniform3fv(loc[0], 1, &pos[0]);
+        glUniform3fv(loc[1], 1, &dir[0]);
+        glUniform3fv(loc[2], 1, &color[0]);
+        glUniform1f(loc[3], intensity);
+        glUniform1i(loc[4], (int)used);
+        glUniform1i(loc[5], (int)type);
+        glUniform1f(loc[6], cutoff_in);
+        glUniform1f(loc[7], cutoff_out);
+        glUniform1f(loc[8], k1);
+        glUniform1f(loc[9], k2);
         glUseProgram(0);
     }
 
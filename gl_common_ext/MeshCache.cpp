@@ -0,0 +1,280 @@
+#include "MeshCache.h"
+#include "FileUtils.h"
+
+#include <cstring>
+#include <cstdio>
+
+
+namespace cs557_MeshCache
+{
+	const char magic[8] = { 'S', 'F', 'M', 'E', 'S', 'H', '\0', '\0' };
+	const uint32_t version = 4; // increase if the format, the OBJParser output, the mesh optimization, or the simplification changes
+	const uint32_t byte_order = 0x01020304;
+	const uint32_t max_string = 1 << 16;
+
+
+	void WriteValue(std::ofstream& out, const void* value, size_t size)
+	{
+		out.write((const char*)value, size);
+	}
+
+	bool ReadValue(std::ifstream& in, void* value, size_t size)
+	{
+		in.read((char*)value, size);
+		return in.gcount() == (std::streamsize)size;
+	}
+
+	void WriteString(std::ofstream& out, const std::string& s)
+	{
+		uint32_t n = (uint32_t)s.size();
+		WriteValue(out, &n, sizeof(n));
+		out.write(s.data(), n);
+	}
+
+	bool ReadString(std::ifstream& in, std::string& s)
+	{
+		uint32_t n = 0;
+		if (!ReadValue(in, &n, sizeof(n)) || n > max_string) return false;
+		s.resize(n);
+		return n == 0 || ReadValue(in, &s[0], n);
+	}
+
+	// raw arrays of trivially copyable elements, prefixed with the number of elements
+	template<typename T>
+	void WriteArray(std::ofstream& out, const std::vector<T>& v)
+	{
+		uint64_t n = v.size();
+		WriteValue(out, &n, sizeof(n));
+		if (n > 0) out.write((const char*)v.data(), n * sizeof(T));
+	}
+
+	template<typename T>
+	bool ReadArray(std::ifstream& in, std::vector<T>& v, uint64_t remaining)
+	{
+		uint64_t n = 0;
+		if (!ReadValue(in, &n, sizeof(n)) || n > remaining / sizeof(T)) return false;
+		v.resize((size_t)n);
+		return n == 0 || ReadValue(in, v.data(), (size_t)n * sizeof(T));
+	}
+
+	void WriteVector3(std::ofstream& out, const objl::Vector3& v)
+	{
+		float f[3] = { v.X, v.Y, v.Z };
+		WriteValue(out, f, sizeof(f));
+	}
+
+	bool ReadVector3(std::ifstream& in, objl::Vector3& v)
+	{
+		float f[3];
+		if (!ReadValue(in, f, sizeof(f))) return false;
+		v = objl::Vector3(f[0], f[1], f[2]);
+		return true;
+	}
+
+	void WriteMaterial(std::ofstream& out, const objl::Material& m)
+	{
+		WriteString(out, m.name);
+		WriteVector3(out, m.Ka);
+		WriteVector3(out, m.Kd);
+		WriteVector3(out, m.Ks);
+		WriteValue(out, &m.Ns, sizeof(m.Ns));
+		WriteValue(out, &m.Ni, sizeof(m.Ni));
+		WriteValue(out, &m.d, sizeof(m.d));
+		int32_t illum = m.illum;
+		WriteValue(out, &illum, sizeof(illum));
+		WriteString(out, m.map_Ka);
+		WriteString(out, m.map_Kd);
+		WriteString(out, m.map_Ks);
+		WriteString(out, m.map_Ns);
+		WriteString(out, m.map_d);
+		WriteString(out, m.map_bump);
+	}
+
+	bool ReadMaterial(std::ifstream& in, objl::Material& m)
+	{
+		int32_t illum = 0;
+		bool ok = ReadString(in, m.name) && ReadVector3(in, m.Ka) && ReadVector3(in, m.Kd) && ReadVector3(in, m.Ks) &&
+			ReadValue(in, &m.Ns, sizeof(m.Ns)) && ReadValue(in, &m.Ni, sizeof(m.Ni)) && ReadValue(in, &m.d, sizeof(m.d)) &&
+			ReadValue(in, &illum, sizeof(illum)) &&
+			ReadString(in, m.map_Ka) && ReadString(in, m.map_Kd) && ReadString(in, m.map_Ks) &&
+			ReadString(in, m.map_Ns) && ReadString(in, m.map_d) && ReadString(in, m.map_bump);
+		m.illum = illum;
+		return ok;
+	}
+
+}
+
+using namespace cs557_MeshCache;
+
+
+bool cs557::MeshCache::_enabled = true;
+
+
+/*!
+Read the cache of a model.
+*/
+//static
+bool cs557::MeshCache::Read(const std::string& path_and_file, MeshData& data)
+{
+	if (!_enabled) return false;
+
+	std::ifstream in(CacheFile(path_and_file), std::ios::binary);
+	if (!in.is_open()) return false;
+
+	in.seekg(0, std::ios::end);
+	uint64_t file_size = (uint64_t)in.tellg();
+	in.seekg(0, std::ios::beg);
+
+	// header
+	char m[8];
+	uint32_t v = 0, b = 0, vertex_size = 0;
+	if (!ReadValue(in, m, sizeof(m)) || memcmp(m, magic, sizeof(m)) != 0 ||
+		!ReadValue(in, &v, sizeof(v)) || v != version ||
+		!ReadValue(in, &b, sizeof(b)) || b != byte_order ||
+		!ReadValue(in, &vertex_size, sizeof(vertex_size)) || vertex_size != sizeof(std::pair<glm::vec3, glm::vec2>)) {
+		return false;
+	}
+
+	// the key: the hashes of the obj file and the material files
+	uint64_t hash = 0, cached_hash = 0;
+	if (!ReadValue(in, &cached_hash, sizeof(cached_hash)) || !FileUtils::HashFile(path_and_file, hash) || hash != cached_hash) {
+		return false;
+	}
+	uint32_t num_libraries = 0;
+	if (!ReadValue(in, &num_libraries, sizeof(num_libraries)) || num_libraries > max_string) return false;
+	data.libraries.resize(num_libraries);
+	for (uint32_t i = 0; i < num_libraries; i++) {
+		if (!ReadString(in, data.libraries[i]) || !ReadValue(in, &cached_hash, sizeof(cached_hash))) return false;
+		// a missing material file has the hash 0
+		hash = 0;
+		FileUtils::HashFile(data.libraries[i], hash);
+		if (hash != cached_hash) return false;
+	}
+
+	// the model
+	if (!ReadValue(in, &data.boundingbox[0], sizeof(glm::vec3)) || !ReadValue(in, &data.centroid[0], sizeof(glm::vec3)) ||
+		!ReadArray(in, data.points, file_size) ||
+		!ReadArray(in, data.normals, file_size) ||
+		!ReadArray(in, data.indices, file_size) ||
+		data.normals.size() != data.points.size()) {
+		return false;
+	}
+
+	uint32_t num_meshes = 0;
+	if (!ReadValue(in, &num_meshes, sizeof(num_meshes)) || num_meshes > data.indices.size()) return false;
+	data.meshes.resize(num_meshes);
+	for (uint32_t i = 0; i < num_meshes; i++) {
+		OBJParser::OBJRange& r = data.meshes[i];
+		int32_t range[2];
+		if (!ReadString(in, r.name) || !ReadValue(in, range, sizeof(range)) || !ReadMaterial(in, r.material)) return false;
+		r.start = range[0];
+		r.count = range[1];
+		if (r.start < 0 || r.count < 0 || (size_t)r.start + (size_t)r.count > data.indices.size()) return false;
+	}
+
+	uint32_t num_lods = 0;
+	if (!ReadValue(in, &num_lods, sizeof(num_lods)) || num_lods > 64) return false;
+	data.lods.resize(num_lods);
+	for (uint32_t i = 0; i < num_lods; i++) {
+		MeshSimplifier::LOD& l = data.lods[i];
+		if (!ReadValue(in, &l.error, sizeof(l.error)) ||
+			!ReadArray(in, l.start, file_size) || !ReadArray(in, l.count, file_size) ||
+			l.start.size() != num_meshes || l.count.size() != num_meshes) {
+			return false;
+		}
+		for (uint32_t j = 0; j < num_meshes; j++) {
+			if (l.start[j] < 0 || l.count[j] < 0 || (size_t)l.start[j] + (size_t)l.count[j] > data.indices.size()) return false;
+		}
+	}
+
+	// a broken index must not reach the GPU
+	int N = (int)data.points.size();
+	for (int i : data.indices) {
+		if (i < 0 || i >= N) return false;
+	}
+
+	return true;
+}
+
+
+/*!
+Write the cache of a model.
+*/
+//static
+bool cs557::MeshCache::Write(const std::string& path_and_file, const MeshData& data)
+{
+	if (!_enabled) return false;
+
+	uint64_t hash = 0;
+	if (!FileUtils::HashFile(path_and_file, hash)) return false;
+
+	std::string file = CacheFile(path_and_file);
+	bool ok = FileUtils::WriteAtomic(file, [&](std::ofstream& out) {
+		// header
+		uint32_t vertex_size = sizeof(std::pair<glm::vec3, glm::vec2>);
+		WriteValue(out, magic, sizeof(magic));
+		WriteValue(out, &version, sizeof(version));
+		WriteValue(out, &byte_order, sizeof(byte_order));
+		WriteValue(out, &vertex_size, sizeof(vertex_size));
+
+		// the key
+		WriteValue(out, &hash, sizeof(hash));
+		uint32_t num_libraries = (uint32_t)data.libraries.size();
+		WriteValue(out, &num_libraries, sizeof(num_libraries));
+		for (auto& l : data.libraries) {
+			hash = 0;
+			FileUtils::HashFile(l, hash);
+			WriteString(out, l);
+			WriteValue(out, &hash, sizeof(hash));
+		}
+
+		// the model
+		WriteValue(out, &data.boundingbox[0], sizeof(glm::vec3));
+		WriteValue(out, &data.centroid[0], sizeof(glm::vec3));
+		WriteArray(out, data.points);
+		WriteArray(out, data.normals);
+		WriteArray(out, data.indices);
+
+		uint32_t num_meshes = (uint32_t)data.meshes.size();
+		WriteValue(out, &num_meshes, sizeof(num_meshes));
+		for (auto& r : data.meshes) {
+			int32_t range[2] = { r.start, r.count };
+			WriteString(out, r.name);
+			WriteValue(out, range, sizeof(range));
+			WriteMaterial(out, r.material);
+		}
+
+		uint32_t num_lods = (uint32_t)data.lods.size();
+		WriteValue(out, &num_lods, sizeof(num_lods));
+		for (auto& l : data.lods) {
+			WriteValue(out, &l.error, sizeof(l.error));
+			WriteArray(out, l.start);
+			WriteArray(out, l.count);
+		}
+	});
+
+	if (!ok) {
+		std::cout << "[WARNING] - MeshCache: cannot write the cache file " << file << "." << std::endl;
+	}
+	return ok;
+}
+
+
+/*!
+Return the cache file of a model.
+*/
+//static
+std::string cs557::MeshCache::CacheFile(const std::string& path_and_file)
+{
+	return path_and_file + ".meshcache";
+}
+
+
+/*!
+Enable or disable the cache.
+*/
+//static
+void cs557::MeshCache::SetEnabled(bool enable)
+{
+	_enabled = enable;
+}
@@ -0,0 +1,117 @@
+#pragma once
+/*
+@class MeshCache
+@brief	A binary cache for preprocessed obj models.
+
+The first load of a model writes the GPU-ready mesh into a file next to the model,
+e.g., model.obj -> model.obj.meshcache. The next loads read this file instead of parsing the obj file.
+The cache stores:
+- the interleaved vertex positions and texture coordinates, and the normals, as 32-bit floats,
+- the index buffer, optimized by the MeshOptimizer, and the meshes as index ranges, with their materials,
+- the levels of detail of the MeshSimplifier, as index ranges,
+- the bounding box and the centroid.
+The vertices are already moved to the center of the bounding box.
+
+A cache file is valid if its format version matches and if the content hashes of the obj file
+and of all its .mtl files, see FileUtils::HashFile(), did not change. Invalid or unreadable cache files are ignored and rewritten.
+Increase the version in MeshCache.cpp whenever the format, the OBJParser output, the mesh optimization, or the simplification changes.
+
+Usage:
+cs557::MeshCache::MeshData mesh;
+if (!cs557::MeshCache::Read("model.obj", mesh)) {
+	// parse the model and fill mesh
+	cs557::MeshCache::Write("model.obj", mesh);
+}
+
+Rafael Radkowski
+Iowa State University
+rafael@iastate.edu
+515 294 7044
+MIT License
+-------------------------------------------------------------------------------------------------------
+Last edited:
+
+
+*/
+
+// stl
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// glm
+#include <glm/glm.hpp>
+
+// local
+#include "OBJParser.h"
+#include "MeshSimplifier.h"
+
+
+namespace cs557
+{
+
+class MeshCache
+{
+public:
+
+	/*
+	The preprocessed model.
+	*/
+	typedef struct _MeshData {
+		std::vector<std::pair<glm::vec3, glm::vec2> >	points; // position and texture coordinate per vertex
+		std::vector<glm::vec3>							normals;
+		std::vector<int>								indices; // three per triangle
+		std::vector<OBJParser::OBJRange>				meshes;
+		std::vector<MeshSimplifier::LOD>				lods; // level 0 is the original mesh, empty if not built
+		std::vector<std::string>						libraries; // the .mtl files, part of the cache key
+		glm::vec3										boundingbox; // bounding box size
+		glm::vec3										centroid;
+
+		_MeshData()
+		{
+			boundingbox = glm::vec3(0.0f);
+			centroid = glm::vec3(0.0f);
+		}
+	}MeshData;
+
+
+	/*!
+	Read the cache of a model.
+	@param path_and_file - the relative or absolute path and file of the obj model.
+	@param data - location for the model.
+	@return - true, if a valid cache exists. false if the cache is missing, outdated, or broken.
+	*/
+	static bool Read(const std::string& path_and_file, MeshData& data);
+
+
+	/*!
+	Write the cache of a model.
+	@param path_and_file - the relative or absolute path and file of the obj model.
+	@param data - the preprocessed model.
+	@return - true, if the cache was written.
+	*/
+	static bool Write(const std::string& path_and_file, const MeshData& data);
+
+
+	/*!
+	Return the cache file of a model.
+	@param path_and_file - the relative or absolute path and file of the obj model.
+	*/
+	static std::string CacheFile(const std::string& path_and_file);
+
+
+	/*!
+	Enable or disable the cache. It is enabled by default.
+	@param enable - true enables the cache.
+	*/
+	static void SetEnabled(bool enable);
+
+
+private:
+
+	static bool		_enabled;
+};
+
+}//namespace cs557
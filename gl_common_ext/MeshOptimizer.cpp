@@ -0,0 +1,256 @@
+#include "MeshOptimizer.h"
+
+#include <cmath>
+#include <algorithm>
+
+
+namespace cs557_MeshOptimizer
+{
+	// parameters of the Forsyth algorithm
+	const int cache_size = 32;
+	const float cache_decay_power = 1.5f;
+	const float last_triangle_score = 0.75f;
+	const float valence_boost_scale = 2.0f;
+	const float valence_boost_power = 0.5f;
+
+	const int max_valence = 64; // vertices with more triangles use the score of this valence
+
+	/*
+	Tables of the score parts, pow() is too slow for the inner loop.
+	*/
+	struct ScoreTables
+	{
+		float cache[cache_size];
+		float valence[max_valence + 1];
+
+		ScoreTables()
+		{
+			for (int i = 0; i < cache_size; i++) {
+				if (i < 3) {
+					// the vertices of the last triangle; a fixed score avoids to prefer the same triangle strip direction
+					cache[i] = last_triangle_score;
+				}
+				else {
+					cache[i] = pow(1.0f - float(i - 3) / float(cache_size - 3), cache_decay_power);
+				}
+			}
+			valence[0] = 0.0f;
+			for (int i = 1; i <= max_valence; i++) {
+				// vertices with few remaining triangles first, to avoid lonely triangles at the end
+				valence[i] = valence_boost_scale * pow(float(i), -valence_boost_power);
+			}
+		}
+	};
+
+	const ScoreTables tables;
+
+	/*
+	Score of a vertex from its position in the simulated cache and its number of remaining triangles.
+	*/
+	inline float VertexScore(int cache_position, int remaining)
+	{
+		if (remaining == 0) return -1.0f; // no triangle left
+		float score = cache_position >= 0 ? tables.cache[cache_position] : 0.0f;
+		return score + tables.valence[(std::min)(remaining, max_valence)];
+	}
+}
+
+using namespace cs557_MeshOptimizer;
+
+
+/*!
+Reorder the triangles of an index range for the post-transform vertex cache.
+*/
+//static
+void cs557::MeshOptimizer::OptimizeVertexCache(std::vector<int>& indices, int start, int count, std::vector<int>& local)
+{
+	int T = count / 3;
+	if (T < 2 || start < 0 || start + count > (int)indices.size()) return;
+	const int* tri = &indices[start];
+
+	// local vertex ids for the vertices of this range. 
+	// The scratch buffer is shared by all ranges; only the entries of this range are reset at the end. 
+	std::vector<int> global;
+	for (int i = 0; i < T * 3; i++) {
+		if (local[tri[i]] == -1) {
+			local[tri[i]] = (int)global.size();
+			global.push_back(tri[i]);
+		}
+	}
+	int V = (int)global.size();
+
+	// the triangles of each vertex
+	std::vector<int> offset(V + 1, 0);
+	for (int i = 0; i < T * 3; i++) offset[local[tri[i]] + 1]++;
+	for (int v = 0; v < V; v++) offset[v + 1] += offset[v];
+	std::vector<int> adjacency(T * 3);
+	std::vector<int> fill(offset.begin(), offset.end() - 1);
+	for (int t = 0; t < T; t++) {
+		for (int k = 0; k < 3; k++) adjacency[fill[local[tri[3 * t + k]]]++] = t;
+	}
+
+	std::vector<int> remaining(V);
+	std::vector<int> cache_position(V, -1);
+	std::vector<float> vertex_score(V);
+	for (int v = 0; v < V; v++) {
+		remaining[v] = offset[v + 1] - offset[v];
+		vertex_score[v] = VertexScore(-1, remaining[v]);
+	}
+
+	std::vector<float> triangle_score(T);
+	std::vector<bool> emitted(T, false);
+	for (int t = 0; t < T; t++) {
+		triangle_score[t] = vertex_score[local[tri[3 * t]]] + vertex_score[local[tri[3 * t + 1]]] + vertex_score[local[tri[3 * t + 2]]];
+	}
+
+	std::vector<int> result;
+	result.reserve(T * 3);
+	std::vector<int> cache; // local vertex ids, most recent first
+	std::vector<int> new_cache;
+	cache.reserve(cache_size + 3);
+	new_cache.reserve(cache_size + 3);
+
+	int best = (int)(std::max_element(triangle_score.begin(), triangle_score.end()) - triangle_score.begin());
+	int scan = 0; // all triangles before scan are emitted
+
+	for (int n = 0; n < T; n++) {
+
+		// no candidate from the cache, take the next remaining triangle.
+		// A search for the best triangle would be quadratic for meshes with many separate parts.
+		if (best < 0) {
+			while (scan < T && emitted[scan]) scan++;
+			best = scan;
+		}
+
+		// emit the triangle
+		emitted[best] = true;
+		int v3[3];
+		for (int k = 0; k < 3; k++) {
+			int g = tri[3 * best + k];
+			result.push_back(g);
+			int v = local[g];
+			v3[k] = v;
+
+			// remove the triangle from the vertex
+			int* a = &adjacency[offset[v]];
+			int r = remaining[v];
+			for (int i = 0; i < r; i++) {
+				if (a[i] == best) {
+					std::swap(a[i], a[r - 1]);
+					break;
+				}
+			}
+			remaining[v]--;
+		}
+
+		// the new cache: the vertices of the triangle first, then the old cache
+		new_cache.assign(v3, v3 + 3);
+		for (int v : cache) {
+			if (v != v3[0] && v != v3[1] && v != v3[2]) new_cache.push_back(v);
+		}
+		cache.swap(new_cache);
+
+		// update the scores of the cached vertices and of their triangles
+		for (int i = 0; i < (int)cache.size(); i++) {
+			int v = cache[i];
+			cache_position[v] = i < cache_size ? i : -1;
+			float score = VertexScore(cache_position[v], remaining[v]);
+			float delta = score - vertex_score[v];
+			vertex_score[v] = score;
+			for (int j = offset[v]; j < offset[v] + remaining[v]; j++) triangle_score[adjacency[j]] += delta;
+		}
+		if ((int)cache.size() > cache_size) cache.resize(cache_size);
+
+		// the next triangle: the best triangle of the cached vertices
+		best = -1;
+		float best_score = -1.0f;
+		for (int v : cache) {
+			for (int j = offset[v]; j < offset[v] + remaining[v]; j++) {
+				int t = adjacency[j];
+				if (triangle_score[t] > best_score) {
+					best_score = triangle_score[t];
+					best = t;
+				}
+			}
+		}
+	}
+
+	std::copy(result.begin(), result.end(), indices.begin() + start);
+
+	for (int g : global) local[g] = -1;
+}
+
+
+/*!
+Renumber the vertices in the order of their first use in the index buffer.
+*/
+//static
+int cs557::MeshOptimizer::OptimizeVertexFetch(std::vector<std::pair<glm::vec3, glm::vec2> >& points, std::vector<glm::vec3>& normals, std::vector<int>& indices)
+{
+	int N = (int)points.size();
+	std::vector<int> remap(N, -1);
+	int count = 0;
+	for (int& i : indices) {
+		if (remap[i] == -1) remap[i] = count++;
+		i = remap[i];
+	}
+
+	std::vector<std::pair<glm::vec3, glm::vec2> > new_points(count);
+	std::vector<glm::vec3> new_normals(count);
+	for (int i = 0; i < N; i++) {
+		if (remap[i] == -1) continue;
+		new_points[remap[i]] = points[i];
+		new_normals[remap[i]] = normals[i];
+	}
+	points.swap(new_points);
+	normals.swap(new_normals);
+
+	return count;
+}
+
+
+/*!
+Order the meshes by material name and move their index ranges into the same order.
+*/
+//static
+void cs557::MeshOptimizer::SortByMaterial(std::vector<int>& indices, std::vector<OBJParser::OBJRange>& meshes)
+{
+	std::stable_sort(meshes.begin(), meshes.end(), [](const OBJParser::OBJRange& a, const OBJParser::OBJRange& b) {
+		return a.material.name < b.material.name;
+	});
+
+	std::vector<int> new_indices;
+	new_indices.reserve(indices.size());
+	for (auto& m : meshes) {
+		int start = (int)new_indices.size();
+		new_indices.insert(new_indices.end(), indices.begin() + m.start, indices.begin() + m.start + m.count);
+		m.start = start;
+	}
+	indices.swap(new_indices);
+}
+
+
+/*!
+Convert the vertices into the packed vertex format.
+*/
+//static
+void cs557::MeshOptimizer::Pack(const std::vector<std::pair<glm::vec3, glm::vec2> >& points, const std::vector<glm::vec3>& normals, std::vector<PackedVertex>& vertices)
+{
+	int N = (int)points.size();
+	vertices.resize(N);
+
+	for (int i = 0; i < N; i++) {
+		PackedVertex& p = vertices[i];
+		p.x = points[i].first.x;
+		p.y = points[i].first.y;
+		p.z = points[i].first.z;
+		p.u = points[i].second.x;
+		p.v = points[i].second.y;
+
+		glm::vec3 n = i < normals.size() ? normals[i] : glm::vec3(0.0f);
+		p.nx = (int16_t)floor((std::min)((std::max)(n.x, -1.0f), 1.0f) * 32767.0f + 0.5f);
+		p.ny = (int16_t)floor((std::min)((std::max)(n.y, -1.0f), 1.0f) * 32767.0f + 0.5f);
+		p.nz = (int16_t)floor((std::min)((std::max)(n.z, -1.0f), 1.0f) * 32767.0f + 0.5f);
+		p.nw = 0;
+	}
+}
@@ -0,0 +1,96 @@
+#pragma once
+/*
+@class MeshOptimizer
+@brief	Prepares an indexed triangle mesh for fast vertex processing.
+
+- OptimizeVertexCache() reorders the triangles of an index range for the post-transform vertex cache
+  (Tom Forsyth, Linear-Speed Vertex Cache Optimisation, 2006). Neighboring triangles reuse the
+  transformed vertices, so the vertex shader runs less often per triangle.
+- OptimizeVertexFetch() renumbers the vertices in the order of their first use, so that
+  the vertex fetch reads the vertex buffer almost sequentially. Unused vertices are removed.
+- SortByMaterial() orders the meshes by material, so that the meshes of one material are adjacent
+  in the index buffer and can be drawn with one call.
+- Pack() converts the vertices into the PackedVertex format of CreateVertexObjectsIndexedPacked (VertexBuffers.h):
+  32-bit float positions and texture coordinates, and 16-bit normalized normal vectors.
+  Positions, texture coordinates, and normals keep the precision of the rendered depth, color, and normal images.
+
+The identical vertices must be merged before, e.g., by the OBJParser.
+
+Usage:
+MeshOptimizer::SortByMaterial(indices, meshes);
+std::vector<int> scratch(points.size(), -1);
+MeshOptimizer::OptimizeVertexCache(indices, 0, indices.size(), scratch);
+MeshOptimizer::OptimizeVertexFetch(points, normals, indices);
+MeshOptimizer::Pack(points, normals, vertices);
+
+Rafael Radkowski
+Iowa State University
+rafael@iastate.edu
+515 294 7044
+MIT License
+-------------------------------------------------------------------------------------------------------
+Last edited:
+Oct 19, 2026, RR
+- OptimizeVertexCache() takes a per-model scratch buffer instead of allocating one per mesh range.
+*/
+
+// stl
+#include <iostream>
+#include <vector>
+#include <cstdint>
+
+// glm
+#include <glm/glm.hpp>
+
+// local
+#include "VertexBuffers.h"
+#include "OBJParser.h"
+
+
+namespace cs557
+{
+
+class MeshOptimizer
+{
+public:
+
+	/*!
+	Reorder the triangles of an index range for the post-transform vertex cache.
+	@param indices - the index buffer, three indices per triangle. The function reorders the triangles in place.
+	@param start - the first index of the range.
+	@param count - the number of indices of the range.
+	@param local - scratch buffer with one entry of -1 per vertex. Allocate it once per model and pass it 
+					to all ranges; the function resets the entries it uses to -1.
+	*/
+	static void OptimizeVertexCache(std::vector<int>& indices, int start, int count, std::vector<int>& local);
+
+
+	/*!
+	Renumber the vertices in the order of their first use in the index buffer.
+	@param points - the positions and texture coordinates. Reordered in place.
+	@param normals - the normal vectors. Reordered in place.
+	@param indices - the index buffer, updated to the new vertex order.
+	@return - the number of vertices after unused vertices are removed.
+	*/
+	static int OptimizeVertexFetch(std::vector<std::pair<glm::vec3, glm::vec2> >& points, std::vector<glm::vec3>& normals, std::vector<int>& indices);
+
+
+	/*!
+	Order the meshes by material name and move their index ranges into the same order.
+	The order of meshes with the same material does not change.
+	@param indices - the index buffer. Indices outside of all meshes are removed.
+	@param meshes - the meshes as ranges of the index buffer. Sorted in place.
+	*/
+	static void SortByMaterial(std::vector<int>& indices, std::vector<OBJParser::OBJRange>& meshes);
+
+
+	/*!
+	Convert the vertices into the packed vertex format.
+	@param points - the positions and texture coordinates.
+	@param normals - the normal vectors.
+	@param vertices - location for the packed vertices.
+	*/
+	static void Pack(const std::vector<std::pair<glm::vec3, glm::vec2> >& points, const std::vector<glm::vec3>& normals, std::vector<PackedVertex>& vertices);
+};
+
+}//namespace cs557
@@ -0,0 +1,439 @@
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+
+
+namespace cs557_MeshSimplifier
+{
+	/*
+	Symmetric 4x4 matrix of the plane distances: a2 ab ac ad b2 bc bd c2 cd d2
+	*/
+	struct Quadric
+	{
+		double q[10];
+
+		Quadric()
+		{
+			memset(q, 0, sizeof(q));
+		}
+
+		void addPlane(double a, double b, double c, double d, double w)
+		{
+			q[0] += w * a * a; q[1] += w * a * b; q[2] += w * a * c; q[3] += w * a * d;
+			q[4] += w * b * b; q[5] += w * b * c; q[6] += w * b * d;
+			q[7] += w * c * c; q[8] += w * c * d;
+			q[9] += w * d * d;
+		}
+
+		void add(const Quadric& o)
+		{
+			for (int i = 0; i < 10; i++) q[i] += o.q[i];
+		}
+
+		// the weighted sum of the squared distances of v to the planes
+		double eval(const glm::vec3& v) const
+		{
+			double x = v.x, y = v.y, z = v.z;
+			return q[0] * x * x + 2.0 * q[1] * x * y + 2.0 * q[2] * x * z + 2.0 * q[3] * x +
+				q[4] * y * y + 2.0 * q[5] * y * z + 2.0 * q[6] * y +
+				q[7] * z * z + 2.0 * q[8] * z + q[9];
+		}
+	};
+
+
+	/*
+	A collapse candidate, from -> to, with the squared error.
+	*/
+	struct Collapse
+	{
+		int		from;
+		int		to;
+		float	cost;
+	};
+
+
+	inline uint64_t EdgeKey(int a, int b)
+	{
+		if (a > b) std::swap(a, b);
+		return ((uint64_t)(uint32_t)a << 32) | (uint32_t)b;
+	}
+
+
+	/*
+	The simplification state. Vertices with the same position share one position id.
+	*/
+	class Simplifier
+	{
+	public:
+
+		Simplifier(const std::vector<std::pair<glm::vec3, glm::vec2> >& points, const std::vector<glm::vec3>& normals,
+			const std::vector<int>& indices, const std::vector<cs557::OBJParser::OBJRange>& meshes)
+			: _points(points), _normals(normals)
+		{
+			int N = (int)points.size();
+
+			// one id per position
+			struct KeyHash {
+				size_t operator()(const glm::vec3& p) const {
+					uint32_t k[3];
+					memcpy(k, &p.x, sizeof(float)); memcpy(k + 1, &p.y, sizeof(float)); memcpy(k + 2, &p.z, sizeof(float));
+					return (size_t)(k[0] * 73856093u ^ k[1] * 19349663u ^ k[2] * 83492791u);
+				}
+			};
+			struct KeyEqual {
+				bool operator()(const glm::vec3& a, const glm::vec3& b) const { return a.x == b.x && a.y == b.y && a.z == b.z; }
+			};
+			std::unordered_map<glm::vec3, int, KeyHash, KeyEqual> ids;
+			ids.reserve(N);
+			_pid.resize(N);
+			for (int i = 0; i < N; i++) {
+				glm::vec3 p = points[i].first + glm::vec3(0.0f); // -0 becomes +0 for the hash
+				auto r = ids.insert(std::make_pair(p, (int)_position.size()));
+				if (r.second) _position.push_back(points[i].first);
+				_pid[i] = r.first->second;
+			}
+			int M = (int)_position.size();
+
+			// the vertices of each position
+			_wedge_offset.assign(M + 1, 0);
+			for (int i = 0; i < N; i++) _wedge_offset[_pid[i] + 1]++;
+			for (int p = 0; p < M; p++) _wedge_offset[p + 1] += _wedge_offset[p];
+			_wedges.resize(N);
+			std::vector<int> fill(_wedge_offset.begin(), _wedge_offset.end() - 1);
+			for (int i = 0; i < N; i++) _wedges[fill[_pid[i]]++] = i;
+
+			// the triangles, without triangles that are degenerated already
+			for (int m = 0; m < (int)meshes.size(); m++) {
+				for (int i = meshes[m].start; i + 2 < meshes[m].start + meshes[m].count; i += 3) {
+					int a = indices[i], b = indices[i + 1], c = indices[i + 2];
+					if (_pid[a] == _pid[b] || _pid[b] == _pid[c] || _pid[c] == _pid[a]) continue;
+					_triangles.push_back(a);
+					_triangles.push_back(b);
+					_triangles.push_back(c);
+					_mesh.push_back(m);
+				}
+			}
+			int T = (int)_mesh.size();
+			_alive.assign(T, true);
+			_num_alive = T;
+
+			// the area-weighted plane quadrics and the original triangle normals
+			_quadric.resize(M);
+			_weight.assign(M, 0.0);
+			_face_normal.resize(T);
+			for (int t = 0; t < T; t++) {
+				glm::vec3 a = _position[_pid[_triangles[3 * t]]];
+				glm::vec3 b = _position[_pid[_triangles[3 * t + 1]]];
+				glm::vec3 c = _position[_pid[_triangles[3 * t + 2]]];
+				glm::vec3 n = glm::cross(b - a, c - a);
+				_face_normal[t] = n;
+				double area = 0.5 * glm::length(n);
+				if (area <= 0.0) continue;
+				n = glm::normalize(n);
+				double d = -glm::dot(n, a);
+				for (int k = 0; k < 3; k++) {
+					int p = _pid[_triangles[3 * t + k]];
+					_quadric[p].addPlane(n.x, n.y, n.z, d, area);
+					_weight[p] += area;
+				}
+			}
+
+			// lock the vertices of open borders, non-manifold edges, and edges between two meshes
+			std::vector<std::pair<uint64_t, int> > edges;
+			edges.reserve(3 * T);
+			for (int t = 0; t < T; t++) {
+				for (int k = 0; k < 3; k++) {
+					edges.push_back(std::make_pair(EdgeKey(_pid[_triangles[3 * t + k]], _pid[_triangles[3 * t + (k + 1) % 3]]), _mesh[t]));
+				}
+			}
+			std::sort(edges.begin(), edges.end());
+			_locked.assign(M, false);
+			for (size_t i = 0; i < edges.size();) {
+				size_t j = i;
+				bool same_mesh = true;
+				while (j < edges.size() && edges[j].first == edges[i].first) {
+					if (edges[j].second != edges[i].second) same_mesh = false;
+					j++;
+				}
+				if (j - i != 2 || !same_mesh) {
+					_locked[(int)(edges[i].first >> 32)] = true;
+					_locked[(int)(edges[i].first & 0xffffffff)] = true;
+				}
+				i = j;
+			}
+
+			_stamp.assign(M, 0);
+			_pass = 0;
+			_max_error = 0.0f;
+		}
+
+
+		int alive(void) { return _num_alive; }
+
+
+		/*
+		Collapse edges until at most target triangles are left or no edge can be collapsed.
+		Returns the max. error of all collapses so far.
+		*/
+		float simplify(int target)
+		{
+			int M = (int)_position.size();
+			int T = (int)_mesh.size();
+			std::vector<int> adj_offset(M + 1);
+			std::vector<int> adj;
+			std::vector<uint64_t> edges;
+			std::vector<Collapse> collapses;
+			std::vector<int> remap(M);
+
+			while (_num_alive > target) {
+				_pass++;
+
+				// the triangles of each position
+				std::fill(adj_offset.begin(), adj_offset.end(), 0);
+				for (int t = 0; t < T; t++) {
+					if (!_alive[t]) continue;
+					for (int k = 0; k < 3; k++) adj_offset[_pid[_triangles[3 * t + k]] + 1]++;
+				}
+				for (int p = 0; p < M; p++) adj_offset[p + 1] += adj_offset[p];
+				adj.resize(adj_offset[M]);
+				std::vector<int> fill(adj_offset.begin(), adj_offset.end() - 1);
+				for (int t = 0; t < T; t++) {
+					if (!_alive[t]) continue;
+					for (int k = 0; k < 3; k++) adj[fill[_pid[_triangles[3 * t + k]]]++] = t;
+				}
+
+				// the edges and their cheaper collapse direction
+				edges.clear();
+				for (int t = 0; t < T; t++) {
+					if (!_alive[t]) continue;
+					for (int k = 0; k < 3; k++) edges.push_back(EdgeKey(_pid[_triangles[3 * t + k]], _pid[_triangles[3 * t + (k + 1) % 3]]));
+				}
+				std::sort(edges.begin(), edges.end());
+				edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+				collapses.clear();
+				for (uint64_t e : edges) {
+					int a = (int)(e >> 32);
+					int b = (int)(e & 0xffffffff);
+					float cost_ab = _locked[a] ? -1.0f : cost(a, b);
+					float cost_ba = _locked[b] ? -1.0f : cost(b, a);
+					if (cost_ab < 0.0f && cost_ba < 0.0f) continue;
+					Collapse c;
+					if (cost_ba < 0.0f || (cost_ab >= 0.0f && cost_ab <= cost_ba)) { c.from = a; c.to = b; c.cost = cost_ab; }
+					else { c.from = b; c.to = a; c.cost = cost_ba; }
+					collapses.push_back(c);
+				}
+				std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) { return x.cost < y.cost; });
+
+				// collapse the cheapest edges; a position changes once per pass
+				for (int p = 0; p < M; p++) remap[p] = p;
+				int removed = 0;
+				for (const Collapse& c : collapses) {
+					if (removed >= _num_alive - target) break;
+					if (_stamp[c.from] == _pass || _stamp[c.to] == _pass) continue;
+
+					int n_removed = 0;
+					if (!valid(c, adj, adj_offset, n_removed)) continue;
+
+					remap[c.from] = c.to;
+					_quadric[c.to].add(_quadric[c.from]);
+					_weight[c.to] += _weight[c.from];
+					_max_error = (std::max)(_max_error, sqrt(c.cost));
+					removed += n_removed;
+
+					// all positions of the changed triangles keep their adjacency in this pass
+					for (int j = adj_offset[c.from]; j < adj_offset[c.from + 1]; j++) {
+						int t = adj[j];
+						for (int k = 0; k < 3; k++) _stamp[_pid[_triangles[3 * t + k]]] = _pass;
+					}
+				}
+				if (removed == 0) break;
+
+				// move the corners and remove the degenerated triangles
+				for (int t = 0; t < T; t++) {
+					if (!_alive[t]) continue;
+					int* tri = &_triangles[3 * t];
+					for (int k = 0; k < 3; k++) {
+						int p = _pid[tri[k]];
+						if (remap[p] != p) tri[k] = closestWedge(tri[k], remap[p]);
+					}
+					if (_pid[tri[0]] == _pid[tri[1]] || _pid[tri[1]] == _pid[tri[2]] || _pid[tri[2]] == _pid[tri[0]]) {
+						_alive[t] = false;
+						_num_alive--;
+					}
+				}
+			}
+
+			return _max_error;
+		}
+
+
+		/*
+		Append the remaining triangles to the index buffer, one range per mesh.
+		*/
+		void append(std::vector<int>& indices, int num_meshes, cs557::MeshSimplifier::LOD& lod)
+		{
+			int T = (int)_mesh.size();
+			lod.start.assign(num_meshes, 0);
+			lod.count.assign(num_meshes, 0);
+
+			// the ranges of all meshes from one pass over the triangles
+			for (int t = 0; t < T; t++) {
+				if (_alive[t]) lod.count[_mesh[t]] += 3;
+			}
+			int first = (int)indices.size();
+			for (int m = 0; m < num_meshes; m++) {
+				lod.start[m] = first;
+				first += lod.count[m];
+			}
+			std::vector<int> fill(lod.start);
+			indices.resize(first);
+			for (int t = 0; t < T; t++) {
+				if (!_alive[t]) continue;
+				int& i = fill[_mesh[t]];
+				indices[i] = _triangles[3 * t];
+				indices[i + 1] = _triangles[3 * t + 1];
+				indices[i + 2] = _triangles[3 * t + 2];
+				i += 3;
+			}
+
+			if (_scratch.size() != _points.size()) _scratch.assign(_points.size(), -1);
+			for (int m = 0; m < num_meshes; m++)
+				cs557::MeshOptimizer::OptimizeVertexCache(indices, lod.start[m], lod.count[m], _scratch);
+		}
+
+
+	private:
+
+		/*
+		The squared error of moving position from onto position to.
+		*/
+		float cost(int from, int to)
+		{
+			double w = _weight[from] + _weight[to];
+			if (w <= 0.0) return 0.0f;
+			Quadric q = _quadric[from];
+			q.add(_quadric[to]);
+			return (float)((std::max)(0.0, q.eval(_position[to])) / w);
+		}
+
+
+		/*
+		Return false if the collapse flips a triangle, with respect to its last or its original orientation. 
+		Many small rotations would flip a triangle otherwise. Counts the removed triangles.
+		*/
+		bool valid(const Collapse& c, const std::vector<int>& adj, const std::vector<int>& adj_offset, int& n_removed)
+		{
+			n_removed = 0;
+			for (int j = adj_offset[c.from]; j < adj_offset[c.from + 1]; j++) {
+				int t = adj[j];
+				int p[3];
+				for (int k = 0; k < 3; k++) p[k] = _pid[_triangles[3 * t + k]];
+				if (p[0] == c.to || p[1] == c.to || p[2] == c.to) {
+					n_removed++;
+					continue;
+				}
+
+				glm::vec3 n0 = glm::cross(_position[p[1]] - _position[p[0]], _position[p[2]] - _position[p[0]]);
+				for (int k = 0; k < 3; k++) if (p[k] == c.from) p[k] = c.to;
+				glm::vec3 n1 = glm::cross(_position[p[1]] - _position[p[0]], _position[p[2]] - _position[p[0]]);
+				if (glm::dot(n0, n1) <= 0.0f || glm::dot(_face_normal[t], n1) <= 0.0f) return false;
+			}
+			return true;
+		}
+
+
+		/*
+		Return the vertex at a position with the closest normal and texture coordinate.
+		*/
+		int closestWedge(int vertex, int position)
+		{
+			int best = _wedges[_wedge_offset[position]];
+			float best_d = 1e30f;
+			for (int j = _wedge_offset[position]; j < _wedge_offset[position + 1]; j++) {
+				int w = _wedges[j];
+				glm::vec3 dn = _normals[w] - _normals[vertex];
+				glm::vec2 duv(_points[w].second.x - _points[vertex].second.x, _points[w].second.y - _points[vertex].second.y);
+				float d = glm::dot(dn, dn) + duv.x * duv.x + duv.y * duv.y;
+				if (d < best_d) {
+					best_d = d;
+					best = w;
+				}
+			}
+			return best;
+		}
+
+
+		const std::vector<std::pair<glm::vec3, glm::vec2> >&	_points;
+		const std::vector<glm::vec3>&							_normals;
+
+		std::vector<int>			_pid; // position id per vertex
+		std::vector<glm::vec3>		_position; // per position id
+		std::vector<int>			_wedge_offset; // the vertices of a position
+		std::vector<int>			_wedges;
+		std::vector<Quadric>		_quadric;
+		std::vector<double>			_weight;
+		std::vector<bool>			_locked;
+		std::vector<int>			_stamp; // pass of the last change
+
+		std::vector<int>			_triangles; // vertex indices
+		std::vector<int>			_mesh; // mesh per triangle
+		std::vector<bool>			_alive;
+		std::vector<glm::vec3>		_face_normal; // original normal per triangle, not normalized
+		int							_num_alive;
+
+		int							_pass;
+		float						_max_error;
+
+		std::vector<int>			_scratch; // for MeshOptimizer::OptimizeVertexCache, shared by all levels
+	};
+}
+
+using namespace cs557_MeshSimplifier;
+
+
+/*!
+Build a chain of simplified meshes.
+*/
+//static
+void cs557::MeshSimplifier::BuildLODs(const std::vector<std::pair<glm::vec3, glm::vec2> >& points, const std::vector<glm::vec3>& normals,
+	std::vector<int>& indices, const std::vector<OBJParser::OBJRange>& meshes, std::vector<LOD>& lods,
+	int min_triangles, float ratio, int max_levels)
+{
+	lods.clear();
+
+	// level 0, the original mesh
+	LOD lod0;
+	int T = 0;
+	for (auto& m : meshes) {
+		lod0.start.push_back(m.start);
+		lod0.count.push_back(m.count);
+		T += m.count / 3;
+	}
+	lods.push_back(lod0);
+
+	if (points.size() != normals.size() || T * ratio < min_triangles) return;
+
+	Simplifier simplifier(points, normals, indices, meshes);
+
+	int target = T;
+	for (int level = 1; level < max_levels; level++) {
+		int previous = simplifier.alive();
+		target = int(target * ratio);
+		if (target < min_triangles) break;
+
+		LOD lod;
+		lod.error = simplifier.simplify(target);
+
+		// stop if the locked vertices prevent a useful reduction
+		if (simplifier.alive() > previous * (1.0f + ratio) / 2.0f) break;
+
+		simplifier.append(indices, (int)meshes.size(), lod);
+		lods.push_back(lod);
+	}
+}
@@ -0,0 +1,83 @@
+#pragma once
+/*
+@class MeshSimplifier
+@brief	Builds a chain of simplified meshes (level of detail) with quadric error edge collapses.
+
+The simplification follows Garland and Heckbert, Surface Simplification Using Quadric Error Metrics, 1997,
+but collapses an edge onto one of its two vertices. Thus, all levels use the vertices of the original mesh,
+share its vertex buffer, and each level is a set of index ranges, one range per mesh, appended to the index buffer.
+
+- Vertices with the same position are processed as one vertex, so normal and texture seams do not stop the simplification.
+  A triangle corner takes the vertex at the new position whose normal and texture coordinate are closest to its old vertex.
+- Vertices on open borders and on non-manifold edges are locked to keep the silhouette of open scans.
+- A collapse is rejected if it flips a triangle, with respect to its last or its original orientation.
+- The error of a level is the largest error of all collapses so far: the area-weighted RMS distance
+  of the moved vertex to the planes of its original triangles, in model units.
+
+Usage:
+std::vector<MeshSimplifier::LOD> lods;
+MeshSimplifier::BuildLODs(points, normals, indices, meshes, lods);
+// level k draws lods[k].count[i] indices from lods[k].start[i] for mesh i; lods[0] is the original mesh.
+
+Rafael Radkowski
+Iowa State University
+rafael@iastate.edu
+515 294 7044
+MIT License
+-------------------------------------------------------------------------------------------------------
+Last edited:
+Oct 19, 2026, RR
+- A collapse is also rejected if it flips a triangle with respect to its original orientation. 
+  Several small rotations flipped triangles before, see test_src/MeshSimplifierTest.cpp.
+*/
+
+// stl
+#include <iostream>
+#include <vector>
+
+// glm
+#include <glm/glm.hpp>
+
+// local
+#include "OBJParser.h"
+
+
+namespace cs557
+{
+
+class MeshSimplifier
+{
+public:
+
+	/*
+	One level of detail.
+	*/
+	typedef struct _LOD {
+		float				error; // max. geometric error in model units, 0 for the original mesh
+		std::vector<int>	start; // first index per mesh
+		std::vector<int>	count; // number of indices per mesh
+
+		_LOD()
+		{
+			error = 0.0f;
+		}
+	}LOD;
+
+
+	/*!
+	Build a chain of simplified meshes. Each level has about ratio times the triangles of the level before.
+	@param points - the positions and texture coordinates.
+	@param normals - the normal vectors.
+	@param indices - the index buffer, three indices per triangle. The indices of the new levels are appended.
+	@param meshes - the meshes as ranges of the index buffer.
+	@param lods - location for the levels. Level 0 is the original mesh. Only level 0 if the mesh is too small.
+	@param min_triangles - no level with less triangles than this is created.
+	@param ratio - the triangle ratio between two levels.
+	@param max_levels - the max. number of levels, including level 0.
+	*/
+	static void BuildLODs(const std::vector<std::pair<glm::vec3, glm::vec2> >& points, const std::vector<glm::vec3>& normals,
+		std::vector<int>& indices, const std::vector<OBJParser::OBJRange>& meshes, std::vector<LOD>& lods,
+		int min_triangles = 2000, float ratio = 0.25f, int max_levels = 6);
+};
+
+}//namespace cs557
@@ -11,15 +11,18 @@ namespace ns_ModelBRDF
 		"uniform mat4 projectionMatrix;     \n"                               
 		"uniform mat4 viewMatrix;     \n"                                      
 		"uniform mat4 modelMatrix;  \n"
+		"uniform int object_id; // the model, or the first instance	\n"
 		"in vec3 in_Position;     \n"                                                                                                      
 		"in vec3 in_Normal;       \n"                                
 		"out vec3 pass_Normal; \n"
 		"out vec3 pass_Position;\n"
 		"out vec4 pass_Coordinates;						\n"
 		"out vec4 pass_Color;     \n"                                        
+		"flat out int pass_ID;	\n"
 		" \n"
 		"void main(void)         \n"                                         
 		"{            \n"
+		"	pass_ID = object_id + gl_InstanceID;	\n"
 		"	// for lighting\n"
 		"	pass_Position = vec3(  viewMatrix *  modelMatrix  *  vec4(in_Position, 1.0));   \n" 
 		"\n"
@@ -48,6 +51,7 @@ namespace ns_ModelBRDF
 		"in vec3 pass_Position;								\n"
 		"in vec4 pass_Color;								\n"
 		"in vec4 pass_Coordinates;						\n"	
+		"flat in int pass_ID;								\n"
 		"								\n"
 		"uniform mat4 projectionMatrix;                      								\n"              
 		"uniform mat4 viewMatrix;                            								\n"               
@@ -85,7 +89,8 @@ namespace ns_ModelBRDF
 		"								\n"
 		"								\n"
 		"// the final color								\n"
-		"out vec4 frag_out;   								\n"
+		"layout(location = 0) out vec4 frag_out;   								\n"
+		"layout(location = 1) out uint out_ID; // the instance id, 0 is the background	\n"
 		"								\n"
 		"float calculateAttenuation(vec3 light_position, vec3 fragment_position, float k1, float k2)								\n"
 		"{								\n"
@@ -199,6 +204,7 @@ namespace ns_ModelBRDF
 		"	color = pow(color, vec3(1.0/2.2));  								\n"
 		"								\n"
 		"	frag_out = vec4(color, 1.0); 								\n"      
+		"	out_ID = uint(pass_ID);								\n"
 		"  // frag_out = vec4(Lo, 1.0);									\n"
 		"																							\n"		
 		"	//------------------------------------------------										\n"	
@@ -277,12 +283,13 @@ void cs557::ModelBRDF::draw(glm::mat4 projectionMatrix, glm::mat4 viewMatrix, gl
 	// Bind the buffer and switch it to an active buffer
 	glBindVertexArray(vaoID[0]);
 
-	for (int i = 0; i < start_index.size(); i++) {
-		_brdf_material.apply(program);
-		glUseProgram(program);
+	// one material for all meshes
+	_brdf_material.apply(program);
+	glUseProgram(program);
 
+	for (auto& b : batches) {
 		// Draw the triangles
-		glDrawElements(GL_TRIANGLES, length[i], GL_UNSIGNED_INT, (GLint*)(sizeof(int)*start_index[i]));
+		glMultiDrawElements(GL_TRIANGLES, &b.count[0], index_type, &b.offset[0], b.count.size());
 	}
 	//glDrawElements(GL_TRIANGLES, _I, GL_UNSIGNED_INT, 0);
 
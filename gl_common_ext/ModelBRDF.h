@@ -21,6 +21,10 @@ Last edited:
 
 May 9, 2020, RR
 - Adapted the shader code to output linear depth values. 
+Oct 19, 2026, RR
+- Draws with the index type of the OBJModel, 16-bit or 32-bit indices. 
+- Draws the batches of the OBJModel, one call per material.
+- The fragment shader writes the instance id, object_id + gl_InstanceID, into a second output, see CreateRenderToTextureWithID().
 
 */
 
@@ -1,4 +1,5 @@
 #include "ModelOBJ.h"
+#include <cstddef> // offsetof
 
 
 
@@ -45,6 +46,14 @@ namespace cs557_OBJModel
 using namespace cs557_OBJModel;
 
 
+cs557::OBJModel::OBJModel()
+{
+	instanceLocation = -1;
+	instance_vbo = 0;
+	instance_capacity = 0;
+	geometry_vao = 0;
+	geometry_location = -1;
+}
 
 	
 /*
@@ -73,9 +82,7 @@ void cs557::OBJModel::create(string path_and_filename, int shader_program)
 					0, 0, 1, 0,
 					0, 0, 0, 1};
 
-	std::vector<std::pair<glm::vec3, glm::vec2> > points; // points and texture coordinates
-	std::vector<glm::vec3> normals;
-	std::vector<int> indices;
+	cs557::MeshCache::MeshData mesh; // points and texture coordinates, normals, indices, meshes
 	
 
 	// create a shader program only if the progrm was not overwritten. 
@@ -90,31 +97,67 @@ void cs557::OBJModel::create(string path_and_filename, int shader_program)
 	int pos_location = glGetAttribLocation(program, "in_Position");
 	int norm_location = glGetAttribLocation(program, "in_Normal");
 	int tex_location = glGetAttribLocation(program, "in_Texture");
+	instanceLocation = glGetAttribLocation(program, "in_InstanceMatrix");
+
+
+	// Load the geometry from the cache, or from file. All meshes share one vertex buffer. 
+	if (!cs557::MeshCache::Read(path_and_filename, mesh)) {
+
+		std::shared_ptr<const cs557::OBJParser::OBJData> obj = cs557::OBJParser::Load(path_and_filename);
+		if (!obj) {
+			cout << "[ERROR] - OBJModel: cannot load the model " << path_and_filename << endl;
+			return;
+		}
+
+		mesh.points.resize(obj->positions.size());
+		for (int j = 0; j < obj->positions.size(); j++)
+			mesh.points[j] = make_pair(obj->positions[j], obj->texcoords[j]);
+		mesh.normals = obj->normals;
+		mesh.indices = obj->indices;
+		mesh.meshes = obj->meshes;
+		mesh.libraries = obj->libraries;
 
+		// meshes of the same material next to each other, so that they can be drawn with one call
+		cs557::MeshOptimizer::SortByMaterial(mesh.indices, mesh.meshes);
 
-	// Load the geometry from file. 
-	objl::Loader loader;
-	loader.LoadFile(path_and_filename);
+		// triangle order per mesh for the vertex cache, then the vertex order for the vertex fetch
+		std::vector<int> scratch(mesh.points.size(), -1);
+		for (auto& r : mesh.meshes)
+			cs557::MeshOptimizer::OptimizeVertexCache(mesh.indices, r.start, r.count, scratch);
+		cs557::MeshOptimizer::OptimizeVertexFetch(mesh.points, mesh.normals, mesh.indices);
+
+		// simplified levels of detail, appended to the index buffer
+		cs557::MeshSimplifier::BuildLODs(mesh.points, mesh.normals, mesh.indices, mesh.meshes, mesh.lods);
+
+		// Set the object to the center of mass. 
+		GLGeometryUtils::SetToBBCenter(mesh.points);
+
+		// compute the bounding box of the object. 
+		GLGeometryUtils::CalcAll(mesh.points, mesh.boundingbox, mesh.centroid );
+
+		cs557::MeshCache::Write(path_and_filename, mesh);
+	}
 
 
-	int current_start_index = 0;
 	start_index.clear();
 	length.clear();
+	mesh_material.clear();
+	std::map<std::pair<string, unsigned int>, int> material_ids; // material name and texture -> first mesh
 
 
-	int size = loader.LoadedMeshes.size();
+	int size = mesh.meshes.size();
 
 	for(int i=0; i<size; i++)
 	{
 
-		objl::Mesh curMesh = loader.LoadedMeshes[i];
+		const cs557::OBJParser::OBJRange& curMesh = mesh.meshes[i];
 
 		// process all materials
 		cs557::Material mat;
-		mat.ambient_mat = glm::vec3(curMesh.MeshMaterial.Ka.X, curMesh.MeshMaterial.Ka.Y, curMesh.MeshMaterial.Ka.Z) ;
-		mat.diffuse_mat = glm::vec3(curMesh.MeshMaterial.Kd.X, curMesh.MeshMaterial.Kd.Y, curMesh.MeshMaterial.Kd.Z) ;
-		mat.specular_mat = glm::vec3(curMesh.MeshMaterial.Ks.X, curMesh.MeshMaterial.Ks.Y, curMesh.MeshMaterial.Ks.Z) ;
-		mat.specular_s = curMesh.MeshMaterial.Ns;
+		mat.ambient_mat = glm::vec3(curMesh.material.Ka.X, curMesh.material.Ka.Y, curMesh.material.Ka.Z) ;
+		mat.diffuse_mat = glm::vec3(curMesh.material.Kd.X, curMesh.material.Kd.Y, curMesh.material.Kd.Z) ;
+		mat.specular_mat = glm::vec3(curMesh.material.Ks.X, curMesh.material.Ks.Y, curMesh.material.Ks.Z) ;
+		mat.specular_s = curMesh.material.Ns;
 		mat.specular_int = 0.2;
 		mat.ambient_int = 0.2;
 		mat.diffuse_int = 0.8;
@@ -123,45 +166,59 @@ void cs557::OBJModel::create(string path_and_filename, int shader_program)
 		materials.push_back(mat);
 
 		// process all textures
-		processTextures(program, curMesh, path_and_filename);
-	
-		
+		processTextures(program, curMesh.material, path_and_filename);
 
-		for (int j = 0; j < curMesh.Vertices.size(); j++)
-		{
-			points.push_back(make_pair( glm::vec3(curMesh.Vertices[j].Position.X, curMesh.Vertices[j].Position.Y, curMesh.Vertices[j].Position.Z),
-			 							glm::vec2(curMesh.Vertices[j].TextureCoordinate.X, curMesh.Vertices[j].TextureCoordinate.Y )));
-			normals.push_back(glm::vec3(curMesh.Vertices[j].Normal.X, curMesh.Vertices[j].Normal.Y, curMesh.Vertices[j].Normal.Z) );
-		}
-		
-		start_index.push_back(current_start_index);
-		length.push_back(curMesh.Indices.size());
-
-		for (int j = 0; j < curMesh.Indices.size(); j++)
-		{
-			indices.push_back(curMesh.Indices[j] + current_start_index); 
-			//  + current_start_index is requires since the obj loader objl::Loader loader
-			// starts a new index count for each mesh instead of keeping the original indices. 
-			// This code puts all vertices and indices into one vertex buffer and index buffer. 
-			// So the + current_start_index implements the offset jump. 
-		}
+		// each mesh is a range of the index buffer
+		start_index.push_back(curMesh.start);
+		length.push_back(curMesh.count);
 
-		current_start_index += curMesh.Indices.size();
-		//glBindAttribLocation(program, pos_location, "in_Position");
-		//glBindAttribLocation(program, norm_location, "in_Normal");
-		//glBindAttribLocation(program, tex_location, "in_Texture");
+		// meshes with the same material and texture share the material of the first of them
+		auto key = std::make_pair(curMesh.material.name, textures.back().diff.tex_id);
+		mesh_material.push_back(material_ids.insert(std::make_pair(key, i)).first->second);
 	}
-	_I = indices.size();
-	_N = points.size();
-
-	// Set the object to the center of mass. 
-	GLGeometryUtils::SetToBBCenter(points);
-
-	// compute the bounding box of the object. 
-	GLGeometryUtils::CalcAll(points, boundingbox, centroid );
 
-	// create a vertex buffer object
-	cs557::CreateVertexObjectsIndexed53(vaoID, vboID, iboID, &points[0].first.x, &normals[0].x, _N, &indices[0], _I, pos_location, tex_location, norm_location );
+	_I = mesh.indices.size();
+	_N = mesh.points.size();
+	boundingbox = mesh.boundingbox;
+	centroid = mesh.centroid;
+
+	// the levels of detail; level 0 are the meshes
+	lod_start.clear();
+	lod_length.clear();
+	lod_error.clear();
+	for (auto& l : mesh.lods) {
+		lod_start.push_back(l.start);
+		lod_length.push_back(l.count);
+		lod_error.push_back(l.error);
+	}
+	lod_level = 0;
+	buildBatches();
+
+	// keep the geometry for model analysis
+	cpu_vertices.resize(mesh.points.size());
+	for (int j = 0; j < mesh.points.size(); j++)
+		cpu_vertices[j] = mesh.points[j].first;
+	// only the original mesh, not the levels of detail
+	int num_indices = 0;
+	for (int i = 0; i < start_index.size(); i++)
+		num_indices = (std::max)(num_indices, start_index[i] + length[i]);
+	cpu_indices.assign(mesh.indices.begin(), mesh.indices.begin() + num_indices);
+
+	// create a vertex buffer object with packed vertices, and 16-bit indices if all vertices can be addressed
+	std::vector<cs557::PackedVertex> vertices;
+	cs557::MeshOptimizer::Pack(mesh.points, mesh.normals, vertices);
+
+	if (_N <= 65536) {
+		std::vector<unsigned short> short_indices(mesh.indices.begin(), mesh.indices.end());
+		index_type = GL_UNSIGNED_SHORT;
+		index_size = sizeof(unsigned short);
+		cs557::CreateVertexObjectsIndexedPacked(vaoID, vboID, iboID, &vertices[0], _N, &short_indices[0], _I, true, pos_location, tex_location, norm_location );
+	}
+	else {
+		index_type = GL_UNSIGNED_INT;
+		index_size = sizeof(unsigned int);
+		cs557::CreateVertexObjectsIndexedPacked(vaoID, vboID, iboID, &vertices[0], _N, &mesh.indices[0], _I, false, pos_location, tex_location, norm_location );
+	}
 
 }
 
@@ -188,27 +245,38 @@ void cs557::OBJModel::draw(glm::mat4 projectionMatrix, glm::mat4 viewMatrix, glm
 	 // Bind the buffer and switch it to an active buffer
 	glBindVertexArray(vaoID[0]);
 
-	for (int i = 0; i < start_index.size(); i++) {
+	// the instance matrix is a constant attribute outside of drawInstanced
+	if (instanceLocation >= 0) {
+		for (int c = 0; c < 4; c++)
+			glVertexAttrib4f(instanceLocation + c, c == 0, c == 1, c == 2, c == 3);
+	}
+
+	// the override material is the same for all batches
+	if(with_override_material){
+		override_material.apply(program);
 		glUseProgram(program);
+	}
+
+	// one batch per material and texture
+	for (auto& b : batches) {
 
-		if(!with_override_material)
-			materials[i].apply(program);
-		else{
-			override_material.apply(program);
+		if(!with_override_material){
+			materials[b.material].apply(program);
+			glUseProgram(program);
 		}
-	
-		
-		glUseProgram(program);
 
 		// apply texturs
-		if (textures[i].num_textures > 0) {
+		if (textures[b.material].num_textures > 0) {
 			 // Activate the texture unit and bind the texture. 
 			glActiveTexture(GL_TEXTURE0);
-			glBindTexture(GL_TEXTURE_2D, textures[i].diff.tex_id);
+			glBindTexture(GL_TEXTURE_2D, textures[b.material].diff.tex_id);
 		}
 
-		// Draw the triangles
-		glDrawElements(GL_TRIANGLES, length[i], GL_UNSIGNED_INT, (GLint*)(sizeof(int)*start_index[i]));
+		// Draw the triangles of all meshes of the batch
+		if (b.count.size() == 1)
+			glDrawElements(GL_TRIANGLES, b.count[0], index_type, b.offset[0]);
+		else
+			glMultiDrawElements(GL_TRIANGLES, &b.count[0], index_type, &b.offset[0], b.count.size());
 	}
 	//glDrawElements(GL_TRIANGLES, _I, GL_UNSIGNED_INT, 0);
 
@@ -228,8 +296,143 @@ void cs557::OBJModel::draw(glm::mat4 projectionMatrix, glm::mat4 viewMatrix)
 }
 
 
+/*
+Draw several instances of the obj model with one instanced draw call per draw range. 
+@param projectionMatrix - a projection matrix object
+@param viewMatrix - a view matrix object
+@param modelMatrices - the model matrix of each instance.
+*/
+void cs557::OBJModel::drawInstanced(glm::mat4 projectionMatrix, glm::mat4 viewMatrix, const std::vector<glm::mat4>& modelMatrices)
+{
+	if (modelMatrices.empty()) return;
+
+	// the program cannot read the instance matrices
+	if (instanceLocation < 0) {
+		for (auto& m : modelMatrices)
+			draw(projectionMatrix, viewMatrix, m);
+		return;
+	}
+
+	GLsizei num_instances = (GLsizei)modelMatrices.size();
+
+	// upload the matrices; the buffer grows if required and is orphaned otherwise
+	if (instance_vbo == 0)
+		glGenBuffers(1, &instance_vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, instance_vbo);
+	if (modelMatrices.size() > instance_capacity) {
+		instance_capacity = modelMatrices.size();
+	}
+	glBufferData(GL_ARRAY_BUFFER, instance_capacity * sizeof(glm::mat4), NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, modelMatrices.size() * sizeof(glm::mat4), &modelMatrices[0][0][0]);
+
+	glUseProgram(program);
+
+	// the instance matrices replace the model matrix
+	glm::mat4 identity(1.0f);
+	glUniformMatrix4fv(viewMatrixLocation, 1, GL_FALSE, &viewMatrix[0][0]);
+	glUniformMatrix4fv(modelMatrixLocation, 1, GL_FALSE, &identity[0][0]);
+	glUniformMatrix4fv(projMatrixLocation, 1, GL_FALSE, &projectionMatrix[0][0]);
+
+	glBindVertexArray(vaoID[0]);
 
-void cs557::OBJModel::processTextures(int& program, objl::Mesh& curMesh, string path)
+	// a mat4 attribute uses four vec4 attributes, one column each, advanced once per instance
+	for (int c = 0; c < 4; c++) {
+		glEnableVertexAttribArray(instanceLocation + c);
+		glVertexAttribPointer(instanceLocation + c, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (const GLvoid*)(sizeof(glm::vec4) * c));
+		glVertexAttribDivisor(instanceLocation + c, 1);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	if(with_override_material){
+		override_material.apply(program);
+		glUseProgram(program);
+	}
+
+	for (auto& b : batches) {
+
+		if(!with_override_material){
+			materials[b.material].apply(program);
+			glUseProgram(program);
+		}
+
+		if (textures[b.material].num_textures > 0) {
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, textures[b.material].diff.tex_id);
+		}
+
+		// GL 4.1 has no instanced multi-draw; merged batches usually have one range
+		for (int i = 0; i < b.count.size(); i++)
+			glDrawElementsInstanced(GL_TRIANGLES, b.count[i], index_type, b.offset[i], num_instances);
+	}
+
+	// draw() uses a constant instance matrix
+	for (int c = 0; c < 4; c++) {
+		glVertexAttribDivisor(instanceLocation + c, 0);
+		glDisableVertexAttribArray(instanceLocation + c);
+	}
+
+	glBindVertexArray(0);
+	glUseProgram(0);
+}
+
+
+/*
+Select the level of detail to draw. Level 0 is the original mesh. 
+@param level - the level, 0 to getNumLODs() - 1.
+@return - false, if the level does not exist. 
+*/
+bool cs557::OBJModel::setLOD(int level)
+{
+	if (level < 0 || level >= lod_start.size()) return level == 0;
+	if (level == lod_level) return true;
+
+	// the draw functions render the index ranges in start_index and length
+	start_index = lod_start[level];
+	length = lod_length[level];
+	lod_level = level;
+	buildBatches();
+	return true;
+}
+
+
+/*
+Group the index ranges in start_index and length into one batch per material.
+*/
+void cs557::OBJModel::buildBatches(void)
+{
+	batches.clear();
+
+	// the meshes in the order of their material; the sort keeps the index buffer order per material
+	std::vector<int> order;
+	for (int i = 0; i < start_index.size(); i++) {
+		if (length[i] > 0) order.push_back(i);
+	}
+	std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return mesh_material[a] < mesh_material[b]; });
+
+	int last_end = -1;
+	for (int i : order) {
+		if (batches.empty() || batches.back().material != mesh_material[i]) {
+			batches.push_back(DrawBatch());
+			batches.back().material = mesh_material[i];
+			last_end = -1;
+		}
+
+		// adjacent ranges become one range
+		DrawBatch& b = batches.back();
+		if (start_index[i] == last_end) {
+			b.count.back() += length[i];
+		}
+		else {
+			b.count.push_back(length[i]);
+			b.offset.push_back((const GLvoid*)((size_t)index_size * start_index[i]));
+		}
+		last_end = start_index[i] + length[i];
+	}
+}
+
+
+
+void cs557::OBJModel::processTextures(int& program, const objl::Material& material, string path)
 {
 	// Extract the current path. 
 	int idx = path.find_last_of("/");
@@ -242,18 +445,17 @@ void cs557::OBJModel::processTextures(int& program, objl::Mesh& curMesh, string
 
 	//-------------------------------------------------------------------------------------------------------
 	// diffuse texture
-	string tex_Kd = curMesh.MeshMaterial.map_Kd;
+	string tex_Kd = material.map_Kd;
 	
 	if (tex_Kd.length() > 0) {
 		string tex_path = curr_path;
 		tex_path.append(tex_Kd);
 
-		// Load the texture
-		TextureLoader::Load(tex_path, &tex.diff.map, &tex.diff.width, &tex.diff.height, &tex.diff.channels);
+		// Load the texture, or share the texture if another mesh or model already uses the file
+		if (TextureLoader::LoadTexture2D(tex_path, &tex.diff.tex_id))
+			texture_files.push_back(tex_path);
 
-		// create the gl texture
 		glUseProgram(program);
-		cs557::CreateTexture2D(tex.diff.width, tex.diff.height, tex.diff.channels, tex.diff.map, &tex.diff.tex_id);
 
 		// Activate the texture unit and bind the texture. 
 		glActiveTexture(GL_TEXTURE0);
@@ -275,18 +477,17 @@ void cs557::OBJModel::processTextures(int& program, objl::Mesh& curMesh, string
 
 	//-------------------------------------------------------------------------------------------------------
 	// ambient texture
-	string tex_Ka = curMesh.MeshMaterial.map_Ka;
+	string tex_Ka = material.map_Ka;
 
 	if (tex_Ka.length() > 0) {
 		string tex_path = curr_path;
 		tex_path.append(tex_Ka);
 
-		// Load the texture
-		TextureLoader::Load(tex_path, &tex.ambi.map, &tex.ambi.width, &tex.ambi.height, &tex.ambi.channels);
+		// Load the texture, or share the texture if another mesh or model already uses the file
+		if (TextureLoader::LoadTexture2D(tex_path, &tex.ambi.tex_id))
+			texture_files.push_back(tex_path);
 
-		// create the gl texture
 		glUseProgram(program);
-		cs557::CreateTexture2D(tex.ambi.width, tex.ambi.height, tex.ambi.channels, tex.ambi.map, &tex.ambi.tex_id);
 
 		// Activate the texture unit and bind the texture. 
 		glActiveTexture(GL_TEXTURE0);
@@ -309,18 +510,17 @@ void cs557::OBJModel::processTextures(int& program, objl::Mesh& curMesh, string
 
 	//-------------------------------------------------------------------------------------------------------
 	// specular texture
-	string tex_Ks = curMesh.MeshMaterial.map_Ks;
+	string tex_Ks = material.map_Ks;
 
 	if (tex_Ks.length() > 0) {
 		string tex_path = curr_path;
 		tex_path.append(tex_Ks);
 
-		// Load the texture
-		TextureLoader::Load(tex_path, &tex.spec.map, &tex.spec.width, &tex.spec.height, &tex.spec.channels);
+		// Load the texture, or share the texture if another mesh or model already uses the file
+		if (TextureLoader::LoadTexture2D(tex_path, &tex.spec.tex_id))
+			texture_files.push_back(tex_path);
 
-		// create the gl texture
 		glUseProgram(program);
-		cs557::CreateTexture2D(tex.spec.width, tex.spec.height, tex.spec.channels, tex.spec.map, &tex.spec.tex_id);
 
 		// Activate the texture unit and bind the texture. 
 		glActiveTexture(GL_TEXTURE0);
@@ -357,6 +557,57 @@ void cs557::OBJModel::processTextures(int& program, objl::Mesh& curMesh, string
 }
 
 
+/*
+Draw only the triangles of the current level of detail with the bound shader program.
+@param position_location - the attribute location of the vertex positions in the bound program.
+*/
+void cs557::OBJModel::drawGeometry(int position_location)
+{
+	if (position_location < 0 || _I == 0) return;
+
+	if (geometry_vao == 0)
+		glGenVertexArrays(1, &geometry_vao);
+	glBindVertexArray(geometry_vao);
+
+	// the positions of the packed vertex buffer; the other attributes stay disabled
+	if (geometry_location != position_location) {
+		if (geometry_location >= 0)
+			glDisableVertexAttribArray(geometry_location);
+		glBindBuffer(GL_ARRAY_BUFFER, vboID[0]);
+		glVertexAttribPointer((GLuint)position_location, 3, GL_FLOAT, GL_FALSE, sizeof(PackedVertex), (const GLvoid*)offsetof(PackedVertex, x));
+		glEnableVertexAttribArray(position_location);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboID[0]);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		geometry_location = position_location;
+	}
+
+	for (auto& b : batches) {
+		if (b.count.size() == 1)
+			glDrawElements(GL_TRIANGLES, b.count[0], index_type, b.offset[0]);
+		else
+			glMultiDrawElements(GL_TRIANGLES, &b.count[0], index_type, &b.offset[0], b.count.size());
+	}
+
+	glBindVertexArray(0);
+}
+
+
+/*
+Release the textures and the instance buffer. 
+*/
+cs557::OBJModel::~OBJModel()
+{
+	for (auto& f : texture_files)
+		TextureLoader::ReleaseTexture2D(f);
+
+	if (instance_vbo != 0)
+		glDeleteBuffers(1, &instance_vbo);
+
+	if (geometry_vao != 0)
+		glDeleteVertexArrays(1, &geometry_vao);
+}
+
+
 /*
 Set the texture parameters.
 @param blend_mode - set the texture blend mode. MODULATE and REPLACE are currently supported. 
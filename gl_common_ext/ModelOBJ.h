@@ -36,9 +36,23 @@ June 5, 2020, RR
 	- Added a function to compute the centroid of the object.
 	- Move all vertices to the center of the bounding box. 
 	- Added apis to read the centroid and the bounding box. 
+Oct 19, 2026, RR
+	- Keeps a copy of the vertex positions and triangle indices for model analysis. 
+	- Loads the model with the OBJParser. The meshes share one vertex buffer, which also fixes the vertex offset of the second and further meshes. 
+	- Reads the preprocessed model from the MeshCache if the model did not change, and writes the cache otherwise. 
+	- Optimizes the mesh for the vertex cache and the vertex fetch, and uploads packed vertices with 16-bit indices if possible. 
+	- Builds simplified levels of detail of large meshes. Added an api to select the level. 
+	- Shares the textures of all meshes and models with the TextureLoader cache and creates them with mipmaps. 
+	- Sorts the meshes by material and draws all meshes of one material and texture with one call. 
+	- Added drawInstanced() to draw many poses of the model with one instanced call per draw range. 
+	- Added drawGeometry() to draw the triangles with another shader program, e.g., for depth-only passes. 
 */
 #pragma once
 #include "OBJLoader.h"
+#include "OBJParser.h"
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
 
 
 // stl include
@@ -47,6 +61,8 @@ June 5, 2020, RR
 #include <sstream>
 #include <string>
 #include <vector>
+#include <map>
+#include <algorithm>
 
 // GLEW include
 #include <GL/glew.h>
@@ -75,6 +91,9 @@ namespace cs557
 	class OBJModel {
 
 	public:
+
+		OBJModel();
+
 		/*
 		Load an OBJ model from file
 		@param path_and_filename - number of rows
@@ -83,6 +102,12 @@ namespace cs557
 		void create(string path_and_filename, int shader_program = -1);
 
 
+		/*
+		Release the textures. The texture objects get deleted if no other model uses them. 
+		*/
+		~OBJModel();
+
+
 		/*
 		Draw the obj model
 		@param viewMatrix - a view matrix object
@@ -91,6 +116,27 @@ namespace cs557
 		void draw(glm::mat4 projectionMatrix, glm::mat4 viewMatrix, glm::mat4 modelMatrix);
 		void draw(glm::mat4 projectionMatrix, glm::mat4 viewMatrix);
 
+
+		/*
+		Draw several instances of the obj model with one instanced draw call per draw range. 
+		The shader program must provide the per-instance attribute 'in mat4 in_InstanceMatrix', 
+		which is multiplied with the model matrix, see image_renderer_vs. 
+		Otherwise, the function draws the instances one by one. 
+		@param projectionMatrix - a projection matrix object
+		@param viewMatrix - a view matrix object
+		@param modelMatrices - the model matrix of each instance.
+		*/
+		void drawInstanced(glm::mat4 projectionMatrix, glm::mat4 viewMatrix, const std::vector<glm::mat4>& modelMatrices);
+
+
+		/*
+		Draw only the triangles of the current level of detail, without materials and textures, e.g., for depth-only passes. 
+		The caller binds the shader program and sets its uniforms. The function uses a second vertex array object 
+		that only provides the vertex positions.
+		@param position_location - the attribute location of the vertex positions in the bound program.
+		*/
+		void drawGeometry(int position_location);
+
 		/*
 		Return the shader program
 		@return - int containing the shader program
@@ -131,17 +177,52 @@ namespace cs557
 		*/
 		glm::vec3 getCentroid(void){return centroid;}
 
+
+		/*!
+		Return the vertex positions, moved to the center of the bounding box, 
+		and the triangle indices, three per triangle.
+		*/
+		const std::vector<glm::vec3>& getVertices(void){return cpu_vertices;}
+		const std::vector<int>& getIndices(void){return cpu_indices;}
+
+
+		/*!
+		Select the level of detail to draw. Level 0 is the original mesh. 
+		@param level - the level, 0 to getNumLODs() - 1.
+		@return - false, if the level does not exist. 
+		*/
+		bool setLOD(int level);
+
+
+		/*!
+		Return the number of levels of detail, at least 1.
+		*/
+		int getNumLODs(void){return (std::max)(1, (int)lod_error.size());}
+
+
+		/*!
+		Return the geometric error of a level in model units. Level 0 has no error. 
+		*/
+		float getLODError(int level){return level > 0 && level < lod_error.size() ? lod_error[level] : 0.0f;}
+
 	protected:
 
 		/*
 		Process the diffuse, ambient, and specular texture of the object. 
 		The function loads the textures from a file (using OpenCV), creates the texture object, 
-		and copies the textures to the gpu.
+		and copies the textures to the gpu. Meshes and models with the same texture file share one texture object.
 		@param program - the shader program for this object. 
-		@param curMesh - the current mesh that this instance creates.
+		@param material - the material of the current mesh.
 		@param path - the path and file from which this object gets loaded. The function extracts the path.
 		*/
-		void processTextures(int& program, objl::Mesh& curMesh, string path);
+		void processTextures(int& program, const objl::Material& material, string path);
+
+
+		/*
+		Group the index ranges of the current level of detail into one draw batch per material and texture. 
+		Adjacent ranges are merged. 
+		*/
+		void buildBatches(void);
 
 
 		int vaoID[1]; // Our Vertex Array Object
@@ -153,13 +234,46 @@ namespace cs557
 		int viewMatrixLocation;
 		int modelMatrixLocation;
 		int projMatrixLocation;
+		int instanceLocation; // the first of four attributes of in_InstanceMatrix, -1 if the program has none
+
+		// per-instance model matrices for drawInstanced
+		GLuint					instance_vbo;
+		size_t					instance_capacity; // number of matrices the buffer can hold
+
+		// vertex positions only, for drawGeometry
+		GLuint					geometry_vao;
+		int						geometry_location; // the attribute location geometry_vao uses, -1 if not set up
 
 		// indices to render
 		std::vector<int>		start_index;
 		std::vector<int>		length;
+		GLenum					index_type; // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+		int						index_size; // bytes per index
+
+		// levels of detail, index ranges per level and mesh
+		std::vector<std::vector<int> >	lod_start;
+		std::vector<std::vector<int> >	lod_length;
+		std::vector<float>				lod_error;
+		int								lod_level;
 
 		std::vector<cs557::Material>		materials;//material per mesh
 		std::vector < cs557::TexMaterial>	textures;// textures per mesh
+		std::vector<string>					texture_files; // one entry per texture reference, to release them
+
+		// draw batches, the index ranges of all meshes with the same material and texture
+		typedef struct _DrawBatch {
+			int							material; // the mesh whose material and texture the batch uses
+			std::vector<GLsizei>		count; // number of indices per range
+			std::vector<const GLvoid*>	offset; // byte offset per range
+
+			_DrawBatch()
+			{
+				material = 0;
+			}
+		}DrawBatch;
+
+		std::vector<int>					mesh_material; // per mesh, the first mesh with the same material and texture
+		std::vector<DrawBatch>				batches;
 
 		glm::mat4							modelMatrix;
 
@@ -172,5 +286,9 @@ namespace cs557
 		// boudning box
 		glm::vec3							boundingbox;
 		glm::vec3							centroid;
+
+		// vertices and indices in local coordinates
+		std::vector<glm::vec3>				cpu_vertices;
+		std::vector<int>					cpu_indices;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,789 @@
+#include "OBJParser.h"
+
+#include <thread>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <cmath>
+#include <cstring>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+std::mutex							cs557::OBJParser::_cache_mutex;
+std::string							cs557::OBJParser::_cache_key = "";
+std::shared_ptr<const cs557::OBJParser::OBJData>	cs557::OBJParser::_cache;
+
+
+namespace cs557
+{
+namespace objparser
+{
+	// corner index encoding: >= 0 absolute, -1 missing, < -1 relative to the first vertex of the chunk.
+	const int missing = -1;
+	const int relative = 1 << 30;
+
+
+	/*
+	A read-only memory-mapped file.
+	*/
+	class MappedFile
+	{
+	public:
+		MappedFile() : data(NULL), size(0), _file(NULL), _map(NULL) {}
+		~MappedFile() { close(); }
+
+		bool open(const std::string& path)
+		{
+#ifdef _WIN32
+			HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+			if (file == INVALID_HANDLE_VALUE) return false;
+			LARGE_INTEGER file_size;
+			GetFileSizeEx(file, &file_size);
+			size = (size_t)file_size.QuadPart;
+			_file = file;
+			if (size == 0) return true;
+
+			HANDLE map = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (map == NULL) { close(); return false; }
+			_map = map;
+			data = (const char*)MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+#else
+			int fd = ::open(path.c_str(), O_RDONLY);
+			if (fd < 0) return false;
+			struct stat st;
+			fstat(fd, &st);
+			size = (size_t)st.st_size;
+			if (size == 0) { ::close(fd); return true; }
+
+			void* ptr = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			::close(fd); // the mapping stays valid
+			data = ptr == MAP_FAILED ? NULL : (const char*)ptr;
+#endif
+			if (data == NULL) { close(); return false; }
+			return true;
+		}
+
+		void close(void)
+		{
+#ifdef _WIN32
+			if (data != NULL) UnmapViewOfFile(data);
+			if (_map != NULL) CloseHandle((HANDLE)_map);
+			if (_file != NULL) CloseHandle((HANDLE)_file);
+#else
+			if (data != NULL) munmap((void*)data, size);
+#endif
+			data = NULL;
+			size = 0;
+			_file = NULL;
+			_map = NULL;
+		}
+
+		const char*	data;
+		size_t		size;
+
+	private:
+		void*		_file;
+		void*		_map;
+	};
+
+
+	/*
+	An 'o', 'g', 'usemtl', or 'mtllib' line, before face 'face' of its chunk.
+	*/
+	typedef struct _Event {
+		typedef enum { NAME, MATERIAL, LIBRARY }Type;
+		Type		type;
+		int			face;
+		std::string	text;
+	}Event;
+
+
+	/*
+	The content of one chunk of the file.
+	*/
+	typedef struct _Chunk {
+		const char*				begin;
+		const char*				end;
+
+		std::vector<glm::vec3>	v;
+		std::vector<glm::vec2>	vt;
+		std::vector<glm::vec3>	vn;
+
+		std::vector<int>		corners; // (v, vt, vn) per corner
+		std::vector<int>		face_begin; // first corner per face, plus the end
+		std::vector<Event>		events;
+
+		// after the triangulation
+		std::vector<int>		triangles; // three corners per triangle
+		std::vector<int>		face_triangles; // first triangle per face, plus the end
+		std::vector<glm::vec3>	face_normal;
+	}Chunk;
+
+
+	/*
+	Run f(i) for i = 0 to n - 1 on all threads.
+	*/
+	template<typename F>
+	void ParallelFor(int n, int num_threads, F f)
+	{
+		int T = (std::min)(n, num_threads);
+		if (T <= 1) {
+			for (int i = 0; i < n; i++) f(i);
+			return;
+		}
+
+		std::atomic<int> next(0);
+		std::vector<std::thread> threads;
+		for (int t = 0; t < T; t++) {
+			threads.push_back(std::thread([&]() {
+				for (int i = next++; i < n; i = next++) f(i);
+			}));
+		}
+		for (auto& t : threads) t.join();
+	}
+
+
+	inline bool IsSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+	inline void SkipSpace(const char*& p, const char* end)
+	{
+		while (p < end && IsSpace(*p)) p++;
+	}
+
+	inline const char* LineEnd(const char* p, const char* end)
+	{
+		const char* e = (const char*)memchr(p, '\n', end - p);
+		return e == NULL ? end : e;
+	}
+
+
+	/*
+	Return the rest of the line without leading and trailing white space.
+	*/
+	inline std::string Tail(const char* p, const char* end)
+	{
+		SkipSpace(p, end);
+		while (end > p && IsSpace(*(end - 1))) end--;
+		return std::string(p, end);
+	}
+
+
+	/*
+	Parse a signed integer.
+	*/
+	inline bool ParseInt(const char*& p, const char* end, int& value)
+	{
+		bool negative = false;
+		if (p < end && (*p == '-' || *p == '+')) {
+			negative = *p == '-';
+			p++;
+		}
+		if (p >= end || *p < '0' || *p > '9') return false;
+
+		int v = 0;
+		while (p < end && *p >= '0' && *p <= '9') {
+			v = v * 10 + (*p - '0');
+			p++;
+		}
+		value = negative ? -v : v;
+		return true;
+	}
+
+
+	/*
+	Parse a decimal floating point number, e.g., -1.25e-3.
+	*/
+	inline bool ParseFloat(const char*& p, const char* end, float& value)
+	{
+		static const double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+		SkipSpace(p, end);
+		const char* start = p;
+
+		bool negative = false;
+		if (p < end && (*p == '-' || *p == '+')) {
+			negative = *p == '-';
+			p++;
+		}
+
+		// up to 19 significant digits fit into the mantissa
+		unsigned long long mantissa = 0;
+		int digits = 0;
+		int exponent = 0;
+		bool any = false;
+		while (p < end && *p >= '0' && *p <= '9') {
+			if (digits < 19) { mantissa = mantissa * 10 + (*p - '0'); if (mantissa > 0) digits++; }
+			else exponent++;
+			p++;
+			any = true;
+		}
+		if (p < end && *p == '.') {
+			p++;
+			while (p < end && *p >= '0' && *p <= '9') {
+				if (digits < 19) { mantissa = mantissa * 10 + (*p - '0'); if (mantissa > 0) digits++; exponent--; }
+				p++;
+				any = true;
+			}
+		}
+		if (!any) {
+			p = start;
+			return false;
+		}
+		if (p < end && (*p == 'e' || *p == 'E')) {
+			const char* e = p + 1;
+			int exp_value = 0;
+			if (ParseInt(e, end, exp_value)) {
+				exponent += exp_value;
+				p = e;
+			}
+		}
+
+		double d = (double)mantissa;
+		if (exponent < 0) d = exponent >= -22 ? d / pow10[-exponent] : d * std::pow(10.0, exponent);
+		else if (exponent > 0) d = exponent <= 22 ? d * pow10[exponent] : d * std::pow(10.0, exponent);
+
+		value = (float)(negative ? -d : d);
+		return true;
+	}
+
+
+	/*
+	Parse one corner of a face, v, v/vt, v//vn, or v/vt/vn.
+	*/
+	inline bool ParseCorner(const char*& p, const char* end, const Chunk& chunk, int corner[3])
+	{
+		corner[0] = corner[1] = corner[2] = missing;
+		int sizes[3] = { (int)chunk.v.size(), (int)chunk.vt.size(), (int)chunk.vn.size() };
+
+		for (int k = 0; k < 3; k++) {
+			if (k > 0) {
+				if (p >= end || *p != '/') break;
+				p++;
+			}
+			int value = 0;
+			if (!ParseInt(p, end, value)) {
+				if (k == 0) return false;
+				continue; // v//vn
+			}
+			if (value > 0) corner[k] = value - 1;
+			else if (value < 0) corner[k] = sizes[k] + value - relative;
+			else return false;
+		}
+		return true;
+	}
+
+
+	/*
+	Parse all lines of a chunk.
+	*/
+	void ParseChunk(Chunk& chunk)
+	{
+		const char* p = chunk.begin;
+		const char* end = chunk.end;
+		int corner[3];
+
+		while (p < end) {
+			const char* line_end = LineEnd(p, end);
+			SkipSpace(p, line_end);
+
+			if (p < line_end) {
+				char c0 = p[0];
+				char c1 = p + 1 < line_end ? p[1] : ' ';
+
+				if (c0 == 'v' && IsSpace(c1)) {
+					p += 2;
+					glm::vec3 v(0.0f);
+					ParseFloat(p, line_end, v.x);
+					ParseFloat(p, line_end, v.y);
+					ParseFloat(p, line_end, v.z);
+					chunk.v.push_back(v);
+				}
+				else if (c0 == 'v' && c1 == 't') {
+					p += 2;
+					glm::vec2 vt(0.0f);
+					ParseFloat(p, line_end, vt.x);
+					ParseFloat(p, line_end, vt.y);
+					chunk.vt.push_back(vt);
+				}
+				else if (c0 == 'v' && c1 == 'n') {
+					p += 2;
+					glm::vec3 vn(0.0f);
+					ParseFloat(p, line_end, vn.x);
+					ParseFloat(p, line_end, vn.y);
+					ParseFloat(p, line_end, vn.z);
+					chunk.vn.push_back(vn);
+				}
+				else if (c0 == 'f' && IsSpace(c1)) {
+					p += 2;
+					int first = (int)chunk.corners.size();
+					while (true) {
+						SkipSpace(p, line_end);
+						if (p >= line_end || !ParseCorner(p, line_end, chunk, corner)) break;
+						chunk.corners.insert(chunk.corners.end(), corner, corner + 3);
+					}
+					// faces with less than three corners are ignored
+					if (chunk.corners.size() - first < 9) chunk.corners.resize(first);
+					else chunk.face_begin.push_back(first);
+				}
+				else if ((c0 == 'o' || c0 == 'g') && IsSpace(c1)) {
+					Event e = { Event::NAME, (int)chunk.face_begin.size(), Tail(p + 1, line_end) };
+					chunk.events.push_back(e);
+				}
+				else if (line_end - p > 6 && strncmp(p, "usemtl", 6) == 0 && IsSpace(p[6])) {
+					Event e = { Event::MATERIAL, (int)chunk.face_begin.size(), Tail(p + 6, line_end) };
+					chunk.events.push_back(e);
+				}
+				else if (line_end - p > 6 && strncmp(p, "mtllib", 6) == 0 && IsSpace(p[6])) {
+					Event e = { Event::LIBRARY, (int)chunk.face_begin.size(), Tail(p + 6, line_end) };
+					chunk.events.push_back(e);
+				}
+			}
+			p = line_end + 1;
+		}
+		chunk.face_begin.push_back((int)chunk.corners.size());
+	}
+
+
+	/*
+	Return true if point p is inside the 2D triangle a, b, c (counterclockwise).
+	*/
+	inline bool InTriangle(const glm::vec2& p, const glm::vec2& a, const glm::vec2& b, const glm::vec2& c)
+	{
+		auto cross = [](const glm::vec2& o, const glm::vec2& u, const glm::vec2& v) {
+			return (u.x - o.x) * (v.y - o.y) - (u.y - o.y) * (v.x - o.x);
+		};
+		return cross(a, b, p) >= 0.0f && cross(b, c, p) >= 0.0f && cross(c, a, p) >= 0.0f;
+	}
+
+
+	/*
+	Triangulate a polygon with n corners. Returns corner positions 0 to n - 1.
+	Convex polygons become a fan, concave polygons are clipped ear by ear.
+	*/
+	void Triangulate(const std::vector<glm::vec3>& p, const glm::vec3& normal, std::vector<int>& triangles)
+	{
+		int n = (int)p.size();
+
+		bool convex = true;
+		for (int i = 0; i < n && convex; i++) {
+			glm::vec3 a = p[(i + 1) % n] - p[i];
+			glm::vec3 b = p[(i + 2) % n] - p[(i + 1) % n];
+			if (glm::dot(glm::cross(a, b), normal) < 0.0f) convex = false;
+		}
+		if (convex) {
+			for (int i = 1; i + 1 < n; i++) {
+				triangles.push_back(0);
+				triangles.push_back(i);
+				triangles.push_back(i + 1);
+			}
+			return;
+		}
+
+		// project the polygon onto the plane of its dominant normal axis, counterclockwise
+		glm::vec3 an = glm::abs(normal);
+		int ax = an.x > an.y && an.x > an.z ? 0 : (an.y > an.z ? 1 : 2);
+		int u = (ax + 1) % 3;
+		int v = (ax + 2) % 3;
+		float s = normal[ax] >= 0.0f ? 1.0f : -1.0f;
+		std::vector<glm::vec2> q(n);
+		for (int i = 0; i < n; i++) q[i] = glm::vec2(p[i][u], s * p[i][v]);
+
+		std::vector<int> remaining(n);
+		for (int i = 0; i < n; i++) remaining[i] = i;
+
+		while (remaining.size() > 3) {
+			int m = (int)remaining.size();
+			bool clipped = false;
+			for (int i = 0; i < m && !clipped; i++) {
+				int i0 = remaining[(i + m - 1) % m];
+				int i1 = remaining[i];
+				int i2 = remaining[(i + 1) % m];
+
+				// the corner must be convex, and no other corner inside the ear
+				glm::vec2 e0 = q[i1] - q[i0];
+				glm::vec2 e1 = q[i2] - q[i1];
+				if (e0.x * e1.y - e0.y * e1.x <= 0.0f) continue;
+
+				bool empty = true;
+				for (int j = 0; j < m && empty; j++) {
+					int k = remaining[j];
+					if (k == i0 || k == i1 || k == i2) continue;
+					if (InTriangle(q[k], q[i0], q[i1], q[i2])) empty = false;
+				}
+				if (!empty) continue;
+
+				triangles.push_back(i0);
+				triangles.push_back(i1);
+				triangles.push_back(i2);
+				remaining.erase(remaining.begin() + i);
+				clipped = true;
+			}
+
+			// degenerated polygon, fall back to a fan
+			if (!clipped) {
+				for (int i = 1; i + 1 < (int)remaining.size(); i++) {
+					triangles.push_back(remaining[0]);
+					triangles.push_back(remaining[i]);
+					triangles.push_back(remaining[i + 1]);
+				}
+				return;
+			}
+		}
+		triangles.push_back(remaining[0]);
+		triangles.push_back(remaining[1]);
+		triangles.push_back(remaining[2]);
+	}
+
+
+	/*
+	Resolve the corner indices and triangulate all faces of a chunk.
+	@param v_offset, vt_offset, vn_offset - the number of elements of all previous chunks.
+	*/
+	void TriangulateChunk(Chunk& chunk, const std::vector<glm::vec3>& positions, int v_offset, int vt_offset, int vn_offset)
+	{
+		int offsets[3] = { v_offset, vt_offset, vn_offset };
+		int sizes[3] = { (int)positions.size(), -1, -1 };
+
+		for (int i = 0; i < chunk.corners.size(); i++) {
+			int& c = chunk.corners[i];
+			if (c < missing) c = offsets[i % 3] + c + relative;
+			else if (c > missing && i % 3 == 0 && c >= sizes[0]) c = missing;
+		}
+
+		int F = (int)chunk.face_begin.size() - 1;
+		chunk.face_triangles.resize(F + 1);
+		chunk.face_normal.resize(F);
+
+		std::vector<glm::vec3> p;
+		std::vector<int> local;
+		for (int f = 0; f < F; f++) {
+			chunk.face_triangles[f] = (int)chunk.triangles.size() / 3;
+
+			int first = chunk.face_begin[f] / 3;
+			int n = chunk.face_begin[f + 1] / 3 - first;
+
+			// faces with invalid positions are skipped
+			p.resize(n);
+			bool valid = true;
+			for (int i = 0; i < n; i++) {
+				int v = chunk.corners[3 * (first + i)];
+				if (v < 0) { valid = false; break; }
+				p[i] = positions[v];
+			}
+			if (!valid) continue;
+
+			// Newell's normal
+			glm::vec3 normal(0.0f);
+			for (int i = 0; i < n; i++) {
+				const glm::vec3& a = p[i];
+				const glm::vec3& b = p[(i + 1) % n];
+				normal.x += (a.y - b.y) * (a.z + b.z);
+				normal.y += (a.z - b.z) * (a.x + b.x);
+				normal.z += (a.x - b.x) * (a.y + b.y);
+			}
+			float len = glm::length(normal);
+			chunk.face_normal[f] = len > 0.0f ? normal / len : glm::vec3(0.0f, 0.0f, 1.0f);
+
+			if (n == 3) {
+				chunk.triangles.push_back(first);
+				chunk.triangles.push_back(first + 1);
+				chunk.triangles.push_back(first + 2);
+				continue;
+			}
+
+			local.clear();
+			Triangulate(p, chunk.face_normal[f], local);
+			for (int i : local) chunk.triangles.push_back(first + i);
+		}
+		chunk.face_triangles[F] = (int)chunk.triangles.size() / 3;
+	}
+
+
+	/*
+	Hash of a (v, vt, vn) corner.
+	*/
+	inline size_t HashCorner(const int* c)
+	{
+		size_t h = (size_t)(unsigned int)c[0] * 73856093u;
+		h ^= (size_t)(unsigned int)c[1] * 19349663u;
+		h ^= (size_t)(unsigned int)c[2] * 83492791u;
+		return h ^ (h >> 16);
+	}
+
+}//namespace objparser
+}//namespace cs557
+
+
+using namespace cs557::objparser;
+
+
+/*!
+Load an obj file, or return the last loaded model if the file did not change.
+*/
+//static
+std::shared_ptr<const cs557::OBJParser::OBJData> cs557::OBJParser::Load(const std::string& path_and_file)
+{
+	// the file is identified by its name, size, and modification time
+	struct stat st;
+	if (stat(path_and_file.c_str(), &st) != 0) {
+		std::cout << "[ERROR] - OBJParser: cannot open file " << path_and_file << "." << std::endl;
+		return std::shared_ptr<const OBJData>();
+	}
+	std::string key = path_and_file + ":" + std::to_string((long long)st.st_size) + ":" + std::to_string((long long)st.st_mtime);
+
+	std::lock_guard<std::mutex> lock(_cache_mutex);
+	if (_cache && key == _cache_key) return _cache;
+
+	std::shared_ptr<OBJData> data = std::make_shared<OBJData>();
+	if (!Parse(path_and_file, *data)) {
+		return std::shared_ptr<const OBJData>();
+	}
+
+	_cache = data;
+	_cache_key = key;
+	return _cache;
+}
+
+
+/*!
+Release the last loaded model.
+*/
+//static
+void cs557::OBJParser::Clear(void)
+{
+	std::lock_guard<std::mutex> lock(_cache_mutex);
+	_cache.reset();
+	_cache_key = "";
+}
+
+
+/*!
+Parse an obj file.
+*/
+//static
+bool cs557::OBJParser::Parse(const std::string& path_and_file, OBJData& data, int num_threads)
+{
+	data = OBJData();
+
+	MappedFile file;
+	if (!file.open(path_and_file)) {
+		std::cout << "[ERROR] - OBJParser: cannot open file " << path_and_file << "." << std::endl;
+		return false;
+	}
+	if (file.size == 0) return false;
+
+	if (num_threads <= 0) num_threads = (std::max)(1, (int)std::thread::hardware_concurrency());
+
+	//-------------------------------------------------------------------------------------
+	// Split the file into chunks at line boundaries; about 4 MB per chunk.
+	const size_t chunk_size = 4 << 20;
+	int num_chunks = (int)(std::min)((size_t)num_threads * 4, file.size / chunk_size + 1);
+
+	std::vector<Chunk> chunks(num_chunks);
+	const char* begin = file.data;
+	const char* end = file.data + file.size;
+	for (int i = 0; i < num_chunks; i++) {
+		const char* e = i == num_chunks - 1 ? end : file.data + file.size / num_chunks * (i + 1);
+		if (e < begin) e = begin;
+		e = e < end ? LineEnd(e, end) : end;
+		if (e < end) e++; // after the line break
+		chunks[i].begin = begin;
+		chunks[i].end = e;
+		begin = e;
+	}
+
+	//-------------------------------------------------------------------------------------
+	// Parse the chunks in parallel
+	ParallelFor(num_chunks, num_threads, [&](int i) { ParseChunk(chunks[i]); });
+
+	// concatenate the vertex data
+	std::vector<int> v_offset(num_chunks + 1, 0), vt_offset(num_chunks + 1, 0), vn_offset(num_chunks + 1, 0);
+	for (int i = 0; i < num_chunks; i++) {
+		v_offset[i + 1] = v_offset[i] + (int)chunks[i].v.size();
+		vt_offset[i + 1] = vt_offset[i] + (int)chunks[i].vt.size();
+		vn_offset[i + 1] = vn_offset[i] + (int)chunks[i].vn.size();
+	}
+	std::vector<glm::vec3> positions, normals;
+	std::vector<glm::vec2> texcoords;
+	positions.reserve(v_offset[num_chunks]);
+	texcoords.reserve(vt_offset[num_chunks]);
+	normals.reserve(vn_offset[num_chunks]);
+	for (auto& c : chunks) {
+		positions.insert(positions.end(), c.v.begin(), c.v.end());
+		texcoords.insert(texcoords.end(), c.vt.begin(), c.vt.end());
+		normals.insert(normals.end(), c.vn.begin(), c.vn.end());
+		std::vector<glm::vec3>().swap(c.v);
+		std::vector<glm::vec2>().swap(c.vt);
+		std::vector<glm::vec3>().swap(c.vn);
+	}
+
+	//-------------------------------------------------------------------------------------
+	// Triangulate in parallel
+	ParallelFor(num_chunks, num_threads, [&](int i) {
+		TriangulateChunk(chunks[i], positions, v_offset[i], vt_offset[i], vn_offset[i]);
+	});
+
+	//-------------------------------------------------------------------------------------
+	// Materials
+	std::vector<objl::Material> materials;
+	std::string path = "";
+	size_t idx = path_and_file.find_last_of("/");
+	if (idx != std::string::npos) path = path_and_file.substr(0, idx + 1);
+	for (auto& c : chunks) {
+		for (auto& e : c.events) {
+			if (e.type != Event::LIBRARY) continue;
+			data.libraries.push_back(path + e.text);
+			ParseMaterials(path + e.text, materials);
+		}
+	}
+
+	//-------------------------------------------------------------------------------------
+	// Merge identical corners into one vertex and create the meshes
+	size_t num_corners = 0;
+	for (auto& c : chunks) num_corners += c.triangles.size();
+
+	size_t table_size = 16;
+	while (table_size < 2 * num_corners) table_size *= 2;
+	std::vector<int> table(table_size, -1); // vertex index per slot
+	std::vector<int> vertex_corner; // (v, vt, vn) per vertex, for the comparison
+	vertex_corner.reserve(num_corners);
+
+	data.indices.reserve(num_corners);
+	data.positions.reserve(num_corners / 2);
+	data.texcoords.reserve(num_corners / 2);
+	data.normals.reserve(num_corners / 2);
+
+	OBJRange mesh;
+	auto close_mesh = [&]() {
+		mesh.count = (int)data.indices.size() - mesh.start;
+		if (mesh.count > 0) data.meshes.push_back(mesh);
+		mesh.start = (int)data.indices.size();
+	};
+
+	for (auto& c : chunks) {
+		int F = (int)c.face_begin.size() - 1;
+		int e = 0;
+		for (int f = 0; f <= F; f++) {
+
+			// 'o', 'g', and 'usemtl' start a new mesh
+			for (; e < c.events.size() && c.events[e].face <= f; e++) {
+				const Event& ev = c.events[e];
+				if (ev.type == Event::LIBRARY) continue;
+				close_mesh();
+				if (ev.type == Event::NAME) mesh.name = ev.text.empty() ? "unnamed" : ev.text;
+				else {
+					mesh.material = objl::Material();
+					for (auto& m : materials) {
+						if (m.name == ev.text) { mesh.material = m; break; }
+					}
+				}
+			}
+			if (f == F) break;
+
+			for (int t = c.face_triangles[f]; t < c.face_triangles[f + 1]; t++) {
+				for (int k = 0; k < 3; k++) {
+					const int* corner = &c.corners[3 * c.triangles[3 * t + k]];
+					int vt = corner[1] >= 0 && corner[1] < texcoords.size() ? corner[1] : missing;
+					int vn = corner[2] >= 0 && corner[2] < normals.size() ? corner[2] : missing;
+					int key[3] = { corner[0], vt, vn };
+
+					// corners without normal get the face normal and are not merged
+					int vertex = -1;
+					size_t slot = 0;
+					if (vn != missing) {
+						slot = HashCorner(key) & (table_size - 1);
+						while (table[slot] >= 0) {
+							const int* other = &vertex_corner[3 * table[slot]];
+							if (other[0] == key[0] && other[1] == key[1] && other[2] == key[2]) {
+								vertex = table[slot];
+								break;
+							}
+							slot = (slot + 1) & (table_size - 1);
+						}
+					}
+
+					if (vertex < 0) {
+						vertex = (int)data.positions.size();
+						data.positions.push_back(positions[key[0]]);
+						data.texcoords.push_back(vt != missing ? texcoords[vt] : glm::vec2(0.0f, 0.0f));
+						data.normals.push_back(vn != missing ? normals[vn] : c.face_normal[f]);
+						vertex_corner.insert(vertex_corner.end(), key, key + 3);
+						if (vn != missing) table[slot] = vertex;
+					}
+					data.indices.push_back(vertex);
+				}
+			}
+		}
+	}
+	close_mesh();
+
+	return data.indices.size() > 0;
+}
+
+
+/*!
+Read the materials of a .mtl file.
+*/
+//static
+bool cs557::OBJParser::ParseMaterials(const std::string& path_and_file, std::vector<objl::Material>& materials)
+{
+	std::ifstream file(path_and_file);
+	if (!file.is_open()) {
+		std::cout << "[ERROR] - OBJParser: cannot open material file " << path_and_file << "." << std::endl;
+		return false;
+	}
+
+	objl::Material material;
+	bool listening = false;
+
+	std::string line;
+	while (std::getline(file, line)) {
+		const char* p = line.c_str();
+		const char* end = p + line.size();
+		SkipSpace(p, end);
+
+		// the first token
+		const char* t = p;
+		while (t < end && !IsSpace(*t)) t++;
+		std::string token(p, t);
+		p = t;
+
+		if (token == "newmtl") {
+			if (listening) materials.push_back(material);
+			listening = true;
+			material = objl::Material();
+			material.name = Tail(p, end);
+			if (material.name.empty()) material.name = "none";
+		}
+		else if (token == "Ka" || token == "Kd" || token == "Ks") {
+			float x, y, z;
+			if (!ParseFloat(p, end, x) || !ParseFloat(p, end, y) || !ParseFloat(p, end, z)) continue;
+			objl::Vector3 c(x, y, z);
+			if (token == "Ka") material.Ka = c;
+			else if (token == "Kd") material.Kd = c;
+			else material.Ks = c;
+		}
+		else if (token == "Ns") ParseFloat(p, end, material.Ns);
+		else if (token == "Ni") ParseFloat(p, end, material.Ni);
+		else if (token == "d") ParseFloat(p, end, material.d);
+		else if (token == "illum") { SkipSpace(p, end); ParseInt(p, end, material.illum); }
+		else if (token == "map_Ka") material.map_Ka = Tail(p, end);
+		else if (token == "map_Kd") material.map_Kd = Tail(p, end);
+		else if (token == "map_Ks") material.map_Ks = Tail(p, end);
+		else if (token == "map_Ns") material.map_Ns = Tail(p, end);
+		else if (token == "map_d") material.map_d = Tail(p, end);
+		else if (token == "map_Bump" || token == "map_bump" || token == "bump") material.map_bump = Tail(p, end);
+	}
+
+	if (listening) materials.push_back(material);
+	return true;
+}
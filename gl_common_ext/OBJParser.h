@@ -0,0 +1,132 @@
+#pragma once
+/*
+@class OBJParser
+@brief	A fast, parallel parser for Wavefront .obj files.
+
+The parser maps the file into memory, splits it into chunks at line boundaries, and parses the chunks in parallel.
+Numbers are parsed in place, without string copies. Polygons are triangulated per face: convex polygons
+as a fan, concave polygons with ear clipping. Identical (v/vt/vn) corners are merged into one vertex,
+thus, all meshes share one vertex buffer, and each mesh is a range of the index buffer.
+
+Meshes start at 'o', 'g', and 'usemtl' lines. The materials are read from the files given by 'mtllib'
+and stored as objl::Material, see OBJLoader.h.
+Corners without a normal get the normal of their polygon and are not merged, as the objl loader does.
+
+Load() keeps the last model, so a second object that loads the same file does not parse it again.
+Call Clear() once all objects of the model are created, so that the parsed model does not stay in memory.
+
+Features:
+- Parses vertices, texture coordinates, normals, faces with 3 and more corners, and negative (relative) indices.
+- Reads the .mtl material files.
+
+Usage:
+std::shared_ptr<const cs557::OBJParser::OBJData> data = cs557::OBJParser::Load("model.obj");
+glDrawElements(GL_TRIANGLES, data->meshes[0].count, GL_UNSIGNED_INT, (GLint*)(sizeof(int) * data->meshes[0].start));
+cs557::OBJParser::Clear(); // after the last object that uses model.obj
+
+Rafael Radkowski
+Iowa State University
+rafael@iastate.edu
+515 294 7044
+MIT License
+-------------------------------------------------------------------------------------------------------
+Last edited:
+Oct 19, 2026, RR
+- Created. Replaces objl::Loader in OBJModel; the materials keep the objl::Material type.
+- Added Clear() to release the last loaded model. 
+*/
+
+// stl
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+
+// glm
+#include <glm/glm.hpp>
+
+// local
+#include "OBJLoader.h" // for objl::Material
+
+
+namespace cs557
+{
+
+class OBJParser
+{
+public:
+
+	/*
+	A mesh, a range of the index buffer.
+	*/
+	typedef struct _OBJRange {
+		std::string		name;
+		objl::Material	material;
+		int				start; // first index
+		int				count; // number of indices
+
+		_OBJRange()
+		{
+			name = "unnamed";
+			start = 0;
+			count = 0;
+		}
+	}OBJRange;
+
+
+	/*
+	The model. All arrays with vertex data have the same size.
+	*/
+	typedef struct _OBJData {
+		std::vector<glm::vec3>	positions;
+		std::vector<glm::vec2>	texcoords; // (0, 0) if the file has none
+		std::vector<glm::vec3>	normals;
+		std::vector<int>		indices; // three per triangle
+		std::vector<OBJRange>	meshes;
+		std::vector<std::string> libraries; // the .mtl files, with the path of the obj file
+	}OBJData;
+
+
+	/*!
+	Load an obj file, or return the last loaded model if the file did not change.
+	@param path_and_file - the relative or absolute path and file.
+	@return - the model, or an empty pointer if the file cannot be read.
+	*/
+	static std::shared_ptr<const OBJData> Load(const std::string& path_and_file);
+
+
+	/*!
+	Release the last loaded model. Models that callers still hold stay valid.
+	*/
+	static void Clear(void);
+
+
+	/*!
+	Parse an obj file.
+	@param path_and_file - the relative or absolute path and file.
+	@param data - location for the model.
+	@param num_threads - the number of threads, 0 uses all cores.
+	@return - true, if the file contains at least one triangle.
+	*/
+	static bool Parse(const std::string& path_and_file, OBJData& data, int num_threads = 0);
+
+
+	/*!
+	Read the materials of a .mtl file.
+	@param path_and_file - the relative or absolute path and file.
+	@param materials - the materials are appended to this list.
+	@return - true, if the file was read.
+	*/
+	static bool ParseMaterials(const std::string& path_and_file, std::vector<objl::Material>& materials);
+
+
+private:
+
+	// the last loaded model
+	static std::mutex						_cache_mutex;
+	static std::string						_cache_key;
+	static std::shared_ptr<const OBJData>	_cache;
+};
+
+}//namespace cs557
@@ -13,6 +13,8 @@
  Jan. 19, 2018:
  - Added the function CreateRenderToTexture32Bit() to render to 32 bit targets.
  - Changed the depth target in CreateRenderToTexture from GL_DEPTH_COMPONENT23 to GL_DEPTH_COMPONENT32
+ Oct 19, 2026, RR:
+ - Added the function CreateRenderToTextureWithID() with an additional 16-bit unsigned integer target for instance ids.
 ***************************/
 #ifndef RENDERTOTEXTURE
 #define RENDERTOTEXTURE
@@ -117,4 +119,33 @@ inline void CreateRenderToTexture32Bit(int texture_width, int texture_height, un
 
 
 
+/*
+Create a frame buffer object for OpenGL with an RGB color target, an instance id target, and a depth target.
+The id target is GL_R16UI at GL_COLOR_ATTACHMENT1. A fragment shader writes it with 
+'layout(location = 1) out uint'. Clear it with glClearBufferuiv(GL_COLOR, 1, ...), glClear does not clear integer targets.
+@param texture_width, texture_height - the width and height of the texture to render the content to.
+@param frame_buffer_object -  a variable in which this function can write the frame buffer object idx into.
+@param texture_color -  a variable in which this function can write the color texture idx into.
+@param texture_depth -  a variable in which this function can write the depth texture idx into.
+@param texture_id -  a variable in which this function can write the id texture idx into.
+*/
+inline void CreateRenderToTextureWithID(int texture_width, int texture_height, unsigned int& frame_buffer_object, unsigned int& texture_color, unsigned int& texture_depth, unsigned int& texture_id)
+{
+	CreateRenderToTexture(texture_width, texture_height, frame_buffer_object, texture_color, texture_depth);
+
+	// create a texture for the ids
+	glGenTextures(1, &texture_id);
+	glBindTexture(GL_TEXTURE_2D, texture_id);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_R16UI, texture_width, texture_height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, texture_id, 0);
+
+	static const GLenum draw_buffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+	glDrawBuffers(2, draw_buffers);
+}
+
+
+
 #endif
\ No newline at end of file
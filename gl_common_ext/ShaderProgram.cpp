@@ -1,10 +1,59 @@
 #include "ShaderProgram.h"
+#include "CommonTypes.h"
 
 #ifdef _WIN32
 #else
 #include <sys/stat.h>
 #endif
 
+#include <cstdio>
+#include <cstring>
+
+
+namespace cs557_ShaderProgram
+{
+    bool    binary_cache = true;
+    string  binary_cache_path = "./shader_cache";
+
+    const char magic[8] = { 'S', 'F', 'S', 'H', 'A', 'D', 'E', 'R' };
+    const uint32_t version = 1;
+    const GLint max_binary = 1 << 26;
+
+    /*
+    64-bit FNV-1a hash of a string.
+    */
+    uint64_t Hash(const string& s)
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        for (unsigned char c : s) {
+            hash = (hash ^ c) * 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    /*
+    The cache file of a program, named by the hash of the key.
+    */
+    string BinaryFile(uint64_t hash)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.glbin", (unsigned long long)hash);
+        return binary_cache_path + "/" + name;
+    }
+
+    /*
+    The number of binary formats of the driver. The cache is not used if it is 0.
+    */
+    bool BinarySupported(void)
+    {
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        return formats > 0;
+    }
+}
+
+using namespace cs557_ShaderProgram;
+
 
 bool cs557::ShaderProgramUtils::CheckShader(GLuint shader, GLenum shader_type)
 {
@@ -92,9 +141,18 @@ GLuint cs557::CreateShaderProgram(string vertex_source, string fragment_source)
 		return program;
     }
     const char * fs_source = fragment_source.c_str();
+
+    // A cached program binary skips the compiler.
+    string key = ShaderProgramUtils::BinaryKey(vertex_source, "", fragment_source);
+    program = ShaderProgramUtils::ReadBinary(key);
+    if(program != 0){
+        glUseProgram(program);
+        return program;
+    }
     
     // This next section we'll generate the OpenGL program and attach the shaders to it so that we can render our triangle.
     program = glCreateProgram();
+    ReleaseProgramUniforms(program); // a reused id
 
 	if (program == 0)
 	{
@@ -132,6 +190,7 @@ GLuint cs557::CreateShaderProgram(string vertex_source, string fragment_source)
     glAttachShader(program, fs);
     
     // Link the program
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(program);
 
     // check the linker program for errors
@@ -142,6 +201,8 @@ GLuint cs557::CreateShaderProgram(string vertex_source, string fragment_source)
         program = -1;
         return program;
     }
+
+    ShaderProgramUtils::WriteBinary(key, program);
     
     glUseProgram(program);
     
@@ -263,9 +324,18 @@ GLuint cs557::CreateShaderProgram(string vertex_source, string geometry_source,
 		return program;
     }
     const char * fs_source = fragment_source.c_str();
+
+    // A cached program binary skips the compiler.
+    string key = ShaderProgramUtils::BinaryKey(vertex_source, geometry_source, fragment_source);
+    program = ShaderProgramUtils::ReadBinary(key);
+    if(program != 0){
+        glUseProgram(program);
+        return program;
+    }
     
     // This next section we'll generate the OpenGL program and attach the shaders to it so that we can render our triangle.
     program = glCreateProgram();
+    ReleaseProgramUniforms(program); // a reused id
 
 	if (program == 0)
 	{
@@ -314,6 +384,7 @@ GLuint cs557::CreateShaderProgram(string vertex_source, string geometry_source,
     glAttachShader(program, gs);
     glAttachShader(program, fs);
     
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(program);
     
     GLint compiled = 0;
@@ -341,6 +412,8 @@ GLuint cs557::CreateShaderProgram(string vertex_source, string geometry_source,
         return program;
     }
 
+    ShaderProgramUtils::WriteBinary(key, program);
+
     glUseProgram(program);
 
     return program;
@@ -368,3 +441,138 @@ GLuint cs557::LoadAndCreateShaderProgram(string vertex_file, string geometry_fil
     return CreateShaderProgram(vertex_source, geometry_source, fragment_source);
 
 }
+
+
+/*!
+Delete a shader program and the uniform locations cached for it.
+*/
+void cs557::DeleteShaderProgram(GLuint program)
+{
+    if(program == 0) return;
+
+    glDeleteProgram(program);
+    ReleaseProgramUniforms(program);
+}
+
+
+
+/*!
+Enable or disable the program binary cache.
+*/
+//static
+void cs557::ShaderProgramUtils::SetBinaryCache(bool enable, string path)
+{
+    binary_cache = enable;
+    binary_cache_path = path;
+}
+
+
+/*!
+Load a program from the binary cache.
+*/
+//static
+GLuint cs557::ShaderProgramUtils::ReadBinary(const string& key)
+{
+    if(!binary_cache || !BinarySupported()) return 0;
+
+    uint64_t hash = Hash(key);
+    ifstream in(BinaryFile(hash), std::ios::binary);
+    if(!in.is_open()) return 0;
+
+    char m[8];
+    uint32_t v = 0;
+    uint64_t cached_hash = 0;
+    GLenum format = 0;
+    GLint length = 0;
+    in.read(m, sizeof(m));
+    in.read((char*)&v, sizeof(v));
+    in.read((char*)&cached_hash, sizeof(cached_hash));
+    in.read((char*)&format, sizeof(format));
+    in.read((char*)&length, sizeof(length));
+    if(!in || memcmp(m, magic, sizeof(m)) != 0 || v != version || cached_hash != hash || length <= 0 || length > max_binary) return 0;
+
+    std::vector<char> binary(length);
+    in.read(&binary[0], length);
+    if(!in) return 0;
+
+    // the driver rejects binaries of other drivers or driver versions
+    GLuint program = glCreateProgram();
+    ReleaseProgramUniforms(program); // a reused id
+    glProgramBinary(program, format, &binary[0], length);
+
+    GLint linked = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if(linked == GL_FALSE){
+        DeleteShaderProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+
+/*!
+Write the binary of a linked program into the cache.
+*/
+//static
+bool cs557::ShaderProgramUtils::WriteBinary(const string& key, GLuint program)
+{
+    if(!binary_cache || !BinarySupported()) return false;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if(length <= 0 || length > max_binary) return false;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, &binary[0]);
+    if(length <= 0) return false;
+
+    if(!Exists(binary_cache_path)){
+    #ifdef _WIN32
+        try {
+            FileUtils::CreateDirectories(binary_cache_path);
+        }
+        catch (...) {}
+    #else
+        mkdir(binary_cache_path.c_str(), 0755);
+    #endif
+    }
+
+    uint64_t hash = Hash(key);
+    string file = BinaryFile(hash);
+    bool ok = FileUtils::WriteAtomic(file, [&](std::ofstream& out){
+        out.write(magic, sizeof(magic));
+        out.write((const char*)&version, sizeof(version));
+        out.write((const char*)&hash, sizeof(hash));
+        out.write((const char*)&format, sizeof(format));
+        out.write((const char*)&length, sizeof(length));
+        out.write(&binary[0], length);
+    });
+
+    if(!ok){
+        cout << "[WARNING] - ShaderProgram: cannot write the program binary cache " << file << "." << endl;
+    }
+    return ok;
+}
+
+
+/*!
+Return the cache key of a program.
+*/
+//static
+string cs557::ShaderProgramUtils::BinaryKey(const string& vertex_source, const string& geometry_source, const string& fragment_source)
+{
+    string key;
+    const GLenum names[3] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+    for(int i=0; i<3; i++){
+        const GLubyte* str = glGetString(names[i]);
+        if(str) key.append((const char*)str);
+        key.push_back('\n');
+    }
+    key.append(vertex_source);
+    key.push_back('\0');
+    key.append(geometry_source);
+    key.push_back('\0');
+    key.append(fragment_source);
+    return key;
+}
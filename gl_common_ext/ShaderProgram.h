@@ -8,6 +8,7 @@
 #include <vector>
 #include <strstream>
 #include <string>
+#include <cstdint>
 
 
 // GLEW include
@@ -71,6 +72,14 @@ namespace cs557 {
 	GLuint LoadAndCreateShaderProgram(string vertex_file, string geometry_file, string fragment_file);
 
 
+	/*!
+	Delete a shader program and the uniform locations Material and LightSource cached for it.
+	Use it instead of glDeleteProgram(), since the driver can reuse the program id.
+	@param program - the shader program id.
+	*/
+	void DeleteShaderProgram(GLuint program);
+
+
 	class ShaderProgramUtils
 	{
 	public:
@@ -104,6 +113,42 @@ namespace cs557 {
 		 @return the content as string.
 		 */
 		static string LoadFromFile(string path_and_file);
+
+
+
+		/*!
+		Enable or disable the program binary cache. It is enabled by default. 
+		CreateShaderProgram() stores the linked program binary in the cache path and loads it on the next start 
+		instead of compiling the shader code. The file name is a hash of the shader code and of the 
+		GL vendor, renderer, and version strings. Programs are compiled from the code if the driver rejects the binary. 
+		@param enable - true enables the cache.
+		@param path - the cache directory, it gets created if it does not exist.
+		*/
+		static void SetBinaryCache(bool enable, string path = "./shader_cache");
+
+
+		/*!
+		Load a program from the binary cache.
+		@param key - the shader code and the driver strings, see BinaryKey().
+		@return - the linked program, or 0 if no valid binary exists.
+		*/
+		static GLuint ReadBinary(const string& key);
+
+
+		/*!
+		Write the binary of a linked program into the cache.
+		@param key - the shader code and the driver strings, see BinaryKey().
+		@param program - the linked program.
+		@return - true, if the binary was written. 
+		*/
+		static bool WriteBinary(const string& key, GLuint program);
+
+
+		/*!
+		Return the cache key of a program: the GL vendor, renderer, and version strings and the shader code.
+		@param vertex_source, geometry_source, fragment_source - the shader code, geometry_source can be empty.
+		*/
+		static string BinaryKey(const string& vertex_source, const string& geometry_source, const string& fragment_source);
 	};
 
 }
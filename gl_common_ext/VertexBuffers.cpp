@@ -1,5 +1,7 @@
 #include "VertexBuffers.h"
 
+#include <cstddef> // offsetof
+
 
 
 
@@ -272,3 +274,57 @@ bool cs557::CreateVertexObjects53(int* vaoID, int* vboID, float* vertices_textur
 
 
 
+/*
+Create one interleaved vertex buffer object for packed vertices + an index list with 16-bit or 32-bit indices
+*/
+bool cs557::CreateVertexObjectsIndexedPacked( int* vaoID, int* vboID, int* iboID, const PackedVertex* vertices, int N, const void* indices, int I, bool short_indices,
+							int vertices_location, int tex_coord_location, int normals_location)
+{
+	if (vertices == NULL || indices == NULL)
+	{
+		std::cout << "[ERROR] - CreateVertexObjectsIndexedPacked: No vertices or indices given." << std::endl;
+		return false;
+	}
+
+	glGenVertexArrays(1, (GLuint*)vaoID); // Create our Vertex Array Object
+	glBindVertexArray(*vaoID); // Bind our Vertex Array Object so we can use it
+
+	if (vaoID[0] == -1){
+		std::cout << "[ERROR] - Vertex array object was not generated." << std::endl;
+		return false;
+	}
+
+	glGenBuffers(1, (GLuint*)vboID);
+	glGenBuffers(1, (GLuint*)iboID);
+
+	if (vboID[0] == -1 || iboID[0] == -1){
+		std::cout << "[ERROR] - The vertex buffer object or the index buffer object was not generated." << std::endl;
+		return false;
+	}
+
+	// vertices, texture coordinates, and normals in one buffer
+	GLsizei stride = sizeof(PackedVertex);
+	glBindBuffer(GL_ARRAY_BUFFER, vboID[0]);
+	glBufferData(GL_ARRAY_BUFFER, N * stride, vertices, GL_STATIC_DRAW);
+
+	glVertexAttribPointer((GLuint)vertices_location, 3, GL_FLOAT, GL_FALSE, stride, (const GLvoid*)offsetof(PackedVertex, x));
+	glEnableVertexAttribArray(vertices_location);
+
+	glVertexAttribPointer((GLuint)tex_coord_location, 2, GL_FLOAT, GL_FALSE, stride, (const GLvoid*)offsetof(PackedVertex, u));
+	glEnableVertexAttribArray(tex_coord_location);
+
+	// normalized: the shader reads values in [-1, 1]
+	glVertexAttribPointer((GLuint)normals_location, 3, GL_SHORT, GL_TRUE, stride, (const GLvoid*)offsetof(PackedVertex, nx));
+	glEnableVertexAttribArray(normals_location);
+
+
+	// Index buffer
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboID[0]);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, I * (short_indices ? sizeof(unsigned short) : sizeof(unsigned int)),
+				indices, GL_STATIC_DRAW);
+
+
+	glBindVertexArray(0); // Disable our Vertex Buffer Object
+
+	return true;
+}
@@ -4,6 +4,7 @@
 // stl include
 #include <iostream>
 #include <string>
+#include <cstdint>
 
 // GLEW include
 #include <GL/glew.h>
@@ -24,6 +25,15 @@ using namespace std;
 namespace cs557
 {
 
+	/*
+	A packed vertex for CreateVertexObjectsIndexedPacked, 28 bytes instead of 32 bytes. 
+	*/
+	typedef struct _PackedVertex {
+		float		x, y, z;		// position, 32-bit float
+		float		u, v;			// texture coordinate, 32-bit float; large textures and tiled coordinates need the precision
+		int16_t		nx, ny, nz, nw;	// normal vector, 16-bit normalized; nw is padding
+	}PackedVertex;
+
 
 	/*
 	Create a vertex array object and vertex buffer object for vertices of size 3 (x, y, z)  along with colors of size 3: (r, g, b)
@@ -89,6 +99,24 @@ namespace cs557
 	 							int vertices_location = 0, int tex_coord_location = 1, int normals_location = 2);
 
 
+	/*
+	Create one interleaved vertex buffer object for packed vertices + an index list with 16-bit or 32-bit indices
+	@param vaoID - address to store the vertex array object
+	@param vboID - address to store the vertex buffer object. ONE space is required.
+	@param iboID - address to store the index buffer object
+	@param vertices - pointer to an array with N packed vertices
+	@param N - the number of vertices
+	@param indices - pointer to an array with indices, unsigned short if short_indices is true, otherwise int.
+	@param I - the number of indices
+	@param short_indices - true for 16-bit indices. Draw with GL_UNSIGNED_SHORT in this case.
+	@param vertices_location - the GLSL vertices location 
+	@param tex_coord_location - the GLSL location of the texture coordinates.
+	@param normals_location - the GLSL normal vectors locations
+	*/
+	bool CreateVertexObjectsIndexedPacked( int* vaoID, int* vboID, int* iboID, const PackedVertex* vertices, int N, const void* indices, int I, bool short_indices,
+							int vertices_location = 0, int tex_coord_location = 1, int normals_location = 2);
+
+
 
 
 							 
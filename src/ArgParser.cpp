@@ -116,6 +116,53 @@ Arguments ArgParser::Parse(int& argc, char** argv)
 			if (argc >= pos) opt.lim_nz = -atof(  string(argv[pos+1]).c_str() );
 			else ParamError(c_arg);
 		}
+		else if(c_arg.compare("-sampler") == 0){ // pose sampler for POSE
+			if (argc > pos+1) {
+				string t(argv[pos+1]);
+				if (t.compare("RANDOM") == 0) opt.sampler = 0;
+				else if (t.compare("HALTON") == 0) opt.sampler = 1;
+				else ParamError(c_arg);
+			}
+			else ParamError(c_arg);
+		}
+		else if(c_arg.compare("-min_visible") == 0){ // min. visible fraction of the bounding box
+			if (argc > pos+1) opt.min_visible = atof(string(argv[pos+1]).c_str());
+			else ParamError(c_arg);
+		}
+		else if(c_arg.compare("-adaptive") == 0){ // adaptive tree subdivision
+			if (argc > pos+1) opt.adaptive_threshold = atof(string(argv[pos+1]).c_str());
+			else ParamError(c_arg);
+		}
+		else if(c_arg.compare("-sym") == 0 ){ // symmetry reduction
+			opt.symmetry = true;
+		}
+		else if(c_arg.compare("-lod") == 0){ // level of detail selection
+			if (argc > pos+1) opt.lod_max_error = atof(string(argv[pos+1]).c_str());
+			else ParamError(c_arg);
+		}
+		else if(c_arg.compare("-scene") == 0){ // scene models, comma-separated
+			if (argc > pos+1) {
+				std::stringstream ss(argv[pos+1]);
+				string file;
+				while (std::getline(ss, file, ','))
+					if (file.length() > 0) opt.scene_models.push_back(file);
+			}
+			else ParamError(c_arg);
+		}
+		else if(c_arg.compare("-inst") == 0){ // instances per scene model
+			if (argc > pos+1) opt.scene_instances = atoi(string(argv[pos+1]).c_str());
+			else ParamError(c_arg);
+		}
+		else if(c_arg.compare("-scene_rad") == 0){ // radius of the scene
+			if (argc > pos+1) opt.scene_radius = atof(string(argv[pos+1]).c_str());
+			else ParamError(c_arg);
+		}
+		else if(c_arg.compare("-vis") == 0){ // visible fraction labels
+			opt.visibility_labels = true;
+		}
+		else if(c_arg.compare("-nocache") == 0 ){ // no binary mesh, texture, and shader caches
+			opt.mesh_cache = false;
+		}
 		else if(c_arg.compare("-up") == 0 ){ // upright images only
 			opt.upright = true;
 		}
@@ -173,7 +220,17 @@ void ArgParser::Help(void)
 	cout << "\t-limy [param] \t- for camera path control POSE, set the y-axis limit for the random position (float)" << endl;
 	cout << "\t-lim_near [param] \t- for camera path control POSE, set the near z-axis limit (positive along the camera axis) for the random position (float)" << endl;
 	cout << "\t-lim_far [param] \t- for camera path control POSE, set the far z-axis limit (postive along the camera axis) for the random position (float)" << endl;
+	cout << "\t-sampler [param] \t- for camera path control POSE, set the pose sampler: RANDOM or HALTON (low-discrepancy rotations and translations)" << endl;
+	cout << "\t-min_visible [param] \t- for camera path control POSE, resample poses if less than this fraction (0 to 1) of the bounding box is visible (float)" << endl;
 	cout << "\t-level [param] \t-for the camera path TREE, the number of tree levels for the Balanced Pose Tree (int)" << endl;
+	cout << "\t-adaptive [param] \t-for the camera path TREE, only subdivide nodes whose silhouette changes by more than this fraction (0 to 1) to a neighbor node; -level is the max. depth (float)" << endl;
+	cout << "\t-sym \t- for the camera path POLY and TREE, detect the rotational symmetry of the model and render only one view per set of equivalent views." << endl;
+	cout << "\t-lod [param] \t- render simplified meshes if their error, projected into the image, is below this number of pixels; 0 renders the original mesh (float)" << endl;
+	cout << "\t-scene [param] \t- scene mode: comma-separated list of models whose instances are placed at random, non-intersecting poses around the model in every image. Their poses, rois, and control points are written to render_instances.csv." << endl;
+	cout << "\t-inst [param] \t- for the scene mode, the number of instances per scene model (int)" << endl;
+	cout << "\t-scene_rad [param] \t- for the scene mode, the radius of the sphere around the origin for the instance positions; 0 uses three times the model size (float)" << endl;
+	cout << "\t-vis \t- measure the fraction (0 to 1) of the pixels of the model and of each scene instance that is visible, not occluded or outside of the image, and write it to the column 'visible' of render_log.csv and render_instances.csv." << endl;
+	cout << "\t-nocache \t- do not read or write the binary mesh, texture, and shader caches (model file + .meshcache, texture file + .texcache, ./shader_cache) that skip the obj parsing, the image decoding, and the shader compilation on the next start." << endl;
 	cout << "\t-up \t- Renders objects only in the upright position if set, where up is the positive y-direction." << endl;
 	cout << "\t-rand_col [param] - enable color randomization. Param: path and filename of a json file with color parameters." << endl;
 	cout << "\t-verbose \t- displays additional information." << endl;
@@ -195,6 +252,13 @@ void ArgParser::Display(void)
 	std::cout << "Output path:\t" << opt.output_path << endl;
 	//std::cout << "Path:\t" << opt.current_path << endl;
 	std::cout << "Camera path: " << CameraModelString(opt.cam) << endl;
+	std::cout << "Mesh cache: " << (opt.mesh_cache ? "on" : "off") << endl;
+	std::cout << "LOD max. error: " << opt.lod_max_error << " px" << endl;
+	if (opt.scene_models.size() > 0) {
+		std::cout << "Scene models: " << opt.scene_models.size() << ", " << opt.scene_instances << " instances each" << endl;
+		std::cout << "Scene radius: " << opt.scene_radius << endl;
+	}
+	std::cout << "Visibility labels: " << (opt.visibility_labels ? "on" : "off") << endl;
 	if (opt.cam == SPHERE) {
 		std::cout << "Sphere segments: " << opt.segments << endl;
 		std::cout << "Sphere rows: " << opt.rows << endl;
@@ -203,10 +267,13 @@ void ArgParser::Display(void)
 	if (opt.cam == POLY) {
 		std::cout << "Polyheder subdivisions: " << opt.subdivisions << endl;
 		std::cout << "Polyheder radius: " << opt.camera_distance << endl;
+		std::cout << "Symmetry reduction: " << (opt.symmetry ? "on" : "off") << endl;
 	}
 	if (opt.cam == TREE) {
 		std::cout << "BPT level: " << opt.bpt_levels << endl;
+		std::cout << "BPT adaptive threshold: " << opt.adaptive_threshold << endl;
 		std::cout << "Polyheder radius: " << opt.camera_distance << endl;
+		std::cout << "Symmetry reduction: " << (opt.symmetry ? "on" : "off") << endl;
 	}
 	if (opt.cam == POSE) {
 		std::cout << "Number of images to generate: " << opt.num_images << endl;
@@ -214,6 +281,8 @@ void ArgParser::Display(void)
 		std::cout << "Limit x [" << opt.lim_nx << ", " << opt.lim_px << "]." << endl;
 		std::cout << "Limit y [" << opt.lim_ny << ", " << opt.lim_py << "]." << endl;
 		std::cout << "Limit z [" << opt.lim_nz << ", " << opt.lim_pz << "]; values inverted." << endl;
+		std::cout << "Sampler: " << (opt.sampler == 1 ? "HALTON" : "RANDOM") << endl;
+		std::cout << "Min. visible fraction: " << opt.min_visible << endl;
 		
 	}
 	std::cout << "Image width:\t" << opt.image_width << endl;
@@ -5,6 +5,7 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <sstream>
 
 // local
 #include "types.h"
@@ -40,6 +41,24 @@ typedef struct _Arguments
 
 	// balance pose tree levels
 	int		bpt_levels;
+	float	adaptive_threshold; // min. silhouette change to subdivide a tree node, 0 disables the adaptive tree
+
+	// render one view per set of views that are equivalent under the model symmetry (POLY and TREE)
+	bool	symmetry;
+
+	// read and write the binary mesh, texture, and shader caches
+	bool	mesh_cache;
+
+	// max. projected error of the level of detail selection in pixels, 0 renders the original mesh
+	float	lod_max_error;
+
+	// scene mode: further models placed around the model, with a number of instances per model
+	std::vector<string>	scene_models;
+	int		scene_instances;
+	float	scene_radius; // 0 is relative to the model size
+
+	// measure the visible pixel fraction of the objects, written to the manifests
+	bool	visibility_labels;
 
 	// helpers
 	bool		verbose;
@@ -59,6 +78,8 @@ typedef struct _Arguments
 	float	lim_ny;
 	float	lim_pz;
 	float	lim_nz;
+	int		sampler; // 0: random, 1: low-discrepancy
+	float	min_visible; // min. visible fraction of the bounding box, 0 disables the test
 
 
 	// only get images from the upper hemisphere
@@ -84,6 +105,13 @@ typedef struct _Arguments
 
 		subdivisions = 0;
 		bpt_levels = 0;
+		adaptive_threshold = 0.0;
+		symmetry = false;
+		mesh_cache = true;
+		lod_max_error = 0.0;
+		scene_instances = 3;
+		scene_radius = 0.0;
+		visibility_labels = false;
 
 		num_images = 6000;
 		lim_px = 1.0;
@@ -92,6 +120,8 @@ typedef struct _Arguments
 		lim_ny = -1.0;
 		lim_pz = -1.5;
 		lim_nz = -3.0;
+		sampler = 0;
+		min_visible = 0.0;
 
 		upright = false;
 
@@ -0,0 +1,260 @@
+#include "AugmentationGraph.h"
+
+
+AugmentationGraph::AugmentationGraph()
+{
+	_threshold = 0;
+	_band_bytes = 256 * 1024;
+	_compiled = false;
+}
+
+
+AugmentationGraph::~AugmentationGraph()
+{
+
+}
+
+
+/*
+Remove all steps and images.
+*/
+void AugmentationGraph::clear(void)
+{
+	_ops.clear();
+	_background = cv::Mat();
+	_foreground = cv::Mat();
+	_bg_window = cv::Rect();
+	_compiled = false;
+}
+
+
+/*
+Set the background image. The window of the image is mapped onto the entire output image.
+*/
+void AugmentationGraph::setBackground(cv::Mat& image, cv::Rect window)
+{
+	_background = image;
+
+	cv::Rect full(0, 0, image.cols, image.rows);
+	if (window.area() == 0) {
+		_bg_window = full;
+	}
+	else {
+		_bg_window = window & full;
+	}
+	_compiled = false;
+}
+
+
+/*
+Set the foreground rendering. It is resized to the output size.
+*/
+void AugmentationGraph::setForeground(cv::Mat& image)
+{
+	_foreground = image;
+	_compiled = false;
+}
+
+
+/*
+Append a color adaptation step.
+*/
+void AugmentationGraph::addColorAdaptation(ImageFilter* filter)
+{
+	Op op(COLOR);
+	op.filter = filter;
+	_ops.push_back(op);
+	_compiled = false;
+}
+
+
+/*
+Append a noise step.
+*/
+void AugmentationGraph::addNoise(NoiseFilter* filter)
+{
+	Op op(NOISE);
+	op.noise = filter;
+	_ops.push_back(op);
+	_compiled = false;
+}
+
+
+/*
+Append the composite step.
+*/
+void AugmentationGraph::addComposite(int threshold)
+{
+	_threshold = threshold;
+	_ops.push_back(Op(COMPOSITE));
+	_compiled = false;
+}
+
+
+/*
+Set the approx. number of bytes a band should occupy.
+*/
+void AugmentationGraph::setBandBytes(int bytes)
+{
+	_band_bytes = (std::max)(1024, bytes);
+}
+
+
+/*
+Compile the graph for an output size. Runs all whole-image analysis steps.
+*/
+bool AugmentationGraph::compile(cv::Size size)
+{
+	_compiled = false;
+
+	if (_foreground.empty() || _foreground.type() != CV_8UC3) {
+		std::cout << "[ERROR] - AugmentationGraph: the foreground must be a CV_8UC3 image." << std::endl;
+		return false;
+	}
+	if (size.width <= 0 || size.height <= 0) {
+		std::cout << "[ERROR] - AugmentationGraph: invalid output size." << std::endl;
+		return false;
+	}
+
+	bool composited = false;
+
+	for (Op& op : _ops) {
+		switch (op.type) {
+		case COLOR:
+		{
+			if (op.filter == NULL) return false;
+			if (composited) {
+				std::cout << "[ERROR] - AugmentationGraph: color adaptation must be added before the composite step." << std::endl;
+				return false;
+			}
+
+			// the template is the background window. The statistics of the rendering are
+			// taken from the source rendering since the resized one does not exist yet.
+			ImageFilter::FilterMethod method = op.filter->getFilterMethod();
+			if (method == ImageFilter::CHROMATIC || method == ImageFilter::HISTOGRAM) {
+				if (_background.empty()) {
+					std::cout << "[ERROR] - AugmentationGraph: color adaptation requires a background image." << std::endl;
+					return false;
+				}
+				ImageFilter::ImageStatistics stats;
+				ImageFilter::ComputeStatistics(_background(_bg_window), stats);
+				op.filter->setChromaticTemplate(stats);
+			}
+			if (!op.filter->createLUT(_foreground, op.lut)) {
+				return false;
+			}
+			break;
+		}
+		case NOISE:
+			if (op.noise == NULL) return false;
+			op.noise->nextWindow(size, op.window);
+			break;
+		case COMPOSITE:
+			if (_background.empty() || _background.type() != CV_8UC3) {
+				std::cout << "[ERROR] - AugmentationGraph: the composite step requires a CV_8UC3 background image." << std::endl;
+				return false;
+			}
+			composited = true;
+			break;
+		}
+	}
+
+	_size = size;
+	_compiled = true;
+
+	return true;
+}
+
+
+/*
+Run the graph. compile() must be called first.
+*/
+bool AugmentationGraph::run(cv::Mat& output, cv::Mat& mask)
+{
+	if (!_compiled) {
+		std::cout << "[ERROR] - AugmentationGraph: compile the graph before running it." << std::endl;
+		return false;
+	}
+
+	output.create(_size, CV_8UC3);
+	mask.create(_size, CV_8UC1);
+
+	// approx. working set per pixel: rendering, gray, mask, output, and the noise tile
+	int band_rows = (std::max)(1, _band_bytes / (_size.width * 16));
+	int num_bands = (_size.height + band_rows - 1) / band_rows;
+
+	cv::parallel_for_(cv::Range(0, num_bands), [&](const cv::Range& range) {
+		for (int b = range.start; b < range.end; b++) {
+			int r0 = b * band_rows;
+			int r1 = (std::min)(_size.height, r0 + band_rows);
+			runBand(r0, r1, output, mask);
+		}
+	});
+
+	return true;
+}
+
+
+/*
+Process the rows [r0, r1) of the output.
+*/
+void AugmentationGraph::runBand(int r0, int r1, cv::Mat& output, cv::Mat& mask) const
+{
+	cv::Mat out = output.rowRange(r0, r1);
+	cv::Mat m = mask.rowRange(r0, r1);
+	cv::Mat no_mask;
+
+	// resized rendering band and its foreground mask
+	cv::Mat fg, gray;
+	sample(_foreground, cv::Rect(0, 0, _foreground.cols, _foreground.rows), r0, r1, fg);
+	cv::cvtColor(fg, gray, CV_RGB2GRAY);
+	cv::threshold(gray, m, _threshold, 255, CV_THRESH_BINARY);
+
+	bool composited = false;
+
+	for (const Op& op : _ops) {
+		switch (op.type) {
+		case COLOR:
+			cv::LUT(fg, op.lut, fg);
+			break;
+		case NOISE:
+			if (!composited)
+				op.noise->applyWindow(op.window, fg, m, fg, r0);
+			else
+				op.noise->applyWindow(op.window, out, no_mask, out, r0);
+			break;
+		case COMPOSITE:
+			sample(_background, _bg_window, r0, r1, out);
+			fg.copyTo(out, m);
+			composited = true;
+			break;
+		}
+	}
+
+	if (!composited) {
+		fg.copyTo(out);
+	}
+}
+
+
+/*
+Map the rows [r0, r1) of the output onto the source image and write them to dst.
+The mapping matches cv::resize with INTER_LINEAR (pixel centers aligned).
+*/
+void AugmentationGraph::sample(const cv::Mat& src, const cv::Rect& window, int r0, int r1, cv::Mat& dst) const
+{
+	if (window.width == _size.width && window.height == _size.height) {
+		src(cv::Rect(window.x, window.y + r0, window.width, r1 - r0)).copyTo(dst);
+		return;
+	}
+
+	double ax = double(window.width) / double(_size.width);
+	double ay = double(window.height) / double(_size.height);
+
+	// maps output pixels (x, y) of the band to source pixels
+	cv::Mat M = (cv::Mat_<double>(2, 3) <<
+		ax, 0.0, window.x + 0.5 * ax - 0.5,
+		0.0, ay, window.y + ay * (r0 + 0.5) - 0.5);
+
+	cv::warpAffine(src, dst, M, cv::Size(_size.width, r1 - r0), cv::INTER_LINEAR | cv::WARP_INVERSE_MAP, cv::BORDER_REPLICATE);
+}
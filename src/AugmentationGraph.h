@@ -0,0 +1,179 @@
+#pragma once
+/*
+class AugmentationGraph
+
+The class chains the augmentation steps setforge_g applies to a rendering:
+resize, color adaptation (ImageFilter), noise (NoiseFilter), and compositing
+with a background image. Instead of running each step over the entire image,
+the configured chain is compiled and executed band by band. Each band of rows is
+small enough to stay in the cache, and all steps run on a band before the next one starts.
+
+The graph works in two phases:
+compile() - runs all whole-image analysis up front: the color statistics, the lookup table,
+			and the noise window.
+run() -		processes all bands in parallel and writes the output image and the foreground mask.
+
+The foreground mask is computed from the resized rendering before any other step.
+It assumes that the background of the rendering is black, RGB = (0,0,0).
+Steps added after the composite step work on the entire image (e.g., sensor noise) and ignore the mask.
+Color adaptation must be added before the composite step.
+
+Usage:
+AugmentationGraph graph;
+graph.setBackground(background);
+graph.setForeground(rendering);
+graph.addColorAdaptation(&image_filter);
+graph.addNoise(&noise_filter);
+graph.addComposite();
+graph.compile(cv::Size(512, 512));
+graph.run(output, mask);
+
+Rafael Radkowski
+Iowa State University
+rafael@iastate.edu
+Oct 2026
+MIT license
+*/
+
+// stl
+#include <iostream>
+#include <vector>
+#include <string>
+
+// opencv
+#include <opencv2/opencv.hpp>
+
+// local
+#include "ImageFilter.h"
+#include "NoiseFilter.h"
+
+
+class AugmentationGraph
+{
+public:
+
+	typedef enum {
+		COLOR,		// color adaptation via an ImageFilter lookup table
+		NOISE,		// noise via a NoiseFilter window
+		COMPOSITE	// combine the foreground with the background using the foreground mask
+	}OpType;
+
+
+	AugmentationGraph();
+	~AugmentationGraph();
+
+
+	/*
+	Remove all steps and images.
+	*/
+	void clear(void);
+
+
+	/*
+	Set the background image. The window of the image is mapped onto the entire output image.
+	The image must stay valid until run() returns.
+	@param image - the background image of type CV_8UC3.
+	@param window - the region of the image to use. An empty rect uses the entire image.
+	*/
+	void setBackground(cv::Mat& image, cv::Rect window = cv::Rect());
+
+
+	/*
+	Set the foreground rendering. It is resized to the output size.
+	The image must stay valid until run() returns.
+	@param image - the rendering of type CV_8UC3 with a black background.
+	*/
+	void setForeground(cv::Mat& image);
+
+
+	/*
+	Append a color adaptation step. The filter adapts the rendering to the background window,
+	using its current method (CHROMATIC, HISTOGRAM, ...).
+	@param filter - pointer to the filter. It must stay valid until run() returns.
+	*/
+	void addColorAdaptation(ImageFilter* filter);
+
+
+	/*
+	Append a noise step.
+	@param filter - pointer to the noise filter. It must stay valid until run() returns.
+	*/
+	void addNoise(NoiseFilter* filter);
+
+
+	/*
+	Append the composite step.
+	@param threshold - the threshold to segment the rendered background from its foreground.
+	*/
+	void addComposite(int threshold = 0);
+
+
+	/*
+	Set the approx. number of bytes a band should occupy. The default is 256 KB.
+	@param bytes - the working set size of one band.
+	*/
+	void setBandBytes(int bytes);
+
+
+	/*
+	Compile the graph for an output size. Runs all whole-image analysis steps.
+	@param size - the output image size in pixels.
+	@return true, if the graph is valid.
+	*/
+	bool compile(cv::Size size);
+
+
+	/*
+	Run the graph. compile() must be called first.
+	@param output - the output image of type CV_8UC3.
+	@param mask - the foreground mask of type CV_8UC1.
+	@return true, if successful.
+	*/
+	bool run(cv::Mat& output, cv::Mat& mask);
+
+
+private:
+
+	typedef struct _Op {
+		OpType			type;
+		ImageFilter*	filter;
+		NoiseFilter*	noise;
+
+		// compiled state
+		cv::Mat				lut;	// COLOR: 1 x 256 lookup table
+		NoiseFilter::Window	window; // NOISE: the noise window for this image
+
+		_Op(OpType t)
+		{
+			type = t;
+			filter = NULL;
+			noise = NULL;
+		}
+	}Op;
+
+
+	/*
+	Map the rows [r0, r1) of the output onto the source image and write them to dst.
+	A direct copy is used if no scaling is necessary.
+	*/
+	void sample(const cv::Mat& src, const cv::Rect& window, int r0, int r1, cv::Mat& dst) const;
+
+	/*
+	Process the rows [r0, r1) of the output.
+	*/
+	void runBand(int r0, int r1, cv::Mat& output, cv::Mat& mask) const;
+
+
+	std::vector<Op>		_ops;
+
+	cv::Mat				_background;
+	cv::Rect			_bg_window;
+	cv::Mat				_foreground;
+
+	int					_threshold;
+	int					_band_bytes;
+
+	// compiled state
+	cv::Size			_size;
+	bool				_compiled;
+};
@@ -0,0 +1,266 @@
+#include "BPTFlatTree.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+BPTFlatTree::BPTFlatTree()
+{
+	_data = NULL;
+	_size = 0;
+	_file_handle = NULL;
+	_map_handle = NULL;
+
+	_num_nodes = 0;
+	_num_links = 0;
+	_num_levels = 0;
+
+	_node_id = NULL;
+	_level = NULL;
+	_parent = NULL;
+	_image_index = NULL;
+	_point_id = NULL;
+	_direction = NULL;
+	_child_offsets = NULL;
+	_child_ids = NULL;
+	_level_offsets = NULL;
+}
+
+
+BPTFlatTree::~BPTFlatTree()
+{
+	close();
+}
+
+
+/*
+Map a binary tree file into memory.
+@param path_and_file - string with the relative or absolute file.
+@return - true, if the file is a valid tree file.
+*/
+bool BPTFlatTree::open(string path_and_file)
+{
+	close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path_and_file.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) {
+		cout << "[ERROR] - BPTFlatTree: could not open file " << path_and_file << endl;
+		return false;
+	}
+	LARGE_INTEGER file_size;
+	GetFileSizeEx(file, &file_size);
+
+	HANDLE map = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (map == NULL) {
+		cout << "[ERROR] - BPTFlatTree: could not map file " << path_and_file << endl;
+		CloseHandle(file);
+		return false;
+	}
+	_data = (const char*)MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+	_file_handle = file;
+	_map_handle = map;
+	_size = (size_t)file_size.QuadPart;
+#else
+	int fd = ::open(path_and_file.c_str(), O_RDONLY);
+	if (fd < 0) {
+		cout << "[ERROR] - BPTFlatTree: could not open file " << path_and_file << endl;
+		return false;
+	}
+	struct stat st;
+	fstat(fd, &st);
+	_size = (size_t)st.st_size;
+
+	void* ptr = _size > 0 ? mmap(NULL, _size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+	::close(fd); // the mapping stays valid
+	_data = ptr == MAP_FAILED ? NULL : (const char*)ptr;
+#endif
+
+	if (_data == NULL) {
+		cout << "[ERROR] - BPTFlatTree: could not map file " << path_and_file << endl;
+		close();
+		return false;
+	}
+
+	if (!mapArrays(_size)) {
+		cout << "[ERROR] - BPTFlatTree: " << path_and_file << " is not a valid tree file." << endl;
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+
+/*
+Unmap the file.
+*/
+void BPTFlatTree::close(void)
+{
+#ifdef _WIN32
+	if (_data != NULL) UnmapViewOfFile(_data);
+	if (_map_handle != NULL) CloseHandle((HANDLE)_map_handle);
+	if (_file_handle != NULL) CloseHandle((HANDLE)_file_handle);
+#else
+	if (_data != NULL) munmap((void*)_data, _size);
+#endif
+
+	_data = NULL;
+	_size = 0;
+	_file_handle = NULL;
+	_map_handle = NULL;
+
+	_num_nodes = 0;
+	_num_links = 0;
+	_num_levels = 0;
+}
+
+
+/*
+Set the array pointers and validate the content.
+Only the header and the sizes are checked, the arrays are not read.
+*/
+bool BPTFlatTree::mapArrays(size_t size)
+{
+	if (size < sizeof(BPTFileHeader)) return false;
+
+	const BPTFileHeader* header = (const BPTFileHeader*)_data;
+	if (header->magic[0] != 'B' || header->magic[1] != 'P' || header->magic[2] != 'T' || header->magic[3] != 'B') return false;
+	if (header->version != 1) return false;
+	if (header->num_nodes < 1 || header->num_links < 0 || header->num_levels < 1) return false;
+
+	size_t N = header->num_nodes;
+	size_t M = header->num_links;
+	size_t L = header->num_levels;
+
+	size_t expected = sizeof(BPTFileHeader) + 4 * (5 * N + 3 * N + (N + 1) + M + (L + 1));
+	if (size != expected) return false;
+
+	_num_nodes = header->num_nodes;
+	_num_links = header->num_links;
+	_num_levels = header->num_levels;
+
+	const int32_t* p = (const int32_t*)(_data + sizeof(BPTFileHeader));
+	_node_id = p;		p += N;
+	_level = p;			p += N;
+	_parent = p;		p += N;
+	_image_index = p;	p += N;
+	_point_id = p;		p += N;
+	_direction = (const float*)p;	p += 3 * N;
+	_child_offsets = p;	p += N + 1;
+	_child_ids = p;		p += M;
+	_level_offsets = p;
+
+	return _child_offsets[N] == _num_links && _level_offsets[L] == _num_nodes;
+}
+
+
+/*
+Find the node closest to a view direction. 
+At each level, only the children of the current node are compared.
+*/
+BPTDescriptor BPTFlatTree::lookup(const glm::vec3& view_direction) const
+{
+	BPTDescriptor result;
+	if (_data == NULL) return result;
+
+	float len = glm::length(view_direction);
+	if (len <= 0.0f) return result;
+	glm::vec3 d = view_direction / len;
+
+	int node = root();
+	int best = -1;
+	float best_cos = -2.0f;
+
+	while (true) {
+		int count = 0;
+		const int* c = children(node, count);
+		if (count == 0) break;
+
+		// the child with the largest cosine is the closest on the unit sphere.
+		int next = c[0];
+		float next_cos = glm::dot(d, direction(c[0]));
+		for (int i = 1; i < count; i++) {
+			float cos_i = glm::dot(d, direction(c[i]));
+			if (cos_i > next_cos) {
+				next_cos = cos_i;
+				next = c[i];
+			}
+		}
+
+		if (next_cos >= best_cos) {
+			best_cos = next_cos;
+			best = next;
+		}
+		node = next;
+	}
+
+	if (best < 0) return result;
+
+	result.node = best;
+	result.node_id = _node_id[best];
+	result.level = _level[best];
+	result.image_index = _image_index[best];
+	result.weight = best_cos;
+
+	return result;
+}
+
+
+/*
+Find the node closest to a camera rotation. 
+*/
+BPTDescriptor BPTFlatTree::lookup(const glm::quat& rotation) const
+{
+	return lookup(ViewDirection(rotation));
+}
+
+
+/*
+Find the nodes closest to many view directions, in parallel. 
+*/
+void BPTFlatTree::lookupBatch(const std::vector<glm::vec3>& directions, std::vector<BPTDescriptor>& results) const
+{
+	results.resize(directions.size());
+	if (directions.size() == 0) return;
+
+	cv::parallel_for_(cv::Range(0, (int)directions.size()), [&](const cv::Range& range) {
+		for (int i = range.start; i < range.end; i++) {
+			results[i] = lookup(directions[i]);
+		}
+	});
+}
+
+
+/*
+Find the nodes closest to many camera rotations, in parallel. 
+*/
+void BPTFlatTree::lookupBatch(const std::vector<glm::quat>& rotations, std::vector<BPTDescriptor>& results) const
+{
+	results.resize(rotations.size());
+	if (rotations.size() == 0) return;
+
+	cv::parallel_for_(cv::Range(0, (int)rotations.size()), [&](const cv::Range& range) {
+		for (int i = range.start; i < range.end; i++) {
+			results[i] = lookup(ViewDirection(rotations[i]));
+		}
+	});
+}
+
+
+/*
+Return the view direction of a camera rotation.
+The camera looks along its -z axis at the object. In object coordinates, 
+the camera is at R^T * (0, 0, 1) * distance, see BalancedPoseTree::draw_sequence().
+*/
+//static 
+glm::vec3 BPTFlatTree::ViewDirection(const glm::quat& rotation)
+{
+	return glm::normalize(glm::inverse(rotation) * glm::vec3(0.0f, 0.0f, 1.0f));
+}
@@ -0,0 +1,193 @@
+/*
+class BPTFlatTree
+
+Read-only balanced pose tree in the binary format (*.bpt), see BPTFileHeader.
+The file is memory-mapped; opening it only validates the header and sets the array pointers,
+independent of the tree size. All data stays in flat arrays (structure-of-arrays),
+nodes are addressed by their array position, and the children of a node are a
+compressed row (CSR) of the child index.
+
+Use BPTReaderWriter::writeBinary() to create the file.
+
+lookup() returns the rendered node closest to a view direction or a camera rotation.
+It descends the tree from the root and follows the child with the closest direction,
+which takes O(levels) steps. lookupBatch() runs many lookups in parallel.
+
+Usage:
+BPTFlatTree tree;
+tree.open("./tree/BPTData.bpt");
+int count = 0;
+const int* c = tree.children(tree.root(), count);
+for (int i = 0; i < count; i++) {
+	glm::vec3 dir = tree.direction(c[i]);
+}
+
+Rafael Radkowski
+Iowa State University
+rafael@iastate.edu
+Oct 2026
+MIT license
+----------------------------------------------------
+last edited:
+
+Oct 19, 2026, RR:
+- Added the orientation lookup, lookup() and lookupBatch().
+*/
+#pragma once
+
+// stl
+#include <iostream>
+#include <string>
+#include <cstdint>
+#include <vector>
+
+// GLM include files
+#define GLM_FORCE_INLINE
+#include <glm/glm.hpp>
+#include <glm/gtx/quaternion.hpp> // quaternions
+
+// opencv
+#include <opencv2/opencv.hpp>
+
+// local
+#include "BPTTypes.h"
+
+using namespace std;
+
+class BPTFlatTree
+{
+public:
+
+	BPTFlatTree();
+	~BPTFlatTree();
+
+
+	/*
+	Map a binary tree file into memory.
+	@param path_and_file - string with the relative or absolute file.
+	@return - true, if the file is a valid tree file.
+	*/
+	bool open(string path_and_file);
+
+
+	/*
+	Unmap the file.
+	*/
+	void close(void);
+
+
+	/*
+	Return true if a tree is loaded.
+	*/
+	bool isOpen(void) const { return _data != NULL; }
+
+
+	/*
+	Return the number of nodes, links, and levels. The levels include the root level.
+	*/
+	int numNodes(void) const { return _num_nodes; }
+	int numLinks(void) const { return _num_links; }
+	int numLevels(void) const { return _num_levels; }
+
+
+	/*
+	Return the array position of the root node.
+	*/
+	int root(void) const { return 0; }
+
+
+	/*
+	Node data. i is the array position of the node, 0 to numNodes() - 1.
+	*/
+	int nodeId(int i) const { return _node_id[i]; }
+	int level(int i) const { return _level[i]; }
+	int parent(int i) const { return _parent[i]; } // array position, -1 for the root node
+	int imageIndex(int i) const { return _image_index[i]; }
+	int pointId(int i) const { return _point_id[i]; }
+	glm::vec3 direction(int i) const { return glm::vec3(_direction[3 * i], _direction[3 * i + 1], _direction[3 * i + 2]); }
+
+
+	/*
+	Return the children of a node.
+	@param i - the array position of the node.
+	@param count - returns the number of children.
+	@return - pointer to the array positions of the children.
+	*/
+	const int* children(int i, int& count) const
+	{
+		count = _child_offsets[i + 1] - _child_offsets[i];
+		return _child_ids + _child_offsets[i];
+	}
+
+
+	/*
+	Return the range of array positions of all nodes of a level, [levelBegin(l), levelEnd(l) ).
+	@param level - the level, -1 for the root level.
+	*/
+	int levelBegin(int level) const { return _level_offsets[level + 1]; }
+	int levelEnd(int level) const { return _level_offsets[level + 2]; }
+
+
+	/*
+	Find the node closest to a view direction. The function descends the tree coarse-to-fine 
+	and returns the closest node on the path, usually a leaf. The root node is never returned.
+	@param view_direction - the direction from the object to the camera. It does not need to be normalized.
+	@return - the node, its image index, and the cosine between the direction and the node direction. 
+	*/
+	BPTDescriptor lookup(const glm::vec3& view_direction) const;
+
+
+	/*
+	Find the node closest to a camera rotation. 
+	@param rotation - the rotation of the view matrix, from object to camera coordinates.
+	@return - the node, its image index, and the cosine between the view direction and the node direction. 
+	*/
+	BPTDescriptor lookup(const glm::quat& rotation) const;
+
+
+	/*
+	Find the nodes closest to many view directions or camera rotations, in parallel. 
+	@param directions / rotations - the queries.
+	@param results - location for the results, one per query.
+	*/
+	void lookupBatch(const std::vector<glm::vec3>& directions, std::vector<BPTDescriptor>& results) const;
+	void lookupBatch(const std::vector<glm::quat>& rotations, std::vector<BPTDescriptor>& results) const;
+
+
+	/*
+	Return the view direction of a camera rotation.
+	@param rotation - the rotation of the view matrix, from object to camera coordinates.
+	@return - the direction from the object to the camera, normalized.
+	*/
+	static glm::vec3 ViewDirection(const glm::quat& rotation);
+
+
+private:
+
+	/*
+	Set the array pointers and validate the content.
+	*/
+	bool mapArrays(size_t size);
+
+
+	// the mapped file
+	const char*		_data;
+	size_t			_size;
+	void*			_file_handle;
+	void*			_map_handle;
+
+	int				_num_nodes;
+	int				_num_links;
+	int				_num_levels;
+
+	// the arrays in the mapped file
+	const int32_t*	_node_id;
+	const int32_t*	_level;
+	const int32_t*	_parent;
+	const int32_t*	_image_index;
+	const int32_t*	_point_id;
+	const float*	_direction;
+	const int32_t*	_child_offsets;
+	const int32_t*	_child_ids;
+	const int32_t*	_level_offsets;
+};
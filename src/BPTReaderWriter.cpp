@@ -39,9 +39,18 @@ bool BPTReaderWriter::write(string path_and_file, BPTNode* root)
 
 	writeHeader(path_and_file, root);
 
+	std::ofstream of(path_and_file, std::ofstream::out | std::ofstream::app);
+
+	if(!of.is_open()){
+		cout << "[ERROR] - BPTReaderWriter: could not open file " << path_and_file << endl;
+		return false;
+	}
+
 	int counter = 0;
 	// the function writes all nodes recursively into a file. 
-	writeNode(path_and_file, root, counter);
+	writeNode(of, root, counter);
+
+	of.close();
 
 	cout << "[INFO] - wrote " << counter << " nodes into " << path_and_file << endl;
 
@@ -86,17 +95,10 @@ bool BPTReaderWriter::writeHeader(string path_and_file, BPTNode* root)
 /*
 Write the nodes into a file
 */
-bool BPTReaderWriter::writeNode(string path_and_file, BPTNode* node, int& counter)
+bool BPTReaderWriter::writeNode(std::ofstream& of, BPTNode* node, int& counter)
 {
 	if (node == NULL) return false;
 
-	std::ofstream of(path_and_file, std::ofstream::out | std::ofstream::app);
-
-	if(!of.is_open()){
-		cout << "[ERROR] - BPTReaderWriter: could not open file " << path_and_file << endl;
-		return false;
-	}
-
 	of << "NODE\t" << node->node_id << "\t" << node->level << "\t" << node->childs.size() << "\t" << node->image_index << "\t"  <<"\n";
 
 	counter++;
@@ -105,13 +107,131 @@ bool BPTReaderWriter::writeNode(string path_and_file, BPTNode* node, int& counte
 		of << "LINK\t" << node->node_id << "\t" << c->node_id << "\n";
 	}
 
-	of.close();
-
 	// depth first 
 	for (auto c : node->childs) {
-		writeNode(path_and_file, c, counter);
+		writeNode(of, c, counter);
+	}
+
+	return true;
+}
+
+
+/*
+Write the BPT to a binary file, see BPTFileHeader and BPTFlatTree. 
+@param path_and_file - string with the relative or absolute file. 
+@param root - the root node of the tree. 
+@return - true if file was successfully generated. 
+*/
+bool BPTReaderWriter::writeBinary(string path_and_file, BPTNode* root)
+{
+	if (root == NULL) {
+		cout << "[ERROR] - BPTReaderWriter: no root set." << endl;
+		return false;
+	}
+
+	if (path_and_file.length() == 0) {
+		cout << "[ERROR] - BPTReaderWriter: no path and file set." << endl;
+		return false;
+	}
+
+	int index = path_and_file.find_last_of("/");
+	if (index != -1)
+	{
+		string path = path_and_file.substr(0, index);
+		if(!FileUtils::Exists(path)){
+			FileUtils::CreateDirectories(path);
+		}
+	}
+
+	// breadth-first order. The nodes of one level and the children of one node are contiguous.
+	vector<BPTNode*> nodes;
+	std::unordered_map<BPTNode*, int> position;
+	nodes.push_back(root);
+	position[root] = 0;
+	for (size_t i = 0; i < nodes.size(); i++) {
+		for (auto c : nodes[i]->childs) {
+			if (position.count(c) > 0) continue;
+			position[c] = (int)nodes.size();
+			nodes.push_back(c);
+		}
+	}
+
+	int N = (int)nodes.size();
+	vector<int32_t> node_id(N), level(N), parent(N), image_index(N), point_id(N);
+	vector<float> direction(3 * N);
+	vector<int32_t> child_offsets(N + 1, 0), child_ids;
+	vector<int32_t> level_offsets;
+
+	int max_level = -1;
+	for (int i = 0; i < N; i++) {
+		BPTNode* n = nodes[i];
+		if (i > 0 && n->level < nodes[i - 1]->level) {
+			cout << "[ERROR] - BPTReaderWriter: the node levels are not in breadth-first order." << endl;
+			return false;
+		}
+		max_level = (std::max)(max_level, n->level);
+
+		node_id[i] = n->node_id;
+		level[i] = n->level;
+		parent[i] = -1;
+		image_index[i] = n->image_index;
+		point_id[i] = n->point_id;
+
+		glm::vec3 d = glm::length(n->point) > 0.0f ? glm::normalize(n->point) : glm::vec3(0.0f);
+		direction[3 * i] = d.x;
+		direction[3 * i + 1] = d.y;
+		direction[3 * i + 2] = d.z;
+
+		for (auto c : n->childs) {
+			child_ids.push_back(position[c]);
+		}
+		child_offsets[i + 1] = (int32_t)child_ids.size();
+	}
+	for (int i = 0; i < N; i++) {
+		for (int c = child_offsets[i]; c < child_offsets[i + 1]; c++) {
+			parent[child_ids[c]] = i;
+		}
+	}
+
+	// level -1 is the root level
+	int L = max_level - level[0] + 1;
+	level_offsets.assign(L + 1, N);
+	for (int i = N - 1; i >= 0; i--) {
+		level_offsets[level[i] - level[0]] = i;
+	}
+	for (int l = L - 1; l >= 0; l--) { // levels without nodes
+		level_offsets[l] = (std::min)(level_offsets[l], level_offsets[l + 1]);
+	}
+
+	BPTFileHeader header;
+	header.magic[0] = 'B'; header.magic[1] = 'P'; header.magic[2] = 'T'; header.magic[3] = 'B';
+	header.version = 1;
+	header.num_nodes = N;
+	header.num_links = (int32_t)child_ids.size();
+	header.num_levels = L;
+	header.reserved = 0;
+
+	std::ofstream of(path_and_file, std::ofstream::out | std::ofstream::binary);
+
+	if(!of.is_open()){
+		cout << "[ERROR] - BPTReaderWriter: could not open file " << path_and_file << endl;
+		return false;
 	}
 
+	of.write((const char*)&header, sizeof(BPTFileHeader));
+	of.write((const char*)node_id.data(), N * sizeof(int32_t));
+	of.write((const char*)level.data(), N * sizeof(int32_t));
+	of.write((const char*)parent.data(), N * sizeof(int32_t));
+	of.write((const char*)image_index.data(), N * sizeof(int32_t));
+	of.write((const char*)point_id.data(), N * sizeof(int32_t));
+	of.write((const char*)direction.data(), 3 * N * sizeof(float));
+	of.write((const char*)child_offsets.data(), (N + 1) * sizeof(int32_t));
+	of.write((const char*)child_ids.data(), child_ids.size() * sizeof(int32_t));
+	of.write((const char*)level_offsets.data(), (L + 1) * sizeof(int32_t));
+	of.close();
+
+	cout << "[INFO] - wrote " << N << " nodes into " << path_and_file << endl;
+
 	return true;
 }
 
@@ -7,6 +7,8 @@
 #include <vector>
 #include <list>
 #include <numeric>
+#include <fstream>
+#include <unordered_map>
 
 // opencv
 #include <opencv2/opencv.hpp>
@@ -71,6 +73,16 @@ public:
 	bool write(string path_and_file, BPTNode* root);
 
 
+	/*
+	Write the BPT to a binary file, see BPTFileHeader and BPTFlatTree. 
+	The nodes are stored in breadth-first order. 
+	@param path_and_file - string with the relative or absolute file. 
+	@param root - the root node of the tree. 
+	@return - true if file was successfully generated. 
+	*/
+	bool writeBinary(string path_and_file, BPTNode* root);
+
+
 	/*
 	Read and create the nodes for the Balanced Pose Tree
 	@param path_and_file - string with the relative or absolute file. 
@@ -91,7 +103,7 @@ private:
 	/*
 	Write the nodes into a file
 	*/
-	bool writeNode(string path_and_file, BPTNode* node, int& counter);
+	bool writeNode(std::ofstream& of, BPTNode* node, int& counter);
 
 	/*
 	Create a tree using the loaded data. 
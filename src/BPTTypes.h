@@ -11,6 +11,9 @@ MIT license
 ----------------------------------------------------
 last edited:
 
+Oct 19, 2026, RR:
+- Added BPTFileHeader, the header of the binary tree file, see BPTFlatTree.
+- BPTDescriptor is the result of an orientation lookup.
 */
 #pragma once
 
@@ -21,6 +24,7 @@ last edited:
 #include <list>
 #include <numeric>
 #include <bitset> 
+#include <cstdint>
 
 // opencv
 #include <opencv2/opencv.hpp>
@@ -68,9 +72,47 @@ typedef std::vector<glm::vec3> PolyhedronPoints;
 
 
 
+/*
+Result of an orientation lookup in the balanced pose tree, see BPTFlatTree::lookup().
+*/
 typedef struct _BPTDescriptor
 {
-	std::bitset<8>	orient;
-	float			weight;
+	int				node;			// array position of the node in the tree, -1 if invalid
+	int				node_id;
+	int				level;
+	int				image_index;	// index of the rendered image
+	float			weight;			// cosine between the query direction and the node direction
+
+	_BPTDescriptor()
+	{
+		node = -1;
+		node_id = -1;
+		level = -1;
+		image_index = -1;
+		weight = -1.0f;
+	}
 
-}BPTDescriptor;
\ No newline at end of file
+}BPTDescriptor;
+
+
+
+/*
+Header of the binary balanced pose tree file (*.bpt). 
+The header is followed by flat arrays, all 4 bytes per element, in this order:
+node_id[N], level[N], parent[N], image_index[N], point_id[N], direction[3N],
+child_offsets[N+1], child_ids[M], level_offsets[L+1]
+with N = num_nodes, M = num_links, and L = num_levels. 
+Nodes are stored in breadth-first order. parent and child_ids are array positions, not node ids. 
+The children of node i are child_ids[child_offsets[i]] to child_ids[child_offsets[i+1] - 1].
+The nodes of level l are level_offsets[l+1] to level_offsets[l+2] - 1; the root has level -1.
+*/
+typedef struct _BPTFileHeader
+{
+	char		magic[4];	// "BPTB"
+	int32_t		version;	
+	int32_t		num_nodes;
+	int32_t		num_links;
+	int32_t		num_levels; // number of levels, including the root level
+	int32_t		reserved;
+
+}BPTFileHeader;
@@ -21,6 +21,10 @@ BalancedPoseTree::BalancedPoseTree(int window_width, int window_height, int imag
 	_tree_output_path = "tree";
 
 	_subdivisions = 0;
+	_num_images = 0;
+
+	_adaptive = false;
+	_adaptive_threshold = 0.05f;
 }
 
 BalancedPoseTree::~BalancedPoseTree()
@@ -41,17 +45,65 @@ void BalancedPoseTree::create(float camera_distance, int tree_depth)
 
 	_tree_nodes.clear();
 	_tree_points.clear();
-
-	// create the polyhedron nodes
+	_tree_index.clear();
+	_tree_adjacency.clear();
+	_tree_representative.clear();
+	_tree_image.clear();
+	_num_images = 0;
+	_adaptive_leaves.clear();
+	_image_silhouette.clear();
+
+	// create the polyhedron nodes. 
+	// Each level extends the previous one; the points of level i are the first numVertices(i) vertices.
+	arlab::PolyhedronGeometry geometry;
+	geometry.subdivideTo(_subdivisions);
+
+	const vector<glm::vec3>& vertices = geometry.getVertices();
 	for (int i = 0; i < _subdivisions + 1; i++)
 	{
-		// < points, vertices>
-		std::pair< vector<glm::vec3>, vector<glm::ivec3> > poly;
-		poly = arlab::PolyhedronGeometry::Create(i);
+		_tree_points.push_back(PolyhedronPoints(vertices.begin(), vertices.begin() + geometry.numVertices(i)));
+	}
 
-		_tree_points.push_back(poly.first);
+	// the mesh neighbors per level, from the polyhedron edges
+	_tree_adjacency.resize(_tree_points.size());
+	for (int i = 0; i < _tree_points.size(); i++)
+	{
+		vector<vector<int> >& adjacency = _tree_adjacency[i];
+		adjacency.resize(_tree_points[i].size());
+		for (const glm::ivec3& t : geometry.getTriangles(i)) {
+			for (int j = 0; j < 3; j++) {
+				adjacency[t[j]].push_back(t[(j + 1) % 3]);
+				adjacency[t[(j + 1) % 3]].push_back(t[j]);
+			}
+		}
+		for (auto& a : adjacency) {
+			std::sort(a.begin(), a.end());
+			a.erase(std::unique(a.begin(), a.end()), a.end());
+		}
+	}
 
+	// create the nearest neighbor index for each level
+	auto t_index = std::chrono::high_resolution_clock::now();
+	_tree_index.resize(_tree_points.size());
+	for (int i = 0; i < _tree_points.size(); i++) {
+		_tree_index[i].build(_tree_points[i]);
 	}
+	double index_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t_index).count();
+
+	// equivalent views per level. Nodes of equivalent points get the same image, see draw_sequence(). 
+	if (_with_symmetry) {
+		_tree_representative.resize(_tree_points.size());
+		_tree_image.resize(_tree_points.size());
+		for (int i = 0; i < _tree_points.size(); i++) {
+			int N = ModelSymmetry::Reduce(_symmetry, _tree_points[i], _tree_representative[i]);
+			_tree_image[i] = vector<int>(_tree_points[i].size(), -1);
+			cout << "[INFO] - Symmetry " << ModelSymmetry::ToString(_symmetry) << ": level " << i << " has " << N << " of " << _tree_points[i].size() << " distinct views." << endl;
+		}
+	}
+
+	// build time and number of nodes per level, for the benchmark
+	vector<double> level_ms(_tree_points.size() + 1, 0.0);
+	vector<int> level_nodes(_tree_points.size() + 1, 0);
 
 	// create the tree root node
 	_root = new BPTNode(_curr_node_id, -1, -1, glm::vec3(0,0,0), -1);
@@ -63,45 +115,42 @@ void BalancedPoseTree::create(float camera_distance, int tree_depth)
 	while (_process_queue.size() > 0) // all the nodes in the processing queue need children
 	{
 		BPTNode* node = _process_queue.front();
+		_process_queue.pop_front();
 
 		int next_level = node->level + 1;
 		if (next_level >= _tree_points.size()) {
-			_process_queue.pop_front();
 			continue; // end of levels
 		}
 
-		// points for the node's next level
-		// create nodes for the first level
-		PolyhedronPoints points = _tree_points[node->level+1];
+		// adaptive mode: the rendered images decide which nodes of level 0 and higher get children.
+		if (_adaptive && node->level >= 0) {
+			_adaptive_leaves.push_back(node);
+			continue;
+		}
 
-		// get nearest neighbors
-		vector<int> nn_idx =  find_nearest_neighbors(*node);
+		auto t_node = std::chrono::high_resolution_clock::now();
 
 		// select 6 and create new nodes
-
 		int max = 6;
 		if (next_level == 0) {
-			max = points.size(); // the root node is an empty node but it gets all 12 vertices of the icosahedron as childs.
+			max = _tree_points[next_level].size(); // the root node is an empty node but it gets all 12 vertices of the icosahedron as childs.
 		}
-	
-		for (int i = 0; i < max; i++)
-		{
-			glm::vec3 new_point = points[nn_idx[i]];
+		max = create_children(node, max, _process_queue);
 
-			BPTNode* new_node = new BPTNode(_curr_node_id, next_level, node->node_id, new_point, nn_idx[i]);
-			_curr_node_id++;
-
-			node->childs.push_back(new_node);
-			_tree_nodes.push_back(new_node);
-			_process_queue.push_back(new_node);
-		}
-		_process_queue.pop_front();
+		level_ms[next_level] += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t_node).count();
+		level_nodes[next_level] += max;
 	}
 
 	_N = _tree_nodes.size();
 
 	cout << "Created N=" << _N << "nodes " << endl;
 
+	// benchmark
+	cout << "[INFO] - Nearest neighbor index for " << _tree_points.size() << " levels built in " << index_ms << " ms." << endl;
+	for (int i = 0; i < _tree_points.size(); i++) {
+		cout << "[INFO] - Tree level " << i << ": " << level_nodes[i] << " nodes from " << _tree_points[i].size() << " points in " << level_ms[i] << " ms." << endl;
+	}
+
 	
 }
 
@@ -118,6 +167,21 @@ void BalancedPoseTree::setOutputPath(string path, string filename)
 	_tree_output_path = path;
 }
 
+/*
+Enable or disable the adaptive subdivision. Call it before create(). 
+@param enable - true enables the adaptive mode.
+@param threshold - the min. silhouette change 1 - IoU, from 0 to 1, to subdivide a node. 
+*/
+void BalancedPoseTree::setAdaptive(bool enable, float threshold)
+{
+	_adaptive = enable;
+	if (threshold >= 0.0f && threshold <= 1.0f)
+		_adaptive_threshold = threshold;
+	else
+		cout << "[ERROR] - The adaptive threshold must be in the range 0 to 1." << endl;
+}
+
+
 /*
 Draw the image sequence and save all images to a file
 @return - false, if images still need to be rendered. 
@@ -132,22 +196,34 @@ bool BalancedPoseTree::draw_sequence(void)
 			return false;
 		}// root node;
 
-		glm::vec3 p = _tree_nodes[_N_current]->point;
-		glm::vec3 n = _tree_nodes[_N_current]->point;
+		BPTNode* node = _tree_nodes[_N_current];
+
+		// Reuse the image of an equivalent view if one was rendered. 
+		if (_tree_image.size() > 0) {
+			int rep = _tree_representative[node->level][node->point_id];
+			if (_tree_image[node->level][rep] >= 0) {
+				node->image_index = _tree_image[node->level][rep];
+				if(_verbose)
+					cout << "[INFO] - Node " << node->node_id << " (level: " << node->level << ") uses image " << node->image_index << " of an equivalent view." << endl;
+				_N_current++;
+				if (_N_current == _N && !subdivide_adaptive()) _writing_file = true;
+				return false;
+			}
+			_tree_image[node->level][rep] = _num_images;
+		}
+
+		glm::vec3 p = node->point;
+		glm::vec3 n = node->point;
 		glm::vec3 eye = n * glm::vec3(_camera_distance);
 
 		// store the image index
-		// _N_current - 1; -> the root node does not get an image. 
-		_tree_nodes[_N_current]->image_index = _N_current - 1;
+		// the root node does not get an image. 
+		node->image_index = _num_images;
+		_num_images++;
 
 		// This prevents that the view matrix becomes NaN when eye and up vector align. 
-		float ang = glm::dot(glm::normalize(eye), _up);
-		float s = 1.0;
-		if (ang < 0) s = -1.0;
-		if (abs(ang) > 0.999)
-			_up = glm::vec3(0.0, 0.0, -s);
-		else
-			_up = glm::vec3(0.0, 1.0, 0.0);
+		// The symmetry reduction compares views with the same up-vector.
+		_up = ModelSymmetry::CameraUp(eye);
 
 
 		glm::mat4 vm = glm::lookAt(eye, _center, _up );
@@ -155,11 +231,15 @@ bool BalancedPoseTree::draw_sequence(void)
 
 		enable_writer(true);
 		if(_verbose)
-			cout << "[INFO] - Render image " << _N_current-1 << " for node " << _tree_nodes[_N_current]->node_id << " (level: " << _tree_nodes[_N_current]->level  << ") from pos: " << eye[0] << " : " << eye[1] << " : " << eye[2]<< endl;
+			cout << "[INFO] - Render image " << node->image_index << " for node " << node->node_id << " (level: " << node->level  << ") from pos: " << eye[0] << " : " << eye[1] << " : " << eye[2]<< endl;
 		draw_and_save();
 		_N_current++;
+
+		if (_adaptive) {
+			_image_silhouette.push_back(Silhouette(_last_depth));
+		}
 		
-		if (_N_current == _N){
+		if (_N_current == _N && !subdivide_adaptive()){
 			if(_verbose)
 				cout << "[INFO] - DONE - rendered " << _N_current << " sets." <<  endl;
 			_writing_file = true;
@@ -170,11 +250,18 @@ bool BalancedPoseTree::draw_sequence(void)
 		if (_writing_file)
 		{
 			string tree_file = _tree_output_path;
-			tree_file.append("/BPTData.csv");
+			tree_file.append("/BPTData.bpt");
 
 			cout << "[INFO] - Start writing tree to file" << endl;
 			BPTReaderWriter writer;
-			writer.write(tree_file, _root);
+			writer.writeBinary(tree_file, _root);
+
+			// the csv file is a debug export
+			if (_verbose) {
+				string csv_file = _tree_output_path;
+				csv_file.append("/BPTData.csv");
+				writer.write(csv_file, _root);
+			}
 			cout << "[INFO] - Done writing!" << endl;
 			_writing_file = false;
 		}
@@ -196,29 +283,141 @@ bool BalancedPoseTree::draw_sequence(void)
 
 
 /*
-Find and add the nearest neighbors for each node.
+Find the nearest neighbors of a node on the next polyhedron level.
+The k-d tree of the next level only returns the k closest points; the distances 
+to all other points are neither computed nor sorted. 
+@param node - the node.
+@param k - the number of neighbors.
+@return the point indices of the next level, sorted by distance. 
 */
-vector<int>  BalancedPoseTree::find_nearest_neighbors(BPTNode& node)
+vector<int>  BalancedPoseTree::find_nearest_neighbors(BPTNode& node, int k)
 {
 	// check for level
-	if ( node.level + 1 >= _tree_points.size() ) return vector<int>(0);
+	if ( node.level + 1 >= _tree_index.size() ) return vector<int>(0);
 
 	int next_level = node.level + 1;
 
-	// initialize index vector 
-	vector<int> idx(_tree_points[next_level].size());
-	iota(idx.begin(), idx.end(), 0);
+	vector<int> idx;
+	_tree_index[next_level].knn(node.point, k, idx);
+
+	return idx;
+}
+
+
+/*
+Create the children of a node on the next level.
+@param node - the node.
+@param k - the number of children.
+@param new_nodes - the new nodes are appended to this list.
+@return the number of children.
+*/
+int BalancedPoseTree::create_children(BPTNode* node, int k, std::list<BPTNode*>& new_nodes)
+{
+	int next_level = node->level + 1;
+
+	// points for the node's next level
+	const PolyhedronPoints& points = _tree_points[next_level];
+
+	// get nearest neighbors
+	vector<int> nn_idx = find_nearest_neighbors(*node, k);
+	int count = (std::min)(k, (int)nn_idx.size());
 
-	// calculate distances
-	vector<float> distances;
-	for (auto v : _tree_points[next_level]){
-		distances.push_back(glm::distance(v, node.point));
+	for (int i = 0; i < count; i++)
+	{
+		glm::vec3 new_point = points[nn_idx[i]];
+
+		BPTNode* new_node = new BPTNode(_curr_node_id, next_level, node->node_id, new_point, nn_idx[i]);
+		_curr_node_id++;
+
+		node->childs.push_back(new_node);
+		_tree_nodes.push_back(new_node);
+		new_nodes.push_back(new_node);
 	}
 
-	 // sort indexes based on comparing values in v
-	std::sort(idx.begin(), idx.end(),
-       [&distances](int i1, int i2) {return distances[i1] < distances[i2];});
+	return count;
+}
 
 
-	return idx;
-}
\ No newline at end of file
+/*
+Adaptive mode: subdivide the nodes of the last rendered level whose silhouette
+changes quickly. The new nodes are appended to the node list. 
+@return - true, if new nodes need to be rendered. 
+*/
+bool BalancedPoseTree::subdivide_adaptive(void)
+{
+	if (!_adaptive || _adaptive_leaves.size() == 0) return false;
+
+	int level = _adaptive_leaves[0]->level;
+	if (level + 1 >= _tree_points.size()) {
+		_adaptive_leaves.clear();
+		return false;
+	}
+
+	// the nodes of this level per polyhedron point. A point can belong to several nodes;
+	// they have the same view, so the first one is sufficient.
+	vector<int> node_of_point(_tree_points[level].size(), -1);
+	for (int i = 0; i < _adaptive_leaves.size(); i++) {
+		int pid = _adaptive_leaves[i]->point_id;
+		if (node_of_point[pid] < 0) node_of_point[pid] = i;
+	}
+
+	std::list<BPTNode*> new_nodes;
+	int subdivided = 0;
+
+	for (int i = 0; i < _adaptive_leaves.size(); i++)
+	{
+		BPTNode* node = _adaptive_leaves[i];
+
+		// the largest change to a polyhedron point with a node that shares an edge with this point.
+		const vector<int>& nn = _tree_adjacency[level][node->point_id];
+		float change = 0.0f;
+		for (int j = 0; j < nn.size(); j++) {
+			int n = node_of_point[nn[j]];
+			if (n < 0) continue;
+			change = (std::max)(change, SilhouetteChange(_image_silhouette[node->image_index], _image_silhouette[_adaptive_leaves[n]->image_index]));
+		}
+
+		if (change < _adaptive_threshold) continue;
+
+		create_children(node, 6, new_nodes);
+		subdivided++;
+	}
+
+	cout << "[INFO] - Adaptive subdivision of level " << level << ": " << subdivided << " of " << _adaptive_leaves.size() << " nodes with a silhouette change >= " << _adaptive_threshold << "." << endl;
+
+	_adaptive_leaves = vector<BPTNode*>(new_nodes.begin(), new_nodes.end());
+	_N = _tree_nodes.size();
+
+	return new_nodes.size() > 0;
+}
+
+
+/*
+Return a low-resolution silhouette (CV_8UC1, 0 or 255) of a depth image. 
+*/
+//static 
+cv::Mat BalancedPoseTree::Silhouette(const cv::Mat& depth)
+{
+	// background pixels keep the clear depth 1.0
+	cv::Mat mask = depth < 1.0f;
+	cv::Mat small;
+	cv::resize(mask, small, cv::Size(64, 64), 0, 0, cv::INTER_AREA);
+	return small > 127;
+}
+
+
+/*
+Return the silhouette change 1 - IoU of two silhouettes, from 0 to 1.
+*/
+//static 
+float BalancedPoseTree::SilhouetteChange(const cv::Mat& a, const cv::Mat& b)
+{
+	cv::Mat intersection, both;
+	cv::bitwise_and(a, b, intersection);
+	cv::bitwise_or(a, b, both);
+
+	int u = cv::countNonZero(both);
+	if (u == 0) return 0.0f;
+
+	return 1.0f - float(cv::countNonZero(intersection)) / float(u);
+}
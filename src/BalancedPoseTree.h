@@ -12,6 +12,16 @@ MIT license
 ----------------------------------------------------
 last edited:
 
+Oct 19, 2026, RR:
+- The child search uses a k-d tree per polyhedron level and a partial top-k selection, see PointKDTree.
+- create() reports the build time per tree level.
+- create() subdivides the polyhedron once for all levels.
+- The tree is written to the binary file BPTData.bpt. BPTData.csv is only written in verbose mode.
+- With the symmetry reduction enabled, nodes with equivalent views share one image. The tree structure 
+  stays complete, thus, lookups do not need to know the symmetry. Call setSymmetryReduction() before create().
+- Added an adaptive mode, see setAdaptive(). Only nodes whose silhouette differs from their neighbors get children.
+  The neighbors are the points that share a polyhedron edge. 
+- The up-vector of the camera comes from ModelSymmetry::CameraUp(), the symmetry reduction compares it.
 */
 #pragma once
 
@@ -21,6 +31,8 @@ last edited:
 #include <vector>
 #include <list>
 #include <numeric>
+#include <algorithm>
+#include <chrono>
 
 // opencv
 #include <opencv2/opencv.hpp>
@@ -37,6 +49,7 @@ last edited:
 #include "ModelRenderer.h"
 #include "BPTReaderWriter.h"
 #include "BPTTypes.h"
+#include "PointKDTree.h" // nearest neighbor search on the polyhedron levels
 
 using namespace std;
 
@@ -68,6 +81,18 @@ public:
 	*/
 	void setOutputPath(string path, string filename = "model");
 
+
+	/*
+	Enable or disable the adaptive subdivision. Call it before create(). 
+	In adaptive mode, create() only creates the first level. draw_sequence() renders a level, 
+	compares the silhouette of each node with the silhouettes of the neighboring nodes of the same level, 
+	and creates children only for nodes where the silhouette changes by more than the threshold. 
+	tree_depth of create() becomes the max. depth. 
+	@param enable - true enables the adaptive mode.
+	@param threshold - the min. silhouette change 1 - IoU, from 0 to 1, to subdivide a node. 
+	*/
+	void setAdaptive(bool enable, float threshold = 0.05f);
+
 	/*
 	Draw the image sequence and save all images to a file
 	@return - false, if images still need to be rendered. 
@@ -79,9 +104,42 @@ public:
 private:
 
 	/*
-	Find and add the nearest neighbors for each node.
+	Find the nearest neighbors of a node on the next polyhedron level.
+	@param node - the node.
+	@param k - the number of neighbors.
+	@return the point indices of the next level, sorted by distance. 
+	*/
+	vector<int> find_nearest_neighbors(BPTNode& node, int k);
+
+
+	/*
+	Create the children of a node on the next level.
+	@param node - the node.
+	@param k - the number of children.
+	@param new_nodes - the new nodes are appended to this list.
+	@return the number of children.
+	*/
+	int create_children(BPTNode* node, int k, std::list<BPTNode*>& new_nodes);
+
+
+	/*
+	Adaptive mode: subdivide the nodes of the last rendered level whose silhouette
+	changes quickly. The new nodes are appended to the node list. 
+	@return - true, if new nodes need to be rendered. 
+	*/
+	bool subdivide_adaptive(void);
+
+
+	/*
+	Return a low-resolution silhouette (CV_8UC1, 0 or 255) of a depth image. 
+	*/
+	static cv::Mat Silhouette(const cv::Mat& depth);
+
+
+	/*
+	Return the silhouette change 1 - IoU of two silhouettes, from 0 to 1.
 	*/
-	vector<int> find_nearest_neighbors(BPTNode& node);
+	static float SilhouetteChange(const cv::Mat& a, const cv::Mat& b);
 
 
 	//--------------------------------------------------------------
@@ -105,6 +163,20 @@ private:
 
 	BPTNode*				_root;
 	vector<PolyhedronPoints>		_tree_points;
+	vector<PointKDTree>			_tree_index; // one k-d tree per level of _tree_points
+	vector<vector<vector<int> > >	_tree_adjacency; // per level, the points that share a polyhedron edge with each point
+
+	// symmetry reduction, per level: the point whose view replaces the view of each point,
+	// and the image index of each representative point, -1 if not rendered yet. 
+	vector<vector<int> >		_tree_representative;
+	vector<vector<int> >		_tree_image;
+	int						_num_images; // number of rendered images
+
+	// adaptive subdivision
+	bool					_adaptive;
+	float					_adaptive_threshold;
+	vector<BPTNode*>			_adaptive_leaves; // rendered nodes of the last level, candidates for subdivision
+	vector<cv::Mat>			_image_silhouette; // silhouette per image index
 	std::vector<BPTNode*>		_tree_nodes;
 
 	std::list<BPTNode*>		_process_queue; // nodes that still need childs
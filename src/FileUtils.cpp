@@ -1,5 +1,8 @@
 #include "FileUtils.h"
 
+#include <cstdio>
+#include <cstring>
+
 
 #ifdef _WIN32
 	#if _MSC_VER >= 1920 && _MSVC_LANG  == 201703L 
@@ -193,4 +196,79 @@ bool FileUtils::CreateDirectory(string path)
 	return std::experimental::filesystem::create_directory(path);
 #endif
 
-}
\ No newline at end of file
+}
+
+
+/*
+Write a file atomically.
+@param path_and_file - relative or absolute location and name of the file.
+@param write - writes the content into the stream. 
+@return true, if the file was written. 
+*/
+//static 
+bool FileUtils::WriteAtomic(string path_and_file, const std::function<void(std::ofstream&)>& write)
+{
+	// one temporary file per process, so that concurrent writers do not share it
+#ifdef _WIN32
+	string temp_file = path_and_file + "." + to_string(GetCurrentProcessId()) + ".tmp";
+#else
+	string temp_file = path_and_file + "." + to_string(getpid()) + ".tmp";
+#endif
+
+	std::ofstream out(temp_file, std::ios::binary);
+	if (!out.is_open()) return false;
+
+	write(out);
+	out.close();
+	if (!out) {
+		std::remove(temp_file.c_str());
+		return false;
+	}
+
+	// rename replaces an existing file in one step on POSIX systems, but not on Windows
+#ifdef _WIN32
+	std::remove(path_and_file.c_str());
+#endif
+	if (std::rename(temp_file.c_str(), path_and_file.c_str()) != 0) {
+		std::remove(temp_file.c_str());
+		return false;
+	}
+	return true;
+}
+
+
+/*
+Calculate a 64-bit hash of the file content.
+@param path_and_file - relative or absolute location and name of the file.
+@param hash - location for the hash.
+@return true, if the file was read. 
+*/
+//static 
+bool FileUtils::HashFile(string path_and_file, uint64_t& hash)
+{
+	std::ifstream in(path_and_file, std::ios::binary);
+	if (!in.is_open()) return false;
+
+	// FNV offset basis; eight bytes per step with a rotate-multiply mix
+	hash = 14695981039346656037ULL;
+	uint64_t length = 0;
+	std::vector<char> buffer(1 << 20);
+	while (in) {
+		in.read(buffer.data(), buffer.size());
+		size_t n = (size_t)in.gcount();
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			uint64_t w;
+			memcpy(&w, &buffer[i], 8);
+			hash ^= w;
+			hash = ((hash << 29) | (hash >> 35)) * 0x9E3779B97F4A7C15ULL;
+		}
+		for (; i < n; i++) {
+			hash = (hash ^ (unsigned char)buffer[i]) * 1099511628211ULL;
+		}
+		length += n;
+	}
+	hash ^= length;
+	hash *= 0x9E3779B97F4A7C15ULL;
+	return true;
+}
@@ -14,6 +14,9 @@ Latest edits
 
 May 9, 2020, RR
 - Added function Search. 
+
+Oct 19, 2026, RR
+- Added WriteAtomic() and HashFile() for the binary caches. 
 */
 #pragma once
 
@@ -28,6 +31,8 @@ May 9, 2020, RR
 #include <vector>
 #include <map>
 #include <string>
+#include <functional>
+#include <cstdint>
 #ifdef _WIN32
 #include <windows.h>
 #include <tchar.h>
@@ -99,6 +104,25 @@ public:
 	*/
 	static bool CreateDirectory(string path);
 
+
+	/*
+	Write a file atomically. The content goes into a temporary file of this process first, 
+	which then replaces the file, so that other processes never read a partial file. 
+	@param path_and_file - relative or absolute location and name of the file.
+	@param write - writes the content into the stream. 
+	@return true, if the file was written. 
+	*/
+	static bool WriteAtomic(string path_and_file, const std::function<void(std::ofstream&)>& write);
+
+
+	/*
+	Calculate a 64-bit hash of the file content.
+	@param path_and_file - relative or absolute location and name of the file.
+	@param hash - location for the hash.
+	@return true, if the file was read. 
+	*/
+	static bool HashFile(string path_and_file, uint64_t& hash);
+
 };
 
 
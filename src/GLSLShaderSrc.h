@@ -7,6 +7,12 @@ Last edits:
 July 4th, 2019, RR
 - Added texture processing to image_renderer_vs and image_renderer_fs
 
+Oct 19, 2026, RR
+- The lights and the material of image_renderer_fs are std140 uniform blocks, see CommonTypes.h.
+- image_renderer_vs and normal_renderer_vs multiply the model matrix with the per-instance attribute in_InstanceMatrix for instanced drawing.
+- image_renderer_fs writes the instance id, object_id + gl_InstanceID, into a second unsigned integer output.
+- Added depth_only_vs and depth_only_fs, which write the linear depth of image_renderer_fs and nothing else.
+
 */
 
 
@@ -19,36 +25,41 @@ namespace glslshader
 		"uniform mat4 projectionMatrix;					\n"
 		"uniform mat4 viewMatrix;						\n"
 		"uniform mat4 modelMatrix;						\n"
+		"uniform int object_id; // the model, or the first instance	\n"
 		"												\n"
 		"//uniform vec3 light_position;					\n"
 		"uniform vec3 light_direction;					\n"
 		"												\n"
 		"in vec3 in_Position;							\n"
 		"in vec3 in_Normal;								\n"
+		"in mat4 in_InstanceMatrix; // identity if not instanced	\n"
 		"in vec2 in_Texture;							\n"				
 		"												\n"
 		"out vec3 pass_Normal;							\n"
 		"out vec3 pass_Position;						\n"
 		"out vec4 pass_Color;							\n"
 		"out vec4 pass_Coordinates;						\n"
+		"flat out int pass_ID;							\n"
 		"out vec2 pass_Texture;							\n"
 		"												\n"
 		"void main(void)								\n"
 		"{												\n"
+		"	mat4 m = modelMatrix * in_InstanceMatrix;		\n"
+		"	pass_ID = object_id + gl_InstanceID;		\n"
 		"	// to calculate the real (linear) depth		\n"
-		"	pass_Coordinates = projectionMatrix * viewMatrix * modelMatrix * vec4(in_Position, 1.0);	\n"
+		"	pass_Coordinates = projectionMatrix * viewMatrix * m * vec4(in_Position, 1.0);	\n"
 		"																								\n"
 		"	// for lighting																				\n"
-		"	pass_Position = vec3(viewMatrix *  modelMatrix  *  vec4(in_Position, 1.0));					\n"
+		"	pass_Position = vec3(viewMatrix *  m  *  vec4(in_Position, 1.0));					\n"
 		"																								\n"
-		"	pass_Normal = vec3(transpose(inverse(viewMatrix * modelMatrix)) *  vec4(in_Normal, 0.0));	\n"
+		"	pass_Normal = vec3(transpose(inverse(viewMatrix * m)) *  vec4(in_Normal, 0.0));	\n"
 		"																								\n"
 		"	pass_Color = vec4(normalize(in_Normal), 1.0);												\n"
 		"																								\n"
 		"	pass_Texture = in_Texture;																	\n"
 		"																								\n"		
 		"	// pass the position																		\n"
-		"	gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(in_Position, 1.0);			\n"
+		"	gl_Position = projectionMatrix * viewMatrix * m * vec4(in_Position, 1.0);			\n"
 		"																								\n"
 		"	gl_PointSize = 4.0;																			\n"
 		"}																								\n"
@@ -67,10 +78,11 @@ namespace glslshader
 		"in vec3 pass_Position;							\n"	
 		"in vec4 pass_Color;							\n"	
 		"in vec4 pass_Coordinates;						\n"	
+		"flat in int pass_ID;							\n"
 		"in vec2 pass_Texture;							\n"			
 		"												\n"	
 		"// The material parameters						\n"	
-		"uniform struct LightSource {					\n"	
+		"struct LightSource {							\n"	
 		"	vec3 position;								\n"	
 		"	vec3 direction;								\n"	
 		"	vec3 color;									\n"	
@@ -81,11 +93,14 @@ namespace glslshader
 		"	float k2;    //attenuation					\n"	
 		"	bool used;									\n"	
 		"	int  type;  //0:point, 1:spot, 2:directional\n"	
-		"} light[MAX_LIGHTS];							\n"	
+		"};												\n"	
+		"layout(std140) uniform LightBlock {			\n"	
+		"	LightSource light[MAX_LIGHTS];				\n"	
+		"};												\n"	
 		"												\n"	
 		"												\n"	
 		"// The material parameters						\n"	
-		"uniform struct Material {						\n"	
+		"struct Material {								\n"	
 		"	vec3  diffColor;							\n"	
  		"	float diffInt;								\n"	
  		"	vec3  ambColor;								\n"	
@@ -93,7 +108,10 @@ namespace glslshader
  		"	vec3  specColor;							\n"	
  		"	float specInt;								\n"	
  		"	float shininess;							\n"	
-		"} mat[1];										\n"	
+		"};												\n"	
+		"layout(std140) uniform MaterialBlock {			\n"	
+		"	Material mat[1];							\n"	
+		"};												\n"	
 		"												\n"	
 		"uniform struct Textures {						\n"
 		"	sampler2D tex_kd; // diffuse texture		\n"
@@ -109,7 +127,8 @@ namespace glslshader
 		"} tex[1];										\n"
 		"												\n"
 		"												\n"	
-		"out vec4 color;								\n"	
+		"layout(location = 0) out vec4 color;			\n"
+		"layout(location = 1) out uint out_ID; // the instance id, 0 is the background	\n"
 		"												\n"	
 		"/*												\n"	
 		"Per-fragment light.							\n"	
@@ -264,6 +283,7 @@ namespace glslshader
 		"	}																						\n"	
 		"																							\n"	
 		"	color = mixed;																			\n"	
+		"	out_ID = uint(pass_ID);																	\n"
 		"																							\n"	
 		"																							\n"	
 		"	//------------------------------------------------										\n"	
@@ -302,6 +322,7 @@ namespace glslshader
 			"																					\n"	
 			"in vec3 in_Position;																\n"	                                         
 			"in vec3 in_Normal;																	\n"	
+			"in mat4 in_InstanceMatrix; // identity if not instanced	\n"
 			"																					\n"	
 			"out vec3 pass_Normal;																\n"	
 			"out vec3 pass_Position;															\n"	
@@ -310,18 +331,19 @@ namespace glslshader
 			"																					\n"	
 			"void main(void)																	\n"	
 			"{																					\n"	
+			"	mat4 m = modelMatrix * in_InstanceMatrix;		\n"
 			"	// to calculate the real (linear) depth											\n"	
-			"	pass_Coordinates =  projectionMatrix * viewMatrix * modelMatrix * vec4(in_Position, 1.0);		\n"	
+			"	pass_Coordinates =  projectionMatrix * viewMatrix * m * vec4(in_Position, 1.0);		\n"	
 			"																									\n"	
 			"	// for lighting																					\n"	
-			"	pass_Position = vec3(  viewMatrix *  modelMatrix  *  vec4(in_Position, 1.0));					\n"	
+			"	pass_Position = vec3(  viewMatrix *  m  *  vec4(in_Position, 1.0));					\n"	
 			"																									\n"	
-			"	pass_Normal =   vec3( transpose(inverse(viewMatrix * modelMatrix)) *  vec4(in_Normal, 0.0));	\n"	
+			"	pass_Normal =   vec3( transpose(inverse(viewMatrix * m)) *  vec4(in_Normal, 0.0));	\n"	
 			"																									\n"	
 			"	pass_Color = vec4(normalize(in_Normal), 1.0);													\n"	
 			"																									\n"	
 			"	// pass the position																			\n"	
-			"	gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(in_Position, 1.0);				\n"	
+			"	gl_Position = projectionMatrix * viewMatrix * m * vec4(in_Position, 1.0);				\n"	
 			"																									\n"	
 			"	gl_PointSize = 4.0;																				\n"	
 			"}\n";
@@ -346,6 +368,44 @@ namespace glslshader
 			"	color = vec4(pass_Normal, 0.0f);//pass_Color;		\n"	         
 			"}\n";	
 
+		static string depth_only_vs =
+			"#version 410 core										\n"
+			"														\n"
+			"uniform mat4 projectionMatrix;							\n"
+			"uniform mat4 viewMatrix;								\n"
+			"uniform mat4 modelMatrix;								\n"
+			"														\n"
+			"in vec3 in_Position;									\n"
+			"														\n"
+			"out vec4 pass_Coordinates;								\n"
+			"														\n"
+			"void main(void)										\n"
+			"{														\n"
+			"	// the same transformation as image_renderer_vs		\n"
+			"	pass_Coordinates = projectionMatrix * viewMatrix * modelMatrix * vec4(in_Position, 1.0);	\n"
+			"	gl_Position = pass_Coordinates;						\n"
+			"}\n";
+
+		static string depth_only_fs =
+			"#version 410 core										\n"
+			"														\n"
+			"// moves the fragments towards the camera, to pass a depth test against image_renderer_fs	\n"
+			"uniform float depth_offset;							\n"
+			"														\n"
+			"in vec4 pass_Coordinates;								\n"
+			"														\n"
+			"void main(void)										\n"
+			"{														\n"
+			"	// the linear depth of image_renderer_fs; must match the projection	\n"
+			"	const float n = 0.01; // camera z near				\n"
+			"	const float f = 10.0; // camera z far				\n"
+			"														\n"
+			"	float current_depth = pass_Coordinates.z/ pass_Coordinates.w;	\n"
+			"	current_depth  = (2.0 * f  * n) / (f + n - current_depth * (f - n)) ;	\n"
+			"														\n"
+			"	gl_FragDepth =  current_depth - depth_offset;		\n"
+			"}\n";
+
 		static string display_renderer_vs =
 			"#version 410 core										\n"
 			"														\n"
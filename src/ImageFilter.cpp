@@ -20,7 +20,7 @@ ImageFilter::~ImageFilter()
 /**
 * Set the Chromatic Adaptation Algorithm to Gray World Algorithm
 */
-void ImageFilter::setFilterMethod(FilterMethod method) 
+void ImageFilter::setFilterMethod(FilterMethod method)
 {
 	_method = method;
 }
@@ -33,230 +33,310 @@ void ImageFilter::setFilterMethod(FilterMethod method)
 */
 void ImageFilter::setChromaticTemplate(cv::Mat& img)
 {
-	_template_img = img;
-	_method = CHROMATIC;
+	ImageStatistics stats;
+	ComputeStatistics(img, stats, false);
+	setChromaticTemplate(stats);
 
 	//cv::imshow("template", img);
 	//cv::waitKey();
 }
 
 
+/**
+* Set the template via statistics, which were computed with ComputeStatistics().
+*
+* @param template_stats The template image statistics.
+*/
+void ImageFilter::setChromaticTemplate(const ImageStatistics& template_stats)
+{
+	_template_stats = template_stats;
+
+	if (_method != HISTOGRAM) {
+		_method = CHROMATIC;
+	}
+}
+
+
 
 /*!
 	Apply the filter currently set. Note that the filter
-	expects to get an RGB image. It processes all three channels individually and merges them when finished/ 
-	@param input - A CV_8UC3 image. 
+	expects to get an RGB image. It processes all three channels individually and merges them when finished/
+	@param input - A CV_8UC3 image.
 	@return - A CV_8UC3 image with the  resolution of the input image
 */
 bool ImageFilter::apply(cv::Mat& input, cv::Mat& dst) {
 
+	cv::Mat lut;
+	if (!createLUT(input, lut)) {
+		return false;
+	}
 
-	if (input.rows == 0 || input.cols == 0) {
+	cv::LUT(input, lut, dst);
+
+	//cv::imshow("output", dst);
+	//cv::waitKey();
+
+	return true;
+
+}
+
+
+/*!
+Create the lookup table the current filter would apply to the input.
+@param input - A CV_8UC3 image.
+@param lut - location for the lookup table, 1 x 256, CV_8UC3
+@return - true, if the lookup table is valid.
+*/
+bool ImageFilter::createLUT(cv::Mat& input, cv::Mat& lut)
+{
+	if (input.rows == 0 || input.cols == 0 || input.type() != CV_8UC3) {
 		std::cout << "[ERROR] - ImageFiter: no valid input image provided." << std::endl;
 		return false;
 	}
 
+	ImageStatistics stats;
+	ComputeStatistics(input, stats, _method == WHITEBALANCE);
+
+	lut.create(1, 256, CV_8UC3);
+
 	switch (_method) {
 	case GRAYWORLD:
-		dst = grayworldFilter(input);
+		grayworldLUT(stats, lut);
 		break;
 	case WHITEBALANCE:
-		dst = whitebalanceFilter(input);
+		whitebalanceLUT(stats, lut);
 		break;
 	case CHROMATIC:
-		dst = chromaticFilter(input);
-		break;
+		return chromaticLUT(stats, lut);
+	case HISTOGRAM:
+		return histogramLUT(stats, lut);
 	}
 
-	//cv::imshow("output", dst);
-	//cv::waitKey();
-
 	return true;
-
 }
 
-/*
-Apply the grayworld filter. It creates a gray-tone image.
-@param input - A CV_8UC3 image. 
-@return - A CV_8UC3 image with the  resolution of the input image
+
+/*!
+Compute the statistics of an image in one pass.
+@param src - A CV_8UC3 image.
+@param stats - location for the statistics.
+@param with_whitebalance - also computes the white balance averages. This requires a second pass.
+@return - true, if successful.
 */
-cv::Mat ImageFilter::grayworldFilter(cv::Mat& src)
+//static
+bool ImageFilter::ComputeStatistics(const cv::Mat& src, ImageStatistics& stats, bool with_whitebalance)
 {
-	Mat dst;
+	stats = ImageStatistics();
 
-	vector<Mat> RGBchannels;
-	split(src, RGBchannels);
-	Mat BChanel = RGBchannels.at(0);
-	Mat GChanel = RGBchannels.at(1);
-	Mat RChanel = RGBchannels.at(2);
+	if (src.rows == 0 || src.cols == 0 || src.type() != CV_8UC3) {
+		std::cout << "[ERROR] - ImageFiter: statistics require a CV_8UC3 image." << std::endl;
+		return false;
+	}
 
-	double BChannelAvg = 0;
-	double GChannelAvg = 0;
-	double RChannelAvg = 0;
+	int rows = src.rows;
+	int cols = src.cols;
+	if (src.isContinuous()) {
+		cols = rows * cols;
+		rows = 1;
+	}
 
-	BChannelAvg = mean(BChanel)[0];
-	GChannelAvg = mean(GChanel)[0];
-	RChannelAvg = mean(RChanel)[0];
+	// integer histograms, one pass over the image
+	std::vector<int> hB(256, 0), hG(256, 0), hR(256, 0);
+	std::vector<int> hSum(767, 0);
+
+	for (int i = 0; i < rows; i++) {
+		const uchar* p = src.ptr<uchar>(i);
+		const uchar* end = p + cols * 3;
+		if (with_whitebalance) {
+			for (; p < end; p += 3) {
+				hB[p[0]]++;
+				hG[p[1]]++;
+				hR[p[2]]++;
+				hSum[p[0] + p[1] + p[2]]++;
+			}
+		}
+		else {
+			for (; p < end; p += 3) {
+				hB[p[0]]++;
+				hG[p[1]]++;
+				hR[p[2]]++;
+			}
+		}
+	}
 
-	double K = (BChannelAvg + GChannelAvg + RChannelAvg) / 3;
-	double Kb = K / BChannelAvg;
-	double Kg = K / GChannelAvg;
-	double Kr = K / RChannelAvg;
+	//----------------------------------------------
+	// derive the means and the max. value from the histograms
+
+	const std::vector<int>* h[3] = { &hB, &hG, &hR };
+	stats.num_pixels = src.rows * src.cols;
+
+	for (int c = 0; c < 3; c++) {
+		double sum = 0.0;
+		int cnt_nonzero = 0;
+		for (int v = 0; v < 256; v++) {
+			int n = (*h[c])[v];
+			stats.hist[c][v] = (float)n;
+			sum += (double)v * n;
+			if (v > 0) cnt_nonzero += n;
+			if (n > 0) stats.max_value = (std::max)(stats.max_value, v);
+		}
+		stats.mean[c] = sum / stats.num_pixels;
+		stats.mean_nonzero[c] = (cnt_nonzero > 0) ? sum / cnt_nonzero : 0.0;
+	}
+
+	//----------------------------------------------
+	// white balance: average of the brightest 10% of all pixels
+
+	if (with_whitebalance) {
+		int threshold = 0;
+		int sum = 0;
+		for (int i = 766; i >= 0; i--) {
+			sum += hSum[i];
+			if (sum > stats.num_pixels * 0.1) {
+				threshold = i;
+				break;
+			}
+		}
 
-	addWeighted(BChanel, Kb, 0, 0, 0, BChanel);
-	addWeighted(GChanel, Kg, 0, 0, 0, GChanel);
-	addWeighted(RChanel, Kr, 0, 0, 0, RChanel);
+		double avg[3] = { 0.0, 0.0, 0.0 };
+		int cnt = 0;
+		for (int i = 0; i < rows; i++) {
+			const uchar* p = src.ptr<uchar>(i);
+			const uchar* end = p + cols * 3;
+			for (; p < end; p += 3) {
+				if (p[0] + p[1] + p[2] > threshold) {
+					avg[0] += p[0];
+					avg[1] += p[1];
+					avg[2] += p[2];
+					cnt++;
+				}
+			}
+		}
+		for (int c = 0; c < 3; c++) {
+			stats.wb_avg[c] = (cnt > 0) ? avg[c] / cnt : 0.0;
+		}
+	}
 
-	merge(RGBchannels, dst);
+	stats.valid = true;
 
-	return dst;
+	return true;
 }
 
 
 /*
-Apply a white-balance filter. 
-@param input - A CV_8UC3 image. 
-@return - A CV_8UC3 image with the  resolution of the input image
+Create the grayworld lookup table. It equalizes the channel means.
+@param stats - statistics of the input image
+@param lut - lookup table 1 x 256, CV_8UC3
 */
-cv::Mat ImageFilter::whitebalanceFilter(cv::Mat& src)
+void ImageFilter::grayworldLUT(const ImageStatistics& stats, cv::Mat& lut)
 {
-	Mat dst;
-
-	int row = src.rows;
-	int col = src.cols;
-	dst = Mat(row, col, CV_8UC3);
-	int HistRGB[767] = { 0 };
-	int MaxVal = 0;
-	for (int i = 0; i < row; i++) {
-		for (int j = 0; j < col; j++) {
-			MaxVal = max(MaxVal, (int)src.at<Vec3b>(i, j)[0]);
-			MaxVal = max(MaxVal, (int)src.at<Vec3b>(i, j)[1]);
-			MaxVal = max(MaxVal, (int)src.at<Vec3b>(i, j)[2]);
-			int sum = src.at<Vec3b>(i, j)[0] + src.at<Vec3b>(i, j)[1] + src.at<Vec3b>(i, j)[2];
-			HistRGB[sum]++;
-		}
+	double K = (stats.mean[0] + stats.mean[1] + stats.mean[2]) / 3;
+
+	double k[3];
+	for (int c = 0; c < 3; c++) {
+		k[c] = (stats.mean[c] > 0.0) ? K / stats.mean[c] : 1.0;
 	}
-	int Threshold = 0;
-	int sum = 0;
-	for (int i = 766; i >= 0; i--) {
-		sum += HistRGB[i];
-		if (sum > row * col * 0.1) {
-			Threshold = i;
-			break;
+
+	cv::Vec3b* l = lut.ptr<cv::Vec3b>(0);
+	for (int v = 0; v < 256; v++) {
+		for (int c = 0; c < 3; c++) {
+			l[v][c] = saturate_cast<uchar>(v * k[c]);
 		}
 	}
-	int AvgB = 0;
-	int AvgG = 0;
-	int AvgR = 0;
-	int cnt = 0;
-	for (int i = 0; i < row; i++) {
-		for (int j = 0; j < col; j++) {
-			int sumP = src.at<Vec3b>(i, j)[0] + src.at<Vec3b>(i, j)[1] + src.at<Vec3b>(i, j)[2];
-			if (sumP > Threshold) {
-				AvgB += src.at<Vec3b>(i, j)[0];
-				AvgG += src.at<Vec3b>(i, j)[1];
-				AvgR += src.at<Vec3b>(i, j)[2];
-				cnt++;
-			}
+}
+
+
+/*
+Create a white-balance lookup table.
+@param stats - statistics of the input image, computed with_whitebalance
+@param lut - lookup table 1 x 256, CV_8UC3
+*/
+void ImageFilter::whitebalanceLUT(const ImageStatistics& stats, cv::Mat& lut)
+{
+	double k[3];
+	for (int c = 0; c < 3; c++) {
+		k[c] = (stats.wb_avg[c] > 0.0) ? stats.max_value / stats.wb_avg[c] : 1.0;
+	}
+
+	cv::Vec3b* l = lut.ptr<cv::Vec3b>(0);
+	for (int v = 0; v < 256; v++) {
+		for (int c = 0; c < 3; c++) {
+			l[v][c] = (uchar)(std::min)(255, (int)(v * k[c]));
 		}
 	}
-	AvgB /= cnt;
-	AvgG /= cnt;
-	AvgR /= cnt;
-	for (int i = 0; i < row; i++) {
-		for (int j = 0; j < col; j++) {
-			int Blue = src.at<Vec3b>(i, j)[0] * MaxVal / AvgB;
-			int Green = src.at<Vec3b>(i, j)[1] * MaxVal / AvgG;
-			int Red = src.at<Vec3b>(i, j)[2] * MaxVal / AvgR;
-			if (Red > 255) {
-				Red = 255;
-			}
-			else if (Red < 0) {
-				Red = 0;
-			}
-			if (Green > 255) {
-				Green = 255;
-			}
-			else if (Green < 0) {
-				Green = 0;
-			}
-			if (Blue > 255) {
-				Blue = 255;
-			}
-			else if (Blue < 0) {
-				Blue = 0;
-			}
-			dst.at<Vec3b>(i, j)[0] = Blue;
-			dst.at<Vec3b>(i, j)[1] = Green;
-			dst.at<Vec3b>(i, j)[2] = Red;
+}
+
+
+/*
+Create a choromatic lookup table. It adapts the color tone and hue to a
+given template. Use setChromaticTemplate() to set the template.
+The function will not proceed without a template.
+*/
+bool ImageFilter::chromaticLUT(const ImageStatistics& stats, cv::Mat& lut)
+{
+	if (!_template_stats.valid) {
+		std::cout << "[ERROR] - ImageFiter: no valid template image provided." << std::endl;
+		return false;
+	}
+
+	// the rendering is only adapted with respect to its non-zero (foreground) values.
+	double k[3];
+	for (int c = 0; c < 3; c++) {
+		k[c] = (stats.mean_nonzero[c] > 0.0) ? _template_stats.mean[c] / stats.mean_nonzero[c] : 1.0;
+	}
+
+	cv::Vec3b* l = lut.ptr<cv::Vec3b>(0);
+	for (int v = 0; v < 256; v++) {
+		for (int c = 0; c < 3; c++) {
+			l[v][c] = saturate_cast<uchar>(v * k[c]);
 		}
 	}
 
-	return dst;
+	return true;
 }
 
 
 /*
-Apply a choromatic filter. It adapts the color tone and hue to a 
-given template. Use setChromaticTemplate() to set the template. 
-The function will not proceed without a template. 
+Create a histogram matching lookup table. It maps the histogram of all
+non-zero input values onto the template histogram, per channel.
 */
-cv::Mat ImageFilter::chromaticFilter(cv::Mat& src)
+bool ImageFilter::histogramLUT(const ImageStatistics& stats, cv::Mat& lut)
 {
-	Mat dst;
-
-	if (_template_img.rows == 0 || _template_img.cols == 0) {
+	if (!_template_stats.valid) {
 		std::cout << "[ERROR] - ImageFiter: no valid template image provided." << std::endl;
-		return dst;
+		return false;
 	}
 
+	cv::Vec3b* l = lut.ptr<cv::Vec3b>(0);
+
+	for (int c = 0; c < 3; c++) {
+		// cumulative distributions. The zero bin of the input is the background and is skipped.
+		double cdf_src[256];
+		double cdf_tpl[256];
+		double n_src = 0.0;
+		double n_tpl = 0.0;
+		for (int v = 0; v < 256; v++) {
+			n_src += (v > 0) ? stats.hist[c][v] : 0.0;
+			n_tpl += _template_stats.hist[c][v];
+			cdf_src[v] = n_src;
+			cdf_tpl[v] = n_tpl;
+		}
 
-	vector<Mat> RGBchannels;
-	split(src, RGBchannels);
-	Mat BChanel = RGBchannels.at(0);
-	Mat GChanel = RGBchannels.at(1);
-	Mat RChanel = RGBchannels.at(2);
-
-	double BChannelAvg = 0;
-	double GChannelAvg = 0;
-	double RChannelAvg = 0;
-
-	int numB = cv::countNonZero(BChanel);
-	int numG = cv::countNonZero(GChanel);
-	int numR = cv::countNonZero(RChanel);
-
-	cv::Scalar sums = cv::sum(src);
-
-	//BChannelAvg = mean(BChanel)[0];
-	//GChannelAvg = mean(GChanel)[0];
-	//RChannelAvg = mean(RChanel)[0];
-
-	BChannelAvg = sums[0] / numB;
-	GChannelAvg = sums[1] / numG;
-	RChannelAvg = sums[2] / numR;
-		
-	vector<Mat> tmpRGBchannels;
-	split(_template_img, tmpRGBchannels);
-	Mat tmpBChanel = tmpRGBchannels.at(0);
-	Mat tmpGChanel = tmpRGBchannels.at(1);
-	Mat tmpRChanel = tmpRGBchannels.at(2);
-
-	double tmpBChannelAvg = 0;
-	double tmpGChannelAvg = 0;
-	double tmpRChannelAvg = 0;
-
-	tmpBChannelAvg = mean(tmpBChanel)[0];
-	tmpGChannelAvg = mean(tmpGChanel)[0];
-	tmpRChannelAvg = mean(tmpRChanel)[0];
-		
-		
-	BChanel = BChanel*(tmpBChannelAvg / BChannelAvg);
-	GChanel = GChanel*(tmpGChannelAvg / GChannelAvg);
-	RChanel = RChanel*(tmpRChannelAvg / RChannelAvg);
-
-	merge(RGBchannels, dst);
-
-	return dst;
-}
+		l[0][c] = 0;
+		if (n_src <= 0.0 || n_tpl <= 0.0) {
+			for (int v = 1; v < 256; v++) l[v][c] = (uchar)v;
+			continue;
+		}
 
+		// both cdfs are monotonic, so one sweep finds all matches.
+		int t = 0;
+		for (int v = 1; v < 256; v++) {
+			double q = cdf_src[v] / n_src;
+			while (t < 255 && cdf_tpl[t] / n_tpl < q) t++;
+			// keep foreground pixels non-zero so that they remain foreground
+			l[v][c] = (uchar)(std::max)(1, t);
+		}
+	}
 
+	return true;
+}
@@ -4,8 +4,24 @@
 * Chromatic adaptation is the human visual systemm's ability to adjust
 * to changes in illumination in order to preserve the appearance of
 * object colors.
-* There are 3 Chromatic adaptation algorithms: 
-* Gray World Algorithm, White Balance Algorithm, Adaptation for template image
+* There are 4 Chromatic adaptation algorithms:
+* Gray World Algorithm, White Balance Algorithm, Adaptation for template image,
+* and Histogram Matching to a template image.
+*
+* All algorithms work in two phases. First, a statistics pass collects per-channel
+* histograms of the input (and of the template). Second, the statistics are turned into
+* a per-channel 256-entry lookup table, which is applied in a single cv::LUT pass.
+* The template statistics are computed once per template and can be reused,
+* see ComputeStatistics() and setChromaticTemplate(const ImageStatistics&).
+*
+* Note that all lookup tables map 0 to 0. Thus, a black rendering background stays black.
+*
+* ----------------------------------------------------------------------------------------
+* Last edits:
+*
+* Oct 19, 2026, RR:
+* - Replaced the per-pixel filter implementations with a statistics pass and a lookup table pass.
+* - Added the HISTOGRAM method, which matches the input histogram to the template histogram.
 */
 
 #include <Eigen/Dense>
@@ -29,9 +45,40 @@ public:
 	typedef enum {
 		GRAYWORLD,
 		WHITEBALANCE,
-		CHROMATIC
+		CHROMATIC,
+		HISTOGRAM
 	} FilterMethod;
 
+
+	/**
+	* Per-channel image statistics (B, G, R order).
+	* The histograms are all the filters need. Means and the maximum are derived from them.
+	* The white balance values are only valid if the statistics were computed with_whitebalance.
+	*/
+	typedef struct _ImageStatistics {
+		float	hist[3][256];		// per-channel histograms, absolute counts
+		double	mean[3];			// mean over all pixels
+		double	mean_nonzero[3];	// mean over all non-zero values
+		int		max_value;			// max. value over all channels
+		double	wb_avg[3];			// mean of the brightest 10% of all pixels (sum of B+G+R)
+		int		num_pixels;
+		bool	valid;
+
+		_ImageStatistics()
+		{
+			memset(hist, 0, sizeof(hist));
+			for (int i = 0; i < 3; i++) {
+				mean[i] = 0.0;
+				mean_nonzero[i] = 0.0;
+				wb_avg[i] = 0.0;
+			}
+			max_value = 0;
+			num_pixels = 0;
+			valid = false;
+		}
+	}ImageStatistics;
+
+
 	/**
 	* Constructor for ImageFilter
 	* Default Chromatic Adaptation Algorithm is Gray World Algorithm
@@ -44,58 +91,98 @@ public:
 	*/
 	~ImageFilter();
 
-	
+
 
 	/**
-	* Set the Chromatic Adaptation Algorithm to Template Image Adaptation
+	* Set the template image for the Template Image Adaptation and the Histogram Matching.
+	* The method switches to CHROMATIC unless HISTOGRAM is set.
 	*/
 	void setChromaticTemplate(cv::Mat& template_img);
 
+	/**
+	* Set the template via statistics, which were computed with ComputeStatistics().
+	* Use this to cache the statistics of a background template.
+	*/
+	void setChromaticTemplate(const ImageStatistics& template_stats);
+
 	/**
 	* Set the Chromatic Adaptation Algorithm to Gray World Algorithm
 	*/
 	void setFilterMethod(FilterMethod method);
 
+	/**
+	* Return the current Chromatic Adaptation Algorithm
+	*/
+	FilterMethod getFilterMethod(void) { return _method; }
+
 
 	/*!
 	Apply the filter currently set. Note that the filter
-	expects to get an RGB image. It processes all three channels individually and merges them when finished/ 
-	@param input - A CV_8UC3 image. 
+	expects to get an RGB image. It processes all three channels individually and merges them when finished/
+	@param input - A CV_8UC3 image.
 	@return - A CV_8UC3 image with the  resolution of the input image
 	*/
 	bool apply(cv::Mat& input, cv::Mat& dst);
 
 
+	/*!
+	Create the lookup table the current filter would apply to the input.
+	@param input - A CV_8UC3 image.
+	@param lut - location for the lookup table, 1 x 256, CV_8UC3
+	@return - true, if the lookup table is valid.
+	*/
+	bool createLUT(cv::Mat& input, cv::Mat& lut);
+
+
+	/*!
+	Compute the statistics of an image in one pass.
+	@param src - A CV_8UC3 image.
+	@param stats - location for the statistics.
+	@param with_whitebalance - also computes the white balance averages. This requires a second pass.
+	@return - true, if successful.
+	*/
+	static bool ComputeStatistics(const cv::Mat& src, ImageStatistics& stats, bool with_whitebalance = false);
+
 
 private:
 
 
 	/*
-	Apply the grayworld filter. It creates a gray-tone image.
-	@param input - A CV_8UC3 image. 
-	@return - A CV_8UC3 image with the  resolution of the input image
+	Create the grayworld lookup table. It equalizes the channel means.
+	@param stats - statistics of the input image
+	@param lut - lookup table 1 x 256, CV_8UC3
 	*/
-	cv::Mat grayworldFilter(cv::Mat& src);
+	void grayworldLUT(const ImageStatistics& stats, cv::Mat& lut);
 
 	/*
-	Apply a white-balance filter. 
-	@param input - A CV_8UC3 image. 
-	@return - A CV_8UC3 image with the  resolution of the input image
+	Create a white-balance lookup table.
+	@param stats - statistics of the input image, computed with_whitebalance
+	@param lut - lookup table 1 x 256, CV_8UC3
+	*/
+	void whitebalanceLUT(const ImageStatistics& stats, cv::Mat& lut);
+
+	/*
+	Create a choromatic lookup table. It adapts the color tone and hue to a
+	given template. Use setChromaticTemplate() to set the template.
+	The function will not proceed without a template.
+	@param stats - statistics of the input image
+	@param lut - lookup table 1 x 256, CV_8UC3
 	*/
-	cv::Mat whitebalanceFilter(cv::Mat& src);
+	bool chromaticLUT(const ImageStatistics& stats, cv::Mat& lut);
 
 	/*
-	Apply a choromatic filter. It adapts the color tone and hue to a 
-	given template. Use setChromaticTemplate() to set the template. 
-	The function will not proceed without a template. 
+	Create a histogram matching lookup table. It maps the histogram of all
+	non-zero input values onto the template histogram, per channel.
+	@param stats - statistics of the input image
+	@param lut - lookup table 1 x 256, CV_8UC3
 	*/
-	cv::Mat chromaticFilter(cv::Mat& src);
+	bool histogramLUT(const ImageStatistics& stats, cv::Mat& lut);
 
 
 	// Variable used for define the algorithm type
 	FilterMethod	_method;
 
-	// Mat variable used for save template image for chromatic adaptation
-	Mat				_template_img;
+	// statistics of the template image for chromatic adaptation and histogram matching
+	ImageStatistics	_template_stats;
 
-};
\ No newline at end of file
+};
@@ -9,6 +9,7 @@ ImageWriter::ImageWriter()
 	_output_file_name = "image";
 
 	_logfile_name = "render_log.csv";
+	_instance_file_name = "render_instances.csv";
 
 
 	// delete the log file if one exist 
@@ -257,6 +258,9 @@ bool ImageWriter::write(IWData& data)
 	string name_cp = name;
 	name_cp.append("_cp.txt");
 
+	string name_ids = name;
+	name_ids.append("_ids.png");
+
 	// Delete all clear buffer values from the depth map.
 
 	cv::Mat output_depth;
@@ -287,6 +291,10 @@ bool ImageWriter::write(IWData& data)
 	cv::imwrite(name_normals, normals_16UC3);
 	cv::imwrite(name_mask, *data.mask);
 
+	// the ids are 16-bit integers, no conversion
+	if (data.ids != NULL)
+		cv::imwrite(name_ids, *data.ids);
+
 #ifdef LOAD_TEST
 	cv::imshow("16bit", normals_16UC3);
 	cout << "Write " << name_normals << " as " << type2str(normals_16UC3.type()) << endl;
@@ -323,11 +331,55 @@ bool ImageWriter::write(IWData& data)
 	{
 		of << to_string(data.index) << "," << name_rgb << "," << name_normals << "," << name_depth << "," << name_mask << "," <<
 			name_mat << "," <<  pose[3][0]<< "," <<  pose[3][1]  << "," <<  pose[3][2] <<
-			"," <<  q.x() << "," <<  q.y() <<"," <<  q.z() <<"," <<  q.w() << "," << data.roi.x << "," << data.roi.y << "," << data.roi.width << "," << data.roi.height  << "," << name_cp << "\n";
+			"," <<  q.x() << "," <<  q.y() <<"," <<  q.z() <<"," <<  q.w() << "," << data.roi.x << "," << data.roi.y << "," << data.roi.width << "," << data.roi.height  << "," << name_cp << "," << data.visible << "\n";
 
 	}
 	of.close();
 
+	//--------------------------------------------------------------------------------------------------------------------------------------------------
+	// write one entry per object instance
+
+	if (data.instances.size() > 0) {
+		string instance_str = "./";
+		instance_str.append(_output_file_path);
+		instance_str.append("/");
+		instance_str.append(_instance_file_name);
+
+		bool with_header = !FileUtils::Exists(instance_str);
+
+		std::ofstream ofi(instance_str, std::ifstream::out | std::ifstream::app);
+		if (ofi.is_open())
+		{
+			if (with_header) {
+				ofi << "index,instance,model_file,tx,ty,tz,qx,qy,qz,qw,roi_x,roi_y,roi_w,roi_h,visible";
+				for (int i = 0; i < 9; i++) ofi << ",cp" << i << "_u,cp" << i << "_v";
+				ofi << "\n";
+			}
+
+			for (auto& inst : data.instances) {
+				Eigen::Matrix4f m;
+				Eigen::Quaternionf qi;
+				glm::mat4 p = inst.pose;
+				m << p[0][0], p[1][0], p[2][0], p[3][0],
+					p[0][1], p[1][1], p[2][1], p[3][1],
+					p[0][2], p[1][2], p[2][2], p[3][2],
+					p[0][3], p[1][3], p[2][3], p[3][3];
+				MatrixHelpers::MatrixToQuaternion(m, qi);
+
+				ofi << to_string(data.index) << "," << inst.id << "," << inst.model << "," << p[3][0] << "," << p[3][1] << "," << p[3][2] << 
+					"," << qi.x() << "," << qi.y() << "," << qi.z() << "," << qi.w() << "," << inst.roi.x << "," << inst.roi.y << "," << inst.roi.width << "," << inst.roi.height << "," << inst.visible;
+
+				// missing points are out of the image, -1
+				for (int i = 0; i < 9; i++) {
+					glm::vec2 cp = i < inst.control_points.size() ? inst.control_points[i] : glm::vec2(-1.0f, -1.0f);
+					ofi << "," << cp.x << "," << cp.y;
+				}
+				ofi << "\n";
+			}
+		}
+		ofi.close();
+	}
+
 	return true;
 }
 
@@ -344,6 +396,38 @@ bool ImageWriter::writeModelFile( std::vector<glm::vec3> control_points)
 	return ControlPointsHelper::Write3D(name, ControlPointsHelper::BBoxLocal, control_points);
 }
 
+
+/*
+Write model data to a file, the bounding box corner points and the rotational symmetry group.
+@param control_points - the corner point points. 
+@param symmetry - the symmetry group of the model. 
+*/
+bool ImageWriter::writeModelFile( std::vector<glm::vec3> control_points, const ModelSymmetry::Group& symmetry)
+{
+	if (!writeModelFile(control_points)) return false;
+
+	string name = _output_file_path;
+	name.append("/");
+	name.append("Model_info");
+	name.append("_");
+	name.append(_output_file_name);
+	name.append(".csv");
+
+	std::ofstream out_file(name, std::ofstream::out | std::ofstream::app);
+	if (!out_file.is_open()) {
+		cout << "[ERROR] - ImageWriter: cannot open file " << name << " for writing." << endl;
+		return false;
+	}
+
+	out_file << "Symmetry\n";
+	out_file << ModelSymmetry::ToString(symmetry) << "," << symmetry.order << ","
+		<< symmetry.axis.x << "," << symmetry.axis.y << "," << symmetry.axis.z << ","
+		<< symmetry.center.x << "," << symmetry.center.y << "," << symmetry.center.z << "\n";
+	out_file.close();
+
+	return true;
+}
+
 /*
 Check whether the path exists.
 Create a folder if the path does not exist.
@@ -368,6 +452,14 @@ bool ImageWriter::checkFolder(string path)
 		if (std::experimental::filesystem::exists(list_str))
 			std::experimental::filesystem::remove(list_str);
 #endif
+
+		// the instance file of an earlier run
+		string instance_str = "./";
+		instance_str.append(_output_file_path);
+		instance_str.append("/");
+		instance_str.append(_instance_file_name);
+		if (FileUtils::Exists(instance_str))
+			std::remove(instance_str.c_str());
 	}
 
 
@@ -392,7 +484,7 @@ bool ImageWriter::checkFolder(string path)
 		// create a header
 		std::ofstream of(list_str, std::ifstream::out | std::ifstream::app);
 		if (of.is_open()){
-			of << "index,rgb_file,normals_file,depth_file,mask_file,mat_file,tx,ty,tz,qx,qy,qz,qw,roi_x,roi_y,roi_w,roi_h,cp_file\n";
+			of << "index,rgb_file,normals_file,depth_file,mask_file,mat_file,tx,ty,tz,qx,qy,qz,qw,roi_x,roi_y,roi_w,roi_h,cp_file,visible\n";
 		}
 		of.close();
 	}
@@ -36,6 +36,11 @@ Dec 10, 2019, RR:
 - Added FileUtils.h to address the deprecation of experimental/filesystem
 June 6, 2020, RR:
 - Added a function to store model information to a file. 
+Oct 19, 2026, RR:
+- Added a writeModelFile() version that also writes the rotational symmetry group of the model. 
+- Writes the poses, rois, and control points of all object instances of an image to render_instances.csv, see IWInstance.
+- Writes the instance id image of multi-object images, _ids.png.
+- Writes the visible fraction of the model and of each instance, the column 'visible'. 
 */
 
 // stl
@@ -69,6 +74,7 @@ June 6, 2020, RR:
 #include "MatrixHelpers.h"
 #include "types.h"
 #include "ControlPointsHelper.h"
+#include "ModelSymmetry.h"
 
 using namespace std;
 
@@ -76,16 +82,40 @@ class ImageWriter
 {
 public:
 
+	/*
+	One object instance of a multi-object image. 
+	*/
+	typedef struct IWInstance {
+		int id; // instance id in the image, 0 is the model at the origin. Its pixels in the id image have the value id + 1. 
+		string model; // the model file
+		glm::mat4 pose; // the object pose in camera coordinates
+		cv::Rect2f roi; // the projected bounding box, clipped to the image
+		std::vector<glm::vec2> control_points; // the projected bounding box corners and the center
+		float visible; // visible fraction of the object, from 0 to 1, -1 if not measured
+
+		IWInstance(){
+			id = 0;
+			visible = -1.0f;
+		}
+
+	}IWInstance;
+
+
 	typedef struct IWData {
 		int index;
 		cv::Mat* rgb;
 		cv::Mat* normals;
 		cv::Mat* depth;
 		cv::Mat* mask;
+		cv::Mat* ids; // CV_16UC1 instance id image, 0 is the background, optional
 		cv::Rect2f roi;
 		glm::mat4 pose;
 
 		std::vector<glm::vec2> control_points;
+		float visible; // visible fraction of the model, from 0 to 1, -1 if not measured
+
+		// all object instances if the image shows several objects, written to the instance file. 
+		std::vector<IWInstance> instances;
 
 		IWData(){
 			index = 0;
@@ -98,6 +128,8 @@ public:
 			normals = NULL;
 			depth = NULL;
 			mask = NULL;
+			ids = NULL;
+			visible = -1.0f;
 		}
 
 	}IWData;
@@ -129,6 +161,8 @@ public:
 
 	/*
 	Write the image data to a file
+	If the data contains instances, the function appends one line per instance to render_instances.csv:
+	index, instance, model file, pose translation and quaternion, roi, visible fraction, and the 9 control points as u, v pairs.
 	@param data - a dataset of type IMData
 	*/
 	bool write(IWData& data);
@@ -143,6 +177,17 @@ public:
 	bool writeModelFile( std::vector<glm::vec3> control_points);
 
 
+	/*
+	Write model data to a file, the bounding box corner points and the rotational symmetry group.
+	The symmetry follows the corner points as two lines: the label 'Symmetry' and 
+	group, order, axis x, y, z, center x, y, z, e.g., C4,4,0,1,0,0,0,0. 
+	Readers of the corner points (ControlPointsHelper::Read3D) ignore it. 
+	@param control_points - the corner point points. 
+	@param symmetry - the symmetry group of the model. 
+	*/
+	bool writeModelFile( std::vector<glm::vec3> control_points, const ModelSymmetry::Group& symmetry);
+
+
 
 private:
 
@@ -161,6 +206,7 @@ private:
 	string					_output_file_name;
 
 	string					_logfile_name;
+	string					_instance_file_name;
 
 
 
@@ -54,6 +54,7 @@ bool Model3D::create(string path_and_file)
 	// create model
 	_obj_model = new cs557::OBJModel();
 	_obj_model->create(path_and_file, program);
+	cs557::OBJParser::Clear();
 
 
 	_light0.apply(program);
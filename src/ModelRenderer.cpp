@@ -6,9 +6,13 @@ ModelRenderer::ModelRenderer(int window_width, int window_height, int image_widt
 	_width(window_width), _height(window_height), _image_width(image_width),  _image_height(image_height)
 {
 	_obj_model = NULL;
+	_obj_model_normals = NULL;
 	_fboHidden = -1;
 	_color_texture_idx = -1;
 	_depth_texture_idx = -1;
+	_id_texture_idx = -1;
+	_with_ids = false;
+	_id_location = -1;
 
 	_fboHiddenNormals = -1;
 	_normal_texture_idx = -1;
@@ -26,6 +30,21 @@ ModelRenderer::ModelRenderer(int window_width, int window_height, int image_widt
 	_with_bbox = false;
 	_with_bbox_projection = true;
 	_verbose = false;
+	_bbox = NULL;
+	_with_symmetry = false;
+	_with_lod = false;
+	_lod_max_error = 0.5f;
+	_scene_instances = 3;
+	_scene_radius = 0.0f;
+	_scene_rng.seed(1);
+	_with_visibility = false;
+	_depth_program = -1;
+	_depth_proj_location = -1;
+	_depth_view_location = -1;
+	_depth_model_location = -1;
+	_depth_offset_location = -1;
+	_depth_position_location = -1;
+	_last_visible = -1.0f;
 
 	_projectionMatrix = glm::perspective(1.2f, (float)800 / (float)600, 0.1f, 100.f);
 	_projectionMatrix = glm::perspective( glm::radians(40.0f), (float)480 / (float)480, 0.1f, 100.f);
@@ -62,6 +81,7 @@ ModelRenderer::ModelRenderer(int window_width, int window_height, int image_widt
 	_data_rgb = (unsigned char*)malloc(_image_width * _image_height * 3 * sizeof(int));
 	_data_depth = (unsigned char*)malloc(_image_width * _image_height * 1 * sizeof(float));
 	_data_normals = (unsigned char*)malloc(_image_width * _image_height * 3 * sizeof(float));
+	_data_ids = (unsigned char*)malloc(_image_width * _image_height * 1 * sizeof(unsigned short));
 
 
 	_writer = new ImageWriter();
@@ -76,9 +96,18 @@ ModelRenderer::~ModelRenderer()
 	free(_data_rgb);
 	free(_data_depth);
 	free(_data_normals);
+	free(_data_ids);
 
 	delete _writer;
 	delete _projection;
+
+	for (auto& s : _scene) {
+		delete s.model;
+		delete s.model_normals;
+	}
+
+	if (_queries.size() > 0)
+		glDeleteQueries((GLsizei)_queries.size(), _queries.data());
 }
 
 
@@ -91,6 +120,7 @@ Set the model to render
 bool ModelRenderer::setModel(string path_and_file)
 {
 	if (path_and_file.empty()) return false;
+	_model_file = path_and_file;
 
 //#define _DEVELOP
 #ifdef _DEVELOP
@@ -108,6 +138,10 @@ bool ModelRenderer::setModel(string path_and_file)
 	//_light1.apply(program);
 	_mat0.apply(program);
 
+	// shaders without the id output get the mask from the color image
+	_with_ids = glGetFragDataLocation(program, "out_ID") >= 0;
+	_id_location = glGetUniformLocation(program, "object_id");
+
 	//-----------------------
 	// create a secodn object to render only normal vectors
 	// load shader
@@ -118,6 +152,7 @@ bool ModelRenderer::setModel(string path_and_file)
 #endif
 	_obj_model_normals = new cs557::OBJModel();
 	_obj_model_normals->create(path_and_file, program_normals);
+	cs557::OBJParser::Clear(); // both models have their buffers
 
 	_light0.apply(program_normals);
 	//_light1.apply(program_normals);
@@ -139,6 +174,7 @@ Load the model that needs to be rendered. This model uses brdf material.
 bool ModelRenderer::setModel(string path_and_file, cs557::BRDFMaterial& brdf_material)
 {
 	if (path_and_file.empty()) return false;
+	_model_file = path_and_file;
 
 	// create model
 	_obj_model = new cs557::ModelBRDF();
@@ -148,6 +184,9 @@ bool ModelRenderer::setModel(string path_and_file, cs557::BRDFMaterial& brdf_mat
 	_light0.apply(_obj_model->getProgram());
 	//_light1.apply(program);
 
+	_with_ids = glGetFragDataLocation(_obj_model->getProgram(), "out_ID") >= 0;
+	_id_location = glGetUniformLocation(_obj_model->getProgram(), "object_id");
+
 
 	//-----------------------
 	// create a secodn object to render only normal vectors
@@ -159,6 +198,7 @@ bool ModelRenderer::setModel(string path_and_file, cs557::BRDFMaterial& brdf_mat
 #endif
 	_obj_model_normals = new cs557::OBJModel();
 	_obj_model_normals->create(path_and_file, program_normals);
+	cs557::OBJParser::Clear(); // both models have their buffers
 
 	_light0.apply(program_normals);
 	//_light1.apply(program_normals);
@@ -176,6 +216,8 @@ bool ModelRenderer::drawFBO(void)
 {
 	if (_obj_model == NULL) return false;
 
+	selectLOD();
+
 	glBindFramebuffer(GL_FRAMEBUFFER, _fboHidden);
 
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -189,11 +231,30 @@ bool ModelRenderer::drawFBO(void)
 	glClearBufferfv(GL_COLOR, 0, clear_color);
 	glClearBufferfv(GL_DEPTH, 0, clear_depth);
 
+	// glClear does not clear the integer id target
+	static GLuint clear_ids[] = { 0, 0, 0, 0 };
+	glClearBufferuiv(GL_COLOR, 1, clear_ids);
+
 	// set the viewport. It must match the texture size.
 	glViewport(0, 0,  _image_width, _image_height);
 
+	// the instance ids: 1 for the model, and the next ids for the scene instances, in the order of projectInstances()
+	int id = 1;
+	glUseProgram(_obj_model->getProgram());
+	glUniform1i(_id_location, id++);
+	for (auto& s : _scene) {
+		glUseProgram(s.model->getProgram());
+		glUniform1i(s.id_location, id);
+		id += (int)s.poses.size();
+	}
+	glUseProgram(0);
+
 	_obj_model->draw(_projectionMatrix, _viewMatrix, _modelMatrix);
 
+	// the scene instances, one instanced call per model
+	for (auto& s : _scene)
+		s.model->drawInstanced(_projectionMatrix, _viewMatrix, s.poses);
+
 	//-------------------------------------------------------------------------------------
 	// get the data back 
 
@@ -204,6 +265,14 @@ bool ModelRenderer::drawFBO(void)
 	glReadBuffer(GL_DEPTH_ATTACHMENT);
 	glReadPixels(0, 0, _image_width, _image_height, GL_DEPTH_COMPONENT, GL_FLOAT, _data_depth);
 
+	if (_with_ids) {
+		// rows of 16-bit values are 2-byte aligned
+		glReadBuffer(GL_COLOR_ATTACHMENT1);
+		glPixelStorei(GL_PACK_ALIGNMENT, 2);
+		glReadPixels(0, 0, _image_width, _image_height, GL_RED_INTEGER, GL_UNSIGNED_SHORT, _data_ids);
+		glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	}
+
 	// switch back to the regular output buffer
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
@@ -220,7 +289,15 @@ bool ModelRenderer::drawFBO(void)
 	cv::Mat imaged(_image_height, _image_width, CV_32FC1, _data_depth);
 	cv::Mat dst_depth, output_depth, normalized;
 	cv::flip(imaged, dst_depth, 0);
+	_last_depth = dst_depth;
 
+	// instance id image
+	cv::Mat dst_ids;
+	if (_with_ids) {
+		cv::Mat image_ids(_image_height, _image_width, CV_16UC1, _data_ids);
+		cv::flip(image_ids, dst_ids, 0);
+	}
+	_last_ids = dst_ids;
 
 
 	//-------------------------------------------------------------------------------------
@@ -240,6 +317,8 @@ bool ModelRenderer::drawFBO(void)
 
 	_obj_model_normals->draw(_projectionMatrix, _viewMatrix, _modelMatrix);
 
+	for (auto& s : _scene)
+		s.model_normals->drawInstanced(_projectionMatrix, _viewMatrix, s.poses);
 
 	//-------------------------------------------------------------------------------------
 	// get the data back 
@@ -253,21 +332,46 @@ bool ModelRenderer::drawFBO(void)
 	cv::flip(image_normals, dst_norm, 0);
 
 
+	//-------------------------------------------------------------------------------------
+	// Occlusion queries for the visible fractions, after the readbacks. The results are read 
+	// before the images are written, the CPU work in between hides the queries. 
+	bool with_visibility = _save && _writer_enabled && _writer && _with_visibility;
+	if (with_visibility)
+		beginVisibility();
+
+
 	//-------------------------------------------------------------------------------------
 	// region of interest extraction
 	cv::Rect2f roi;
 	if (_with_roi) {
-		RoIDetect::Extract(dst, roi);
+		// two reductions of the id image instead of a scan of the color image; only the model at the origin in a scene
+		if (_with_ids && _scene.size() > 0)
+			RoIDetect::ExtractFromMask(dst_ids == 1, roi);
+		else if (_with_ids)
+			RoIDetect::ExtractFromMask(dst_ids, roi);
+		else
+			RoIDetect::Extract(dst, roi);
 	}
 
 	//-------------------------------------------------------------------------------------
 	// Extract an image mask
 	cv::Mat mask;
 	if (_with_mask) {
-		ImageMask::Extract(dst, mask);
+		// every pixel with an id belongs to an object, also black pixels
+		if (_with_ids)
+			mask = dst_ids > 0;
+		else
+			ImageMask::Extract(dst, mask);
 	}
 	
 
+	//-------------------------------------------------------------------------------------
+	// The pose, the projected bounding box, and the control points of each instance of the scene. 
+	std::vector<ImageWriter::IWInstance> instances;
+	if (_scene.size() > 0) {
+		projectInstances(instances);
+	}
+
 	//-------------------------------------------------------------------------------------
 	// Project the bounding box corner points and the center of the bounding box. 
 	if (_with_bbox_projection) {
@@ -307,6 +411,13 @@ bool ModelRenderer::drawFBO(void)
 
 	
 
+	std::vector<float> visible;
+	_last_visible = -1.0f;
+	if (with_visibility) {
+		collectVisibility(visible);
+		_last_visible = visible[0];
+	}
+
 	if (_save && _writer_enabled && _writer){
 
 		ImageWriter::IWData odata;
@@ -321,13 +432,26 @@ bool ModelRenderer::drawFBO(void)
 		odata.pose = _viewMatrix;
 		odata.roi = roi;
 		odata.control_points = _projected_points;
+		odata.instances = instances;
+		odata.visible = _last_visible;
+		for (size_t i = 0; i < instances.size() && i < visible.size(); i++)
+			odata.instances[i].visible = visible[i];
+		if (_with_ids && instances.size() > 0)
+			odata.ids = &dst_ids;
+
+		// the color image roi includes all instances, thus, use the projected bounding box of the model
+		if (_with_roi && !_with_ids && instances.size() > 0)
+			odata.roi = instances[0].roi;
 
 		_writer->write(odata);
 
-		// this writes model information. Currently, the only info is the bounding box corner points. 
+		// this writes model information, the bounding box corner points and the symmetry group if analyzed. 
 		if(_output_file_id == 0){
 			std::vector<glm::vec3> corners =  _bbox->getCorners();
-			_writer->writeModelFile(corners);
+			if (_with_symmetry)
+				_writer->writeModelFile(corners, _symmetry);
+			else
+				_writer->writeModelFile(corners);
 		}
 
 		//_writer->write(_output_file_id, dst, dst_norm, dst_depth, glm::inverse(_viewMatrix));
@@ -350,6 +474,8 @@ bool ModelRenderer::draw(void)
 
 
 	_obj_model->draw(_projectionMatrix, _viewMatrix, _modelMatrix);
+	for (auto& s : _scene)
+		s.model->drawInstanced(_projectionMatrix, _viewMatrix, s.poses);
     _coordinateSystem.draw(_projectionMatrix, _viewMatrix, _modelMatrixCoordSystem);
 
 	if(_with_bbox)
@@ -377,8 +503,15 @@ bool  ModelRenderer::draw_and_save(void)
 		applyRandomColor();
 	}
 
+	// new poses for the scene instances
+	placeInstances();
+
 
 	draw();
+
+	// draw() without this function shows the model but does not save it
+	_save = false;
+	return true;
 }
 
 
@@ -389,7 +522,7 @@ void  ModelRenderer::CreatePrerendererScene(void)
 {
 
 	// This function is part of RenderToTexture.h
-	CreateRenderToTexture(_image_width, _image_height, _fboHidden, _color_texture_idx, _depth_texture_idx);
+	CreateRenderToTextureWithID(_image_width, _image_height, _fboHidden, _color_texture_idx, _depth_texture_idx, _id_texture_idx);
 
 	// Reset to the regular buffer
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -466,6 +599,11 @@ void ModelRenderer::setCameraMatrix(glm::mat4 viewmatrix)
 	_light0.pos = glm::vec3(inv[3][0], inv[3][1], inv[3][2]);
 	_light0.apply(_obj_model->getProgram());
 	_light0.apply(_obj_model_normals->getProgram());
+
+	for (auto& s : _scene) {
+		_light0.apply(s.model->getProgram());
+		_light0.apply(s.model_normals->getProgram());
+	}
 }
 
 /*
@@ -556,7 +694,20 @@ the setting is set to random color.
 */
 void ModelRenderer::applyRandomColor(void)
 {
-	
+	if(_obj_model!= NULL)
+		_obj_model->setMaterial(randomMaterial());
+
+	// each scene model gets its own color
+	for (auto& s : _scene)
+		s.model->setMaterial(randomMaterial());
+}
+
+
+/*
+Return a material with a random color. 
+*/
+cs557::Material ModelRenderer::randomMaterial(void)
+{
 	// fetch a random color component.
 	cs557::Material mat;
 	std::vector<float> rgb = _rand_col.getRGB();
@@ -580,9 +731,8 @@ void ModelRenderer::applyRandomColor(void)
 	mat.specular_s = 10.0;
 
 //	std::cout << "[INFO] - Random color r " << rgb[0] << "\tg " << rgb[1] << "\tv " << rgb[2]  << std::endl;
-	
-	if(_obj_model!= NULL)
-		_obj_model->setMaterial(mat);
+
+	return mat;
 }
 
 
@@ -596,6 +746,35 @@ void ModelRenderer::withBBoxProjection(bool enable)
 }
 
 
+/*
+Enable or disable the symmetry reduction. If enabled, the function analyzes 
+the rotational symmetry of the model. 
+@param enable - true enables the symmetry reduction. 
+@return - false, if no model is loaded. 
+*/
+bool ModelRenderer::setSymmetryReduction(bool enable)
+{
+	_with_symmetry = enable;
+	_symmetry = ModelSymmetry::Group();
+	if (!enable) return true;
+
+	if (_obj_model == NULL) {
+		cout << "[ERROR] - ModelRenderer: load a model before enabling the symmetry reduction." << endl;
+		_with_symmetry = false;
+		return false;
+	}
+
+	_symmetry = ModelSymmetry::Analyze(_obj_model->getVertices(), _obj_model->getIndices());
+
+	cout << "[INFO] - Model symmetry: " << ModelSymmetry::ToString(_symmetry);
+	if (_symmetry.type != ModelSymmetry::NONE)
+		cout << " about axis (" << _symmetry.axis.x << ", " << _symmetry.axis.y << ", " << _symmetry.axis.z << ")";
+	cout << "." << endl;
+
+	return true;
+}
+
+
 /*
 Project the bounding box manually. 
 This is a debug function to verify that the bounding box works. 
@@ -604,4 +783,440 @@ bool ModelRenderer::projectBBox(void)
 {
 	projectBBoxPoints();
 	return true;
-}
\ No newline at end of file
+}
+
+
+/*
+Return the fraction of the projected bounding box that is inside the image. 
+@param viewmatrix - a 4x4 view matrix to test. 
+@return - the visible fraction from 0 to 1. 
+*/
+float ModelRenderer::visibleFraction(glm::mat4 viewmatrix)
+{
+	if (_bbox == NULL) return 0.0f;
+
+	std::vector<glm::vec3> corners = _bbox->getCorners();
+	if (corners.size() == 0) return 0.0f;
+
+	glm::mat4 m = _projectionMatrix * viewmatrix * _modelMatrix;
+
+	// 2D bounding rectangle of the corners in normalized device coordinates
+	glm::vec2 min_p(FLT_MAX, FLT_MAX);
+	glm::vec2 max_p(-FLT_MAX, -FLT_MAX);
+	for (const glm::vec3& c : corners) {
+		glm::vec4 p = m * glm::vec4(c, 1.0f);
+		if (p.w <= 0.0f) return 0.0f; // behind the camera
+
+		glm::vec2 ndc(p.x / p.w, p.y / p.w);
+		min_p = glm::min(min_p, ndc);
+		max_p = glm::max(max_p, ndc);
+	}
+
+	float area = (max_p.x - min_p.x) * (max_p.y - min_p.y);
+	if (area <= 0.0f) return 0.0f;
+
+	// intersection with the image, [-1, 1] x [-1, 1]
+	float w = (std::min)(max_p.x, 1.0f) - (std::max)(min_p.x, -1.0f);
+	float h = (std::min)(max_p.y, 1.0f) - (std::max)(min_p.y, -1.0f);
+	if (w <= 0.0f || h <= 0.0f) return 0.0f;
+
+	return (w * h) / area;
+}
+
+
+/*
+Enable or disable the level of detail selection. 
+@param enable - true enables the selection. 
+@param max_pixel_error - the max. projected error in pixels. 
+*/
+void ModelRenderer::setLOD(bool enable, float max_pixel_error)
+{
+	_with_lod = enable;
+	_lod_max_error = max_pixel_error;
+
+	if (enable && _obj_model != NULL) {
+		cout << "[INFO] - Model levels of detail: " << _obj_model->getNumLODs() << ", max. error " << _lod_max_error << " px." << endl;
+	}
+}
+
+
+/*
+Select the level of detail of the models for the current view and projection matrix.
+*/
+void ModelRenderer::selectLOD(void)
+{
+	int level = 0;
+
+	if (_with_lod && _bbox != NULL) {
+
+		// the bounding box corner closest to the camera has the largest projected error
+		glm::mat4 mv = _viewMatrix * _modelMatrix;
+		float min_depth = FLT_MAX;
+		for (const glm::vec3& c : _bbox->getCorners()) {
+			glm::vec4 p = mv * glm::vec4(c, 1.0f);
+			min_depth = (std::min)(min_depth, -p.z);
+		}
+
+		// all corners in front of the camera
+		if (min_depth > 0.0f && min_depth < FLT_MAX) {
+			float focal = (std::max)(_projectionMatrix[0][0] * _image_width, _projectionMatrix[1][1] * _image_height) / 2.0f;
+			float scale = (std::max)(glm::length(glm::vec3(_modelMatrix[0])), (std::max)(glm::length(glm::vec3(_modelMatrix[1])), glm::length(glm::vec3(_modelMatrix[2]))));
+			float pixels_per_unit = focal * scale / min_depth;
+
+			for (int i = 1; i < _obj_model->getNumLODs(); i++) {
+				if (_obj_model->getLODError(i) * pixels_per_unit > _lod_max_error) break;
+				level = i;
+			}
+		}
+	}
+
+	_obj_model->setLOD(level);
+	if (_obj_model_normals != NULL) _obj_model_normals->setLOD(level);
+}
+
+
+/*
+Add a model to the scene. 
+@param path_and_file - string containg the relative or absolute path to the model.
+@return - false, if the model of setModel() is not loaded yet. 
+*/
+bool ModelRenderer::addSceneModel(string path_and_file)
+{
+	if (path_and_file.empty()) return false;
+
+	if (_obj_model == NULL) {
+		cout << "[ERROR] - ModelRenderer: load a model before adding scene models." << endl;
+		return false;
+	}
+
+	SceneModel s;
+	s.file = path_and_file;
+
+	// each model needs its own programs since the texture settings are program state
+#ifdef _DEVELOP
+	int program = cs557::LoadAndCreateShaderProgram("./shaders/image_renderer.vs", "./shaders/image_renderer.fs");
+	int program_normals = cs557::LoadAndCreateShaderProgram("./shaders/normal_renderer.vs", "./shaders/normal_renderer.fs");
+#else
+	int program = cs557::CreateShaderProgram(glslshader::image_renderer_vs, glslshader::image_renderer_fs);
+	int program_normals = cs557::CreateShaderProgram(glslshader::normal_renderer_vs, glslshader::normal_renderer_fs);
+#endif
+
+	s.model = new cs557::OBJModel();
+	s.model->create(path_and_file, program);
+	s.model->setTextureParam(cs557::TextureMode::REPLACE);
+
+	_light0.apply(program);
+	_mat0.apply(program);
+	s.id_location = glGetUniformLocation(program, "object_id");
+
+	s.model_normals = new cs557::OBJModel();
+	s.model_normals->create(path_and_file, program_normals);
+	cs557::OBJParser::Clear(); // both models have their buffers
+
+	_light0.apply(program_normals);
+
+	// the vertices are centered at the bounding box center
+	s.radius = glm::length(s.model->getBoundingBox()) / 2.0f;
+
+	_scene.push_back(s);
+
+	if (_verbose) {
+		cout << "[INFO] - Scene model " << path_and_file << " with " << _scene_instances << " instances, bounding sphere radius " << s.radius << "." << endl;
+	}
+
+	return true;
+}
+
+
+/*
+Set the scene parameters. 
+@param instances - the number of instances per scene model and image. 
+@param radius - the instance centers are placed in a sphere with this radius around the origin. 
+*/
+void ModelRenderer::setSceneParams(int instances, float radius)
+{
+	_scene_instances = (std::max)(0, instances);
+	_scene_radius = (std::max)(0.0f, radius);
+}
+
+
+/*
+Enable or disable the visibility labels.
+@param enable - true measures the visible fractions. 
+*/
+void ModelRenderer::setVisibilityLabels(bool enable)
+{
+	_with_visibility = enable;
+}
+
+
+/*
+Place the instances of the scene models at random poses. 
+*/
+void ModelRenderer::placeInstances(void)
+{
+	if (_scene.size() == 0 || _obj_model == NULL) return;
+
+	// bounding spheres of the placed objects, center and radius, starting with the model
+	std::vector<glm::vec4> spheres;
+	float model_radius = glm::length(_obj_model->getBoundingBox()) / 2.0f;
+	spheres.push_back(glm::vec4(glm::vec3(_modelMatrix[3]), model_radius));
+
+	float radius = _scene_radius > 0.0f ? _scene_radius : 3.0f * model_radius;
+
+	std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+	const int max_attempts = 100;
+	int dropped = 0;
+
+	for (auto& s : _scene) {
+		s.poses.clear();
+
+		for (int i = 0; i < _scene_instances; i++) {
+			bool placed = false;
+
+			for (int a = 0; a < max_attempts && !placed; a++) {
+
+				// a uniformly distributed position in the sphere
+				glm::vec3 p(2.0f * uniform(_scene_rng) - 1.0f, 2.0f * uniform(_scene_rng) - 1.0f, 2.0f * uniform(_scene_rng) - 1.0f);
+				if (glm::length(p) > 1.0f) continue;
+				p *= radius;
+
+				bool intersects = false;
+				for (const glm::vec4& c : spheres) {
+					if (glm::length(glm::vec3(c) - p) < c.w + s.radius) {
+						intersects = true;
+						break;
+					}
+				}
+				if (intersects) continue;
+
+				glm::quat q = PoseSampler::UniformRotation(uniform(_scene_rng), uniform(_scene_rng), uniform(_scene_rng));
+				s.poses.push_back(glm::translate(glm::mat4(1.0f), p) * glm::toMat4(q));
+				spheres.push_back(glm::vec4(p, s.radius));
+				placed = true;
+			}
+
+			if (!placed) dropped++;
+		}
+	}
+
+	if (dropped > 0 && _verbose) {
+		cout << "[WARNING] - ModelRenderer: " << dropped << " scene instances do not fit into the scene radius " << radius << "." << endl;
+	}
+}
+
+
+/*
+Project the bounding box of the model and of all scene instances. 
+*/
+void ModelRenderer::projectInstances(std::vector<ImageWriter::IWInstance>& instances)
+{
+	instances.clear();
+
+	_projection->setProjectionMatrix(_projectionMatrix);
+	_projection->setViewMatrix(_viewMatrix);
+
+	auto add = [&](const string& file, glm::vec3 boundingbox, const glm::mat4& m) {
+		ImageWriter::IWInstance inst;
+		inst.id = (int)instances.size();
+		inst.model = file;
+		inst.pose = _viewMatrix * m;
+
+		// the corners in the order of cs557::BBox, and the center
+		glm::vec3 d = boundingbox / 2.0f;
+		std::vector<glm::vec3> points = {
+			glm::vec3( d.x, -d.y, -d.z), glm::vec3( d.x,  d.y, -d.z), glm::vec3( d.x,  d.y,  d.z), glm::vec3( d.x, -d.y,  d.z),
+			glm::vec3(-d.x, -d.y, -d.z), glm::vec3(-d.x,  d.y, -d.z), glm::vec3(-d.x,  d.y,  d.z), glm::vec3(-d.x, -d.y,  d.z),
+			glm::vec3(0.0f, 0.0f, 0.0f) };
+		_projection->projectPoints(points, m, inst.control_points);
+
+		// the roi is the 2D bounding rectangle of the corners, clipped to the image; empty if a corner is behind the camera
+		glm::mat4 pvm = _projectionMatrix * _viewMatrix * m;
+		glm::vec2 min_p(FLT_MAX, FLT_MAX);
+		glm::vec2 max_p(-FLT_MAX, -FLT_MAX);
+		bool valid = true;
+		for (int i = 0; i < 8 && valid; i++) {
+			glm::vec4 p = pvm * glm::vec4(points[i], 1.0f);
+			if (p.w <= 0.0f) {
+				valid = false;
+				break;
+			}
+			glm::vec2 uv(((p.x / p.w) * _image_width + _image_width) / 2.0f, ((-p.y / p.w) * _image_height + _image_height) / 2.0f);
+			min_p = glm::min(min_p, uv);
+			max_p = glm::max(max_p, uv);
+		}
+		if (valid) {
+			min_p = glm::max(min_p, glm::vec2(0.0f, 0.0f));
+			max_p = glm::min(max_p, glm::vec2((float)_image_width, (float)_image_height));
+			if (max_p.x > min_p.x && max_p.y > min_p.y)
+				inst.roi = cv::Rect2f(min_p.x, min_p.y, max_p.x - min_p.x, max_p.y - min_p.y);
+		}
+
+		instances.push_back(inst);
+	};
+
+	add(_model_file, _obj_model->getBoundingBox(), _modelMatrix);
+
+	for (auto& s : _scene) {
+		for (auto& m : s.poses)
+			add(s.file, s.model->getBoundingBox(), m);
+	}
+}
+
+
+/*
+Issue the occlusion queries for the visible fraction of the model and of each scene instance.
+*/
+void ModelRenderer::beginVisibility(void)
+{
+	// a program that only writes the depth, created at the first use
+	if (_depth_program < 0) {
+#ifdef _DEVELOP
+		_depth_program = cs557::LoadAndCreateShaderProgram("./shaders/depth_only.vs", "./shaders/depth_only.fs");
+#else
+		_depth_program = cs557::CreateShaderProgram(glslshader::depth_only_vs, glslshader::depth_only_fs);
+#endif
+		_depth_proj_location = glGetUniformLocation(_depth_program, "projectionMatrix");
+		_depth_view_location = glGetUniformLocation(_depth_program, "viewMatrix");
+		_depth_model_location = glGetUniformLocation(_depth_program, "modelMatrix");
+		_depth_offset_location = glGetUniformLocation(_depth_program, "depth_offset");
+		_depth_position_location = glGetAttribLocation(_depth_program, "in_Position");
+	}
+
+	// the objects in the order of projectInstances()
+	std::vector<std::pair<cs557::OBJModel*, glm::mat4> > objects;
+	objects.push_back(std::make_pair(_obj_model, _modelMatrix));
+	for (auto& s : _scene) {
+		for (auto& m : s.poses)
+			objects.push_back(std::make_pair(s.model, m));
+	}
+
+	int N = (int)objects.size();
+	if (_queries.size() < (size_t)(2 * N)) {
+		size_t n = _queries.size();
+		_queries.resize(2 * N);
+		glGenQueries((GLsizei)(2 * N - n), &_queries[n]);
+	}
+	_query_area.assign(N, 0.0f);
+
+	// no color and id writes; only the samples count
+	glUseProgram(_depth_program);
+	glUniformMatrix4fv(_depth_view_location, 1, GL_FALSE, &_viewMatrix[0][0]);
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	glViewport(0, 0, _image_width, _image_height);
+
+	//-------------------------------------------------------------------------------------
+	// Visible samples: each object again, tested against the depth of the complete image. 
+	// GL_LEQUAL passes the visible fragments of the object. The offset covers the rounding 
+	// differences to the depth of image_renderer_fs. 
+	glBindFramebuffer(GL_FRAMEBUFFER, _fboHidden);
+	glDepthMask(GL_FALSE);
+	glDepthFunc(GL_LEQUAL);
+	glUniform1f(_depth_offset_location, 1.0e-5f);
+	glUniformMatrix4fv(_depth_proj_location, 1, GL_FALSE, &_projectionMatrix[0][0]);
+
+	for (int i = 0; i < N; i++) {
+		glUniformMatrix4fv(_depth_model_location, 1, GL_FALSE, &objects[i].second[0][0]);
+		glBeginQuery(GL_SAMPLES_PASSED, _queries[i]);
+		objects[i].first->drawGeometry(_depth_position_location);
+		glEndQuery(GL_SAMPLES_PASSED);
+	}
+
+	//-------------------------------------------------------------------------------------
+	// All samples: each object alone. A crop matrix scales the projected bounding box to the 
+	// full viewport, so that parts outside of the image are counted too. The count is 
+	// scaled back by the area factor of the crop. A depth pass comes first, so that 
+	// the counting pass passes one fragment per pixel. 
+	glBindFramebuffer(GL_FRAMEBUFFER, _fboHiddenNormals);
+	glUniform1f(_depth_offset_location, 0.0f);
+
+	static GLfloat clear_depth[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+	for (int i = 0; i < N; i++) {
+		glm::vec3 d = objects[i].first->getBoundingBox() / 2.0f;
+		glm::mat4 pvm = _projectionMatrix * _viewMatrix * objects[i].second;
+
+		glm::vec2 min_p(FLT_MAX, FLT_MAX);
+		glm::vec2 max_p(-FLT_MAX, -FLT_MAX);
+		bool valid = true;
+		for (int c = 0; c < 8 && valid; c++) {
+			glm::vec4 p = pvm * glm::vec4((c & 1) ? d.x : -d.x, (c & 2) ? d.y : -d.y, (c & 4) ? d.z : -d.z, 1.0f);
+			if (p.w <= 0.0f) {
+				valid = false;
+				break;
+			}
+			min_p = glm::min(min_p, glm::vec2(p) / p.w);
+			max_p = glm::max(max_p, glm::vec2(p) / p.w);
+		}
+
+		// a corner behind the camera: the near plane truncates the object, count the pixels in the image
+		glm::mat4 crop(1.0f);
+		_query_area[i] = 1.0f;
+		if (valid) {
+			if (max_p.x <= min_p.x || max_p.y <= min_p.y) {
+				_query_area[i] = 0.0f;
+				continue;
+			}
+			float sx = 2.0f / (max_p.x - min_p.x);
+			float sy = 2.0f / (max_p.y - min_p.y);
+			// x' = sx * (x - cx * w), in clip coordinates
+			crop[0][0] = sx;
+			crop[1][1] = sy;
+			crop[3][0] = -sx * (max_p.x + min_p.x) / 2.0f;
+			crop[3][1] = -sy * (max_p.y + min_p.y) / 2.0f;
+			_query_area[i] = sx * sy;
+		}
+
+		glm::mat4 proj = crop * _projectionMatrix;
+		glUniformMatrix4fv(_depth_proj_location, 1, GL_FALSE, &proj[0][0]);
+		glUniformMatrix4fv(_depth_model_location, 1, GL_FALSE, &objects[i].second[0][0]);
+
+		glClearBufferfv(GL_DEPTH, 0, clear_depth);
+		glDepthMask(GL_TRUE);
+		glDepthFunc(GL_LESS);
+		objects[i].first->drawGeometry(_depth_position_location);
+
+		glDepthMask(GL_FALSE);
+		glDepthFunc(GL_LEQUAL);
+		glBeginQuery(GL_SAMPLES_PASSED, _queries[N + i]);
+		objects[i].first->drawGeometry(_depth_position_location);
+		glEndQuery(GL_SAMPLES_PASSED);
+	}
+
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glDepthMask(GL_TRUE);
+	glDepthFunc(GL_LESS);
+	glUseProgram(0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+
+/*
+Read the results of beginVisibility().
+*/
+void ModelRenderer::collectVisibility(std::vector<float>& visible)
+{
+	int N = (int)_query_area.size();
+	visible.assign(N, 0.0f);
+
+	// the queries finish in the order they were issued; GL_QUERY_RESULT only waits if the last one is still running
+	GLuint available = GL_TRUE;
+	int last = N - 1;
+	while (last >= 0 && _query_area[last] <= 0.0f) last--;
+	glGetQueryObjectuiv(last >= 0 ? _queries[N + last] : _queries[N - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available && _verbose) {
+		cout << "[INFO] - ModelRenderer: waiting for the visibility queries." << endl;
+	}
+
+	for (int i = 0; i < N; i++) {
+		if (_query_area[i] <= 0.0f) continue;
+
+		GLuint samples_visible = 0;
+		GLuint samples_all = 0;
+		glGetQueryObjectuiv(_queries[i], GL_QUERY_RESULT, &samples_visible);
+		glGetQueryObjectuiv(_queries[N + i], GL_QUERY_RESULT, &samples_all);
+
+		float all = (float)samples_all / _query_area[i];
+		visible[i] = all > 0.0f ? (std::min)(1.0f, (float)samples_visible / all) : 0.0f;
+	}
+}
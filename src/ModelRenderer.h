@@ -15,6 +15,7 @@ Features:
 - Renders an RGB image of the model into a fbo color attachment (RGB8, CV_8UC3)
 - Renders a normal map of the model into an fbo color attachment as float (GL_RGBA32F_ARB, CV_32FC1)
 - Renders a depth map (linearized) into a fbo depth attachment as float (GL_DEPTH_COMPONENT32, CV_32FC1).
+- Renders an instance id map into a fbo color attachment as 16-bit unsigned integer (GL_R16UI, CV_16UC1), 0 is the background.
 - Writes the images to files (.png)
 
 Usage:
@@ -62,12 +63,23 @@ June 6, 2020, RR
 - Added a function to project bounding box corner points and to store those to a file.
 June 9, 2020, RR
 - Fixed a bug in the bounding box projection api. 
+Oct 19, 2026, RR
+- Added visibleFraction() to test a view matrix with the projected bounding box before rendering. 
+- Added a symmetry analysis of the model, see setSymmetryReduction(). The symmetry group is written to the model info file.
+- Keeps the depth image of the last rendering for derived classes, _last_depth.
+- Added a level of detail selection by the projected size of the model, see setLOD().
+- Added a scene mode that renders instances of further models at random, non-intersecting poses around the model, 
+  see addSceneModel(). All instances of a model are drawn with one instanced call. 
+- Renders an instance id image into a second fbo target. The mask comes from the ids, so dark object pixels are part of it. 
+- Measures the visible fraction of the model and of each scene instance with occlusion queries, see setVisibilityLabels(). 
 */
 
 // stl
 #include <iostream>
 #include <vector>
 #include <string>
+#include <cfloat>
+#include <random>
 
 // opencv
 #include <opencv2/opencv.hpp>
@@ -97,6 +109,8 @@ June 9, 2020, RR
 #include "MaterialReaderWriter.h"  // to read material data from a fle. 
 #include "ModelBBox.h"	// boudning box
 #include "PointProjection.h" // point projection;
+#include "ModelSymmetry.h" // rotational symmetry of the model
+#include "PoseSampler.h" // uniform random rotations
 
 using namespace std;
 
@@ -202,6 +216,60 @@ public:
 	*/
 	void withBBoxProjection(bool enable);
 
+
+	/*
+	Enable or disable the symmetry reduction. If enabled, the function analyzes 
+	the rotational symmetry of the model. Renderers with a fixed set of views 
+	use it to render only one view per set of equivalent views.
+	Call it after setModel().
+	@param enable - true enables the symmetry reduction. 
+	@return - false, if no model is loaded. 
+	*/
+	bool setSymmetryReduction(bool enable);
+
+
+	/*
+	Enable or disable the level of detail selection. If enabled, the renderer draws the coarsest 
+	level of detail of the model whose geometric error, projected into the image, stays below max_pixel_error. 
+	The projection uses the bounding box corner closest to the camera. 
+	The images are not exact anymore, keep it disabled for ground truth data. 
+	@param enable - true enables the selection. It is disabled by default. 
+	@param max_pixel_error - the max. projected error in pixels. 
+	*/
+	void setLOD(bool enable, float max_pixel_error = 0.5f);
+
+
+	/*
+	Add a model to the scene. If the scene has models, each saved image shows the model of setModel() 
+	at the origin together with instances of all scene models. The instances get new random poses 
+	with non-intersecting bounding spheres for each image. The pose, roi, and control points of every 
+	instance are written to render_instances.csv. A file can be added more than once. 
+	Call it after setModel().
+	@param path_and_file - string containg the relative or absolute path to the model.
+	@return - false, if the model of setModel() is not loaded yet. 
+	*/
+	bool addSceneModel(string path_and_file);
+
+
+	/*
+	Set the scene parameters. 
+	@param instances - the number of instances per scene model and image. 
+	@param radius - the instance centers are placed in a sphere with this radius around the origin. 
+					0 uses three times the bounding sphere radius of the model. 
+	*/
+	void setSceneParams(int instances, float radius = 0.0f);
+
+
+	/*
+	Enable or disable the visibility labels. The renderer counts the visible pixels of the model and of each 
+	scene instance with occlusion queries and divides them by the pixels of the object rendered alone, 
+	unoccluded and not truncated by the image border. The fractions are written into the manifests, 
+	all images are saved; filter them with the column 'visible'. 
+	It is disabled by default. 
+	@param enable - true measures the visible fractions. 
+	*/
+	void setVisibilityLabels(bool enable);
+
 protected:
 
 	/*
@@ -221,6 +289,16 @@ protected:
 	This is a debug function to verify that the bounding box works. 
 	*/
 	bool projectBBox(void);
+
+
+	/*
+	Return the fraction of the projected bounding box that is inside the image. 
+	The function projects the 8 bounding box corners with the given view matrix and 
+	intersects their 2D bounding rectangle with the image. It does not render anything. 
+	@param viewmatrix - a 4x4 view matrix to test. 
+	@return - the visible fraction from 0 to 1. 0 if a corner is behind the camera or no model is loaded. 
+	*/
+	float visibleFraction(glm::mat4 viewmatrix);
 	
 
 private:
@@ -232,6 +310,40 @@ private:
 	bool drawFBO(void);
 
 
+	/*
+	Select the level of detail of the models for the current view and projection matrix.
+	*/
+	void selectLOD(void);
+
+
+	/*
+	Place the instances of the scene models at random poses. An instance whose bounding sphere
+	intersects the sphere of the model or of another instance is sampled again, and dropped after some attempts. 
+	*/
+	void placeInstances(void);
+
+
+	/*
+	Project the bounding box of the model and of all scene instances and return them as instances for the writer.
+	*/
+	void projectInstances(std::vector<ImageWriter::IWInstance>& instances);
+
+
+	/*
+	Issue the occlusion queries for the visible fraction of the model and of each scene instance, in the order of projectInstances(). 
+	The passes only write depth. Call it after the readbacks; it tests against the depth buffer of the color rendering 
+	and uses the normals fbo as scratch buffer.
+	*/
+	void beginVisibility(void);
+
+
+	/*
+	Read the results of beginVisibility(). Call it as late as possible, then the results are usually available. 
+	@param visible - location for the fractions from 0 to 1.
+	*/
+	void collectVisibility(std::vector<float>& visible);
+
+
 	/*
 	Project the boundinx box corner points and the bounding box centroid. 
 	*/
@@ -256,6 +368,12 @@ private:
 	void applyRandomColor(void);
 
 
+	/*
+	Return a material with a random color. 
+	*/
+	cs557::Material randomMaterial(void);
+
+
 	// members
 
 	// the model to render
@@ -280,6 +398,7 @@ private:
 	unsigned int				_fboHidden;
 	GLuint					_color_texture_idx;
 	GLuint					_depth_texture_idx;
+	GLuint					_id_texture_idx;
 
 	// to render normal vectors
 	unsigned int				_fboHiddenNormals;
@@ -299,6 +418,11 @@ private:
 	unsigned char*			_data_rgb;
 	unsigned char*			_data_depth;
 	unsigned char*			_data_normals;
+	unsigned char*			_data_ids;
+
+	// the program of the model writes instance ids
+	bool					_with_ids;
+	int						_id_location; // object_id of the model program
 
 	// projected control points.
 	// if the bounding box is projected, the vector contains 8 corner points
@@ -337,7 +461,61 @@ private:
 	// point projection
 	PointProjection*		_projection;
 
+	// level of detail selection
+	bool					_with_lod;
+	float					_lod_max_error; // in pixels
+
+	// a model of the scene mode and the poses of its instances in the current image
+	typedef struct _SceneModel {
+		cs557::OBJModel*			model;
+		cs557::OBJModel*			model_normals;
+		string					file;
+		float					radius; // bounding sphere radius
+		std::vector<glm::mat4>	poses; // model matrices of the instances
+		int						id_location; // object_id of the model program
+
+		_SceneModel()
+		{
+			model = NULL;
+			model_normals = NULL;
+			radius = 0.0f;
+			id_location = -1;
+		}
+	}SceneModel;
+
+	std::vector<SceneModel>	_scene;
+	int						_scene_instances; // instances per scene model
+	float					_scene_radius; // 0 is relative to the model size
+	std::mt19937				_scene_rng;
+	string					_model_file;
+
+	// occlusion queries, visible and unoccluded samples per object
+	bool					_with_visibility;
+	std::vector<GLuint>		_queries;
+	std::vector<float>		_query_area; // area factor of the crop per object, 0 if not measured
+
+	// depth-only program for the queries
+	int						_depth_program;
+	int						_depth_proj_location;
+	int						_depth_view_location;
+	int						_depth_model_location;
+	int						_depth_offset_location;
+	int						_depth_position_location;
+
 protected:
 
 	bool						_verbose;
+
+	// rotational symmetry of the model
+	ModelSymmetry::Group		_symmetry;
+	bool					_with_symmetry;
+
+	// the depth image of the last rendering, CV_32FC1, 1.0 is background
+	cv::Mat					_last_depth;
+
+	// the instance id image of the last rendering, CV_16UC1, 0 is background, 1 the model. Empty without ids. 
+	cv::Mat					_last_ids;
+
+	// the visible fraction of the model in the last rendering, -1 if not measured
+	float					_last_visible;
 };
\ No newline at end of file
@@ -0,0 +1,310 @@
+#include "ModelSymmetry.h"
+
+
+namespace ModelSymmetryConst
+{
+	const float pi = 3.14159265f;
+	const int num_surface_samples = 20000;
+	const int num_test_samples = 2000;
+}
+
+
+/*
+Detect the rotational symmetry of a triangle mesh.
+*/
+//static
+ModelSymmetry::Group ModelSymmetry::Analyze(const std::vector<glm::vec3>& vertices, const std::vector<int>& indices, int max_order, float tolerance,
+	const glm::vec3& center)
+{
+	Group group;
+	if (vertices.size() < 3) return group;
+
+	// two independent sample sets: the surface and the test samples
+	std::vector<glm::vec3> surface_points;
+	std::vector<glm::vec3> samples;
+	SampleSurface(vertices, indices, ModelSymmetryConst::num_surface_samples, 1, surface_points);
+	SampleSurface(vertices, indices, ModelSymmetryConst::num_test_samples, 2, samples);
+	if (surface_points.size() < 3 || samples.size() < 3) return group;
+
+	PointKDTree surface;
+	surface.build(surface_points);
+
+	// the distance of unrotated samples is the sampling noise
+	float max_distance = tolerance * Distance(surface, surface_points, samples);
+
+	// the symmetry axes run through the look-at point, not through the surface centroid. 
+	// The views of a model that is off-center move on the image when the camera rotates about the centroid.
+	group.center = center;
+
+	// candidate axes: the model axes and the principal axes about the centroid
+	glm::vec3 centroid(0.0f, 0.0f, 0.0f);
+	for (auto p : surface_points) centroid = centroid + p;
+	centroid = centroid / float(surface_points.size());
+
+	cv::Mat cov = cv::Mat::zeros(3, 3, CV_32F);
+	for (auto p : surface_points) {
+		glm::vec3 d = p - centroid;
+		for (int r = 0; r < 3; r++)
+			for (int c = 0; c < 3; c++)
+				cov.at<float>(r, c) += d[r] * d[c];
+	}
+	cv::Mat eigenvalues, eigenvectors;
+	cv::eigen(cov, eigenvalues, eigenvectors);
+
+	// the model axes come first, they are exact if the model is aligned
+	std::vector<glm::vec3> axes;
+	axes.push_back(glm::vec3(1.0f, 0.0f, 0.0f));
+	axes.push_back(glm::vec3(0.0f, 1.0f, 0.0f));
+	axes.push_back(glm::vec3(0.0f, 0.0f, 1.0f));
+	for (int i = 0; i < 3; i++) {
+		axes.push_back(glm::normalize(glm::vec3(eigenvectors.at<float>(i, 0), eigenvectors.at<float>(i, 1), eigenvectors.at<float>(i, 2))));
+	}
+
+	// angles without a rational relation to pi for the continuous test
+	const float continuous_angles[3] = { 0.3719f, 1.2311f, 2.7183f };
+
+	for (int i = 0; i < axes.size(); i++) {
+
+		// skip duplicate axes
+		bool duplicate = false;
+		for (int j = 0; j < i; j++) {
+			if (fabs(glm::dot(axes[i], axes[j])) > 0.999f) duplicate = true;
+		}
+		if (duplicate) continue;
+
+		bool continuous = true;
+		for (int a = 0; a < 3 && continuous; a++) {
+			continuous = IsSymmetric(surface, surface_points, samples, center, axes[i], continuous_angles[a], max_distance);
+		}
+		if (continuous) {
+			if (group.type != CONTINUOUS) {
+				group.type = CONTINUOUS;
+				group.order = 0;
+				group.axis = axes[i];
+			}
+			continue;
+		}
+		if (group.type == CONTINUOUS) continue;
+
+		// the largest order wins; smaller orders cannot improve the result
+		for (int n = max_order; n > (std::max)(1, group.order); n--) {
+			if (IsSymmetric(surface, surface_points, samples, center, axes[i], 2.0f * ModelSymmetryConst::pi / n, max_distance)) {
+				group.type = DISCRETE;
+				group.order = n;
+				group.axis = axes[i];
+				break;
+			}
+		}
+	}
+
+	return group;
+}
+
+
+/*
+Map a view direction into the fundamental sector of the group.
+*/
+//static
+glm::vec3 ModelSymmetry::Canonical(const Group& group, const glm::vec3& direction)
+{
+	glm::vec3 d = glm::normalize(direction);
+	if (group.type == NONE) return d;
+
+	glm::quat q = glm::angleAxis(SectorRotation(group, d), glm::normalize(group.axis));
+	return glm::normalize(q * d);
+}
+
+
+/*
+Reduce view directions to one direction per equivalence class.
+*/
+//static
+int ModelSymmetry::Reduce(const Group& group, const std::vector<glm::vec3>& directions, std::vector<int>& representative)
+{
+	int N = (int)directions.size();
+	representative.resize(N);
+	for (int i = 0; i < N; i++) representative[i] = i;
+	if (group.type == NONE || N < 2) return N;
+
+	// the canonical direction and the image up-vector of each view, rotated into the fundamental sector. 
+	// Two views are equivalent if both match, otherwise their images differ by an in-plane rotation.
+	glm::vec3 axis = glm::normalize(group.axis);
+	std::vector<glm::vec3> normalized(N);
+	std::vector<glm::vec3> canonical(N);
+	std::vector<glm::vec3> canonical_up(N);
+	for (int i = 0; i < N; i++) {
+		glm::vec3 d = glm::normalize(directions[i]);
+		glm::vec3 up = CameraUp(d);
+		glm::quat q = glm::angleAxis(SectorRotation(group, d), axis);
+		normalized[i] = d;
+		canonical[i] = glm::normalize(q * d);
+		canonical_up[i] = q * glm::normalize(up - glm::dot(up, d) * d);
+	}
+
+	// the median distance between neighboring directions
+	PointKDTree index;
+	index.build(normalized);
+	std::vector<float> spacing(N);
+	std::vector<int> nn;
+	for (int i = 0; i < N; i++) {
+		index.knn(normalized[i], 2, nn);
+		spacing[i] = nn.size() > 1 ? glm::length(normalized[nn[1]] - normalized[i]) : 0.0f;
+	}
+	std::nth_element(spacing.begin(), spacing.begin() + N / 2, spacing.end());
+	float max_distance = 0.75f * spacing[N / 2]; // close to the covering radius of the directions
+
+	// keep a direction if no kept direction is equivalent
+	PointKDTree canonical_index;
+	canonical_index.build(canonical);
+	int count = 0;
+	for (int i = 0; i < N; i++) {
+		canonical_index.knn(canonical[i], 16, nn);
+		for (int j : nn) {
+			if (glm::length(canonical[j] - canonical[i]) > max_distance) break; // sorted by distance
+			if (j < i && representative[j] == j && glm::length(canonical_up[j] - canonical_up[i]) <= max_distance) {
+				representative[i] = j;
+				break;
+			}
+		}
+		if (representative[i] == i) count++;
+	}
+
+	return count;
+}
+
+
+/*
+Return the up-vector of a camera that looks from the direction at the center.
+*/
+//static
+glm::vec3 ModelSymmetry::CameraUp(const glm::vec3& direction)
+{
+	glm::vec3 d = glm::normalize(direction);
+
+	// the view matrix becomes NaN if the direction and the up-vector align
+	if (fabs(d.y) > 0.999f) return glm::vec3(0.0f, 0.0f, d.y < 0.0f ? 1.0f : -1.0f);
+	return glm::vec3(0.0f, 1.0f, 0.0f);
+}
+
+
+/*
+Return the group in Schoenflies notation, C1, Cn, or Cinf.
+*/
+//static
+std::string ModelSymmetry::ToString(const Group& group)
+{
+	if (group.type == CONTINUOUS) return "Cinf";
+	if (group.type == DISCRETE) return "C" + std::to_string(group.order);
+	return "C1";
+}
+
+
+/*
+Return the angle of the rotation about the axis that Canonical() applies to the direction.
+*/
+//static
+float ModelSymmetry::SectorRotation(const Group& group, const glm::vec3& direction)
+{
+	if (group.type == NONE) return 0.0f;
+
+	// orthonormal basis (u, w) perpendicular to the axis
+	glm::vec3 a = glm::normalize(group.axis);
+	glm::vec3 ref = fabs(a.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+	glm::vec3 u = glm::normalize(glm::cross(a, ref));
+	glm::vec3 w = glm::cross(a, u);
+
+	// azimuth 0 for a continuous symmetry, azimuth in [0, 2pi/n) for a discrete symmetry
+	float phi = atan2(glm::dot(direction, w), glm::dot(direction, u));
+	if (group.type == CONTINUOUS) return -phi;
+
+	float sector = 2.0f * ModelSymmetryConst::pi / group.order;
+	float target = fmod(phi, sector);
+	if (target < 0.0f) target += sector;
+	return target - phi;
+}
+
+
+/*
+Sample points on the triangles, uniform per surface area.
+*/
+//static
+void ModelSymmetry::SampleSurface(const std::vector<glm::vec3>& vertices, const std::vector<int>& indices,
+	int num_samples, unsigned int seed, std::vector<glm::vec3>& samples)
+{
+	samples.clear();
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+
+	// the cumulative triangle area
+	int T = (int)indices.size() / 3;
+	std::vector<double> area(T + 1, 0.0);
+	for (int t = 0; t < T; t++) {
+		const glm::vec3& a = vertices[indices[3 * t]];
+		const glm::vec3& b = vertices[indices[3 * t + 1]];
+		const glm::vec3& c = vertices[indices[3 * t + 2]];
+		area[t + 1] = area[t] + 0.5 * glm::length(glm::cross(b - a, c - a));
+	}
+
+	// no triangles, use the vertices
+	if (T == 0 || area[T] <= 0.0) {
+		std::uniform_int_distribution<int> pick(0, (int)vertices.size() - 1);
+		for (int i = 0; i < num_samples; i++) samples.push_back(vertices[pick(rng)]);
+		return;
+	}
+
+	samples.reserve(num_samples);
+	for (int i = 0; i < num_samples; i++) {
+		double s = uniform(rng) * area[T];
+		int t = (int)(std::upper_bound(area.begin(), area.end(), s) - area.begin()) - 1;
+		t = (std::min)((std::max)(t, 0), T - 1);
+
+		// uniform barycentric coordinates
+		float r1 = sqrt(uniform(rng));
+		float r2 = uniform(rng);
+		const glm::vec3& a = vertices[indices[3 * t]];
+		const glm::vec3& b = vertices[indices[3 * t + 1]];
+		const glm::vec3& c = vertices[indices[3 * t + 2]];
+		samples.push_back((1.0f - r1) * a + r1 * (1.0f - r2) * b + r1 * r2 * c);
+	}
+}
+
+
+/*
+Return the 99th percentile of the distances of the samples to the surface index.
+*/
+//static
+float ModelSymmetry::Distance(const PointKDTree& surface, const std::vector<glm::vec3>& surface_points, const std::vector<glm::vec3>& samples)
+{
+	int N = (int)samples.size();
+	std::vector<float> distances(N, 0.0f);
+
+	cv::parallel_for_(cv::Range(0, N), [&](const cv::Range& range) {
+		std::vector<int> nn;
+		for (int i = range.start; i < range.end; i++) {
+			surface.knn(samples[i], 1, nn);
+			distances[i] = glm::length(surface_points[nn[0]] - samples[i]);
+		}
+	});
+
+	int k = (N * 99) / 100;
+	std::nth_element(distances.begin(), distances.begin() + k, distances.end());
+	return distances[k];
+}
+
+
+/*
+Return true if the rotation about the axis maps the samples onto the surface.
+*/
+//static
+bool ModelSymmetry::IsSymmetric(const PointKDTree& surface, const std::vector<glm::vec3>& surface_points, const std::vector<glm::vec3>& samples,
+	const glm::vec3& center, const glm::vec3& axis, float angle, float max_distance)
+{
+	glm::quat q = glm::angleAxis(angle, axis);
+
+	std::vector<glm::vec3> rotated(samples.size());
+	for (int i = 0; i < samples.size(); i++) {
+		rotated[i] = center + q * (samples[i] - center);
+	}
+
+	return Distance(surface, surface_points, rotated) <= max_distance;
+}
@@ -0,0 +1,169 @@
+/*
+class ModelSymmetry
+
+Detects the rotational symmetry of a 3D model and reduces a set of camera view directions
+to one view per equivalence class.
+
+Analyze() samples the model surface and tests candidate axes through the look-at point of the camera,
+the origin of the model by default: the x, y, z axes of the model and the principal axes of the surface. 
+The renderers look at this point, thus, only a rotation about an axis through it maps one rendered view 
+onto another. A model that is symmetric about an axis through its centroid, but not through the 
+look-at point, has no symmetry in this sense. An axis is a symmetry axis
+if the rotated surface samples stay as close to the surface as a second, unrotated sample set.
+- A continuous symmetry (e.g., a cylinder) passes several rotations with irrational angles.
+- A discrete symmetry of order n passes the rotation 2pi/n. The largest n up to max_order is reported.
+Only one axis is reported, the one with the largest group. Objects with several symmetry axes
+(e.g., a cube) are reduced by the cyclic group of this axis only.
+
+Two views are equivalent if a symmetry rotation maps one camera onto the other, its view direction
+and its up-vector, see CameraUp(). Otherwise, the images differ by an in-plane rotation. 
+Reduce() maps each direction into the fundamental sector of the group (azimuth in [0, 2pi/n)
+about the axis, or azimuth 0 for a continuous symmetry) and keeps a direction only
+if no other kept direction is closer than 3/4 of the spacing of the input directions, 
+and if the rotation between both views maps the up-vectors onto each other, with the same tolerance.
+If the symmetry axis is the up axis y, this keeps about 1/n of the directions on a polyhedron. 
+Other axes rotate the up-vector, and only a few views are equivalent.
+
+Usage:
+ModelSymmetry::Group group = ModelSymmetry::Analyze(vertices, indices);
+vector<int> representative;
+int N = ModelSymmetry::Reduce(group, directions, representative); // directions[representative[i]] is equivalent to directions[i]
+
+Rafael Radkowski
+Iowa State University
+rafael@iastate.edu
+Oct 2026
+MIT license
+----------------------------------------------------
+last edited:
+Oct 19, 2026, RR
+- The symmetry axes run through the look-at point instead of the surface centroid.
+- Reduce() compares the up-vectors of the views, see CameraUp().
+*/
+#pragma once
+
+// stl
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <random>
+
+// opencv
+#include <opencv2/opencv.hpp>
+
+// GLM include files
+#define GLM_FORCE_INLINE
+#include <glm/glm.hpp>
+#include <glm/gtx/quaternion.hpp> // quaternions
+
+// local
+#include "PointKDTree.h"
+
+
+class ModelSymmetry
+{
+public:
+
+	typedef enum {
+		NONE,
+		DISCRETE,	// rotations by multiples of 2pi/order
+		CONTINUOUS	// rotations by any angle
+	}SymmetryType;
+
+
+	/*
+	The rotational symmetry group of a model.
+	*/
+	typedef struct _Group {
+		SymmetryType	type;
+		int				order; // 1 for NONE, n for DISCRETE, 0 for CONTINUOUS
+		glm::vec3		axis; // through the center, normalized
+		glm::vec3		center; // the look-at point, in model coordinates
+
+		_Group()
+		{
+			type = NONE;
+			order = 1;
+			axis = glm::vec3(0.0f, 1.0f, 0.0f);
+			center = glm::vec3(0.0f, 0.0f, 0.0f);
+		}
+	}Group;
+
+
+	/*
+	Detect the rotational symmetry of a triangle mesh.
+	@param vertices - the vertex positions.
+	@param indices - three vertex indices per triangle. If empty, the vertices are used as surface samples.
+	@param max_order - the largest discrete order to test.
+	@param tolerance - the accepted distance of the rotated samples, relative to the sample spacing.
+	@param center - the look-at point of the camera in model coordinates. The axes run through this point.
+	@return - the symmetry group, type NONE if the model has no rotational symmetry.
+	*/
+	static Group Analyze(const std::vector<glm::vec3>& vertices, const std::vector<int>& indices, int max_order = 12, float tolerance = 2.0f,
+		const glm::vec3& center = glm::vec3(0.0f, 0.0f, 0.0f));
+
+
+	/*
+	Map a view direction into the fundamental sector of the group.
+	@param group - the symmetry group.
+	@param direction - the direction from the object to the camera.
+	@return - the normalized equivalent direction in the fundamental sector.
+	*/
+	static glm::vec3 Canonical(const Group& group, const glm::vec3& direction);
+
+
+	/*
+	Reduce view directions to one direction per equivalence class.
+	@param group - the symmetry group.
+	@param directions - the directions from the object to the camera.
+	@param representative - returns, for each direction, the index of the kept direction that
+							replaces it. representative[i] == i for all kept directions.
+	@return - the number of kept directions.
+	*/
+	static int Reduce(const Group& group, const std::vector<glm::vec3>& directions, std::vector<int>& representative);
+
+
+	/*
+	Return the up-vector of a camera that looks from the direction at the center. 
+	It is y, or -z/z if the direction is parallel to y. PolyhedronViewRenderer and BalancedPoseTree 
+	use it for their view matrices, and Reduce() uses it to compare views.
+	@param direction - the direction from the object to the camera.
+	@return - the up-vector.
+	*/
+	static glm::vec3 CameraUp(const glm::vec3& direction);
+
+
+	/*
+	Return the group in Schoenflies notation, C1, Cn, or Cinf.
+	*/
+	static std::string ToString(const Group& group);
+
+
+private:
+
+	/*
+	Return the angle of the rotation about the axis that Canonical() applies to the direction.
+	*/
+	static float SectorRotation(const Group& group, const glm::vec3& direction);
+
+
+	/*
+	Sample points on the triangles, uniform per surface area.
+	*/
+	static void SampleSurface(const std::vector<glm::vec3>& vertices, const std::vector<int>& indices,
+		int num_samples, unsigned int seed, std::vector<glm::vec3>& samples);
+
+
+	/*
+	Return the 99th percentile of the distances of the samples to the surface index.
+	*/
+	static float Distance(const PointKDTree& surface, const std::vector<glm::vec3>& surface_points, const std::vector<glm::vec3>& samples);
+
+
+	/*
+	Return true if the rotation about the axis maps the samples onto the surface.
+	*/
+	static bool IsSymmetric(const PointKDTree& surface, const std::vector<glm::vec3>& surface_points, const std::vector<glm::vec3>& samples,
+		const glm::vec3& center, const glm::vec3& axis, float angle, float max_distance);
+};
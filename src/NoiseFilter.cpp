@@ -12,6 +12,221 @@ using namespace std;
 
 
 
+NoiseFilter::NoiseFilter()
+{
+	_type = GAUSSIAN;
+	_mean = 0.0;
+	_sigma = 0.1;
+	_pool_size = 4;
+	_seed = RandomSeed();
+	_rng.seed(_seed);
+
+	for (int i = 0; i < 256; i++) {
+		_amplitude[i] = 0;
+	}
+}
+
+
+NoiseFilter::~NoiseFilter()
+{
+}
+
+
+/**
+* Set the noise type and parameters. This invalidates the tile pool.
+*/
+void NoiseFilter::setNoise(NoiseType type, float mean, float sigma)
+{
+	_type = type;
+	_mean = mean;
+	_sigma = sigma;
+	_tiles.clear();
+}
+
+
+/**
+* Set the random seed. This invalidates the tile pool.
+*/
+void NoiseFilter::setSeed(unsigned int seed)
+{
+	_seed = seed;
+	_rng.seed(_seed);
+	_tiles.clear();
+}
+
+
+/**
+* Set the number of noise tiles in the pool.
+*/
+void NoiseFilter::setPoolSize(int num_tiles)
+{
+	_pool_size = (std::max)(1, num_tiles);
+	_tiles.clear();
+}
+
+
+/**
+* Add noise to an image using a random window of a random pool tile.
+*/
+bool NoiseFilter::apply(cv::Mat& img, cv::Mat& mask, cv::Mat& dst)
+{
+	if (img.rows == 0 || img.cols == 0 || img.type() != CV_8UC3) {
+		std::cout << "[ERROR] - NoiseFilter: apply expects a CV_8UC3 image." << std::endl;
+		return false;
+	}
+	if (!mask.empty() && (mask.type() != CV_8UC1 || mask.size() != img.size())) {
+		std::cout << "[ERROR] - NoiseFilter: the mask must be of type CV_8UC1 and match the image size." << std::endl;
+		return false;
+	}
+
+	Window window;
+	nextWindow(img.size(), window);
+
+	// dst may be img. Each row is read before it is written, so this is safe.
+	dst.create(img.size(), CV_8UC3);
+
+	cv::parallel_for_(cv::Range(0, img.rows), [&](const cv::Range& range) {
+		applyRows(img, mask, _tiles[window.tile], window.ox, window.oy, dst, range);
+	});
+
+	return true;
+}
+
+
+/**
+* Draw a random noise window for an image of the given size.
+*/
+bool NoiseFilter::nextWindow(cv::Size size, Window& window)
+{
+	if (_tiles.size() == 0 || _tiles[0].cols < size.width || _tiles[0].rows < size.height) {
+		createPool(size.width, size.height);
+	}
+
+	std::uniform_int_distribution<int> dice_tile(0, (int)_tiles.size() - 1);
+	window.tile = dice_tile(_rng);
+	std::uniform_int_distribution<int> dice_x(0, _tiles[window.tile].cols - size.width);
+	std::uniform_int_distribution<int> dice_y(0, _tiles[window.tile].rows - size.height);
+	window.ox = dice_x(_rng);
+	window.oy = dice_y(_rng);
+
+	return true;
+}
+
+
+/**
+* Add the noise of a window to a band of rows of an image.
+*/
+void NoiseFilter::applyWindow(const Window& window, const cv::Mat& img, const cv::Mat& mask, cv::Mat& dst, int row_offset) const
+{
+	if (window.tile < 0 || window.tile >= (int)_tiles.size()) return;
+
+	applyRows(img, mask, _tiles[window.tile], window.ox, window.oy + row_offset, dst, cv::Range(0, img.rows));
+}
+
+
+/*
+Create the tile pool.
+*/
+bool NoiseFilter::createPool(int width, int height)
+{
+	_tiles.clear();
+
+	int tile_w = 2 * width;
+	int tile_h = 2 * height;
+
+	for (int i = 0; i < _pool_size; i++) {
+		cv::RNG rng((uint64)_seed * 7919 + i + 1);
+		cv::Mat tile(tile_h, tile_w, CV_16SC3);
+
+		switch (_type) {
+		case GAUSSIAN:
+			rng.fill(tile, RNG::NORMAL, _mean, _sigma * 255.0);
+			break;
+		case SPECKLE:
+		{
+			// one factor for all channels; speckle changes the brightness, not the hue.
+			cv::Mat n(tile_h, tile_w, CV_16SC1);
+			rng.fill(n, RNG::NORMAL, 0.0, _sigma * 256.0);
+			cv::Mat channels[3] = { n, n, n };
+			cv::merge(channels, 3, tile);
+			break;
+		}
+		case POISSON:
+			rng.fill(tile, RNG::NORMAL, 0.0, 256.0);
+			break;
+		}
+		_tiles.push_back(tile);
+	}
+
+	// Poisson: the standard deviation grows with the square root of the value.
+	for (int v = 0; v < 256; v++) {
+		_amplitude[v] = (int)(_sigma * std::sqrt(255.0 * v) + 0.5);
+	}
+
+	return true;
+}
+
+
+/*
+Apply one noise window to the rows of an image.
+The noise, the saturation, and the mask blend are fused in one branch-free loop.
+Each value is read before it is written, so src and dst can be the same image.
+The mask must be binary (0 or 255), as created by cv::threshold.
+*/
+void NoiseFilter::applyRows(const cv::Mat& src, const cv::Mat& mask, const cv::Mat& tile, int ox, int oy, cv::Mat& dst, const cv::Range& range) const
+{
+	const int cols = src.cols;
+
+	for (int r = range.start; r < range.end; r++) {
+		const uchar* s = src.ptr<uchar>(r);
+		const short* t = tile.ptr<short>(oy + r) + ox * 3;
+		uchar* d = dst.ptr<uchar>(r);
+		const uchar* m = mask.empty() ? NULL : mask.ptr<uchar>(r);
+
+		switch (_type) {
+		case GAUSSIAN:
+			for (int c = 0; c < cols; c++) {
+				const uchar mk = (m != NULL) ? m[c] : (uchar)255;
+				for (int k = 3 * c; k < 3 * c + 3; k++) {
+					const int in = s[k];
+					d[k] = (uchar)((saturate_cast<uchar>(in + t[k]) & mk) | (in & ~mk));
+				}
+			}
+			break;
+		case SPECKLE:
+			for (int c = 0; c < cols; c++) {
+				const uchar mk = (m != NULL) ? m[c] : (uchar)255;
+				for (int k = 3 * c; k < 3 * c + 3; k++) {
+					const int in = s[k];
+					d[k] = (uchar)((saturate_cast<uchar>(in + ((in * t[k]) >> 8)) & mk) | (in & ~mk));
+				}
+			}
+			break;
+		case POISSON:
+			for (int c = 0; c < cols; c++) {
+				const uchar mk = (m != NULL) ? m[c] : (uchar)255;
+				for (int k = 3 * c; k < 3 * c + 3; k++) {
+					const int in = s[k];
+					d[k] = (uchar)((saturate_cast<uchar>(in + ((_amplitude[in] * t[k]) >> 8)) & mk) | (in & ~mk));
+				}
+			}
+			break;
+		}
+	}
+}
+
+
+/*
+Return a non-deterministic seed.
+*/
+//static
+unsigned int NoiseFilter::RandomSeed(void)
+{
+	std::random_device rd;
+	return rd();
+}
+
+
 /**
 * Add Gaussian Noise for RGB CV_8U or CV_16U 3-channel-images
 *
@@ -21,22 +236,25 @@ using namespace std;
 * @return noise  Image with guassian noise
 */
 cv::Mat NoiseFilter::AddGaussianNoise(cv::Mat img, float mean, float sigma) {
-	Mat noise;
-	noise = img.clone();
-	RNG rng;
-	sigma = sigma * 255;
+	Mat noise(img.size(), CV_MAKETYPE(CV_32F, img.channels()));
+	RNG rng(RandomSeed());
+	double max_value = (img.depth() == CV_16U) ? 65535.0 : 255.0;
+	sigma = sigma * max_value;
 
 	// generate noise
 	rng.fill(noise, RNG::NORMAL, mean, sigma);
 
-	// create a mask to make sure to only affect the area with color and not the empty background. 
+	// create a mask to make sure to only affect the area with color and not the empty background.
 	cv::Mat grayscaleMat, mask;
 	cvtColor(img, grayscaleMat, CV_RGB2GRAY);
     cv::threshold(grayscaleMat, mask, 0.0, 255, CV_THRESH_BINARY); // 0.0 -> black background
+	if (mask.depth() != CV_8U) {
+		mask.convertTo(mask, CV_8U);
+	}
 
 	// add the noise
-	cv::Mat out;
-	add( noise, img, out, mask);
+	cv::Mat out = img.clone();
+	add( img, noise, out, mask, img.depth());
 
 	return out;
 }
@@ -50,19 +268,16 @@ cv::Mat NoiseFilter::AddGaussianNoise(cv::Mat img, float mean, float sigma) {
 */
 cv::Mat NoiseFilter::AddSpeckleNoiseRGB(cv::Mat img, float dev) {
 	Mat res;
-	res = img.clone();
-	CvMat* pNoise = cvCreateMat(img.rows, img.cols, CV_32F);
-	CvRNG rng(6);
+	Mat noise(img.size(), CV_32FC1);
+	RNG rng(RandomSeed());
 
-	cout << img.type() << endl;
+	rng.fill(noise, RNG::NORMAL, 1, dev);
 
-	cvRandArr(&rng, pNoise, CV_RAND_NORMAL, 1, dev);
-	for (int i = 0; i < img.rows; i++) {
-		for (int j = 0; j < img.cols; j++) {
-			float tmp = pNoise->data.fl[img.cols*i + j];
-			res.at<Vec3b>(i,j) = img.at<Vec3b>(i,j) * tmp;
-		}
-	}
+	// the same factor for all channels
+	std::vector<Mat> channels(img.channels(), noise);
+	Mat factor;
+	merge(channels, factor);
+
+	multiply(img, factor, res, 1.0, img.depth());
 	return res;
 }
-
@@ -1,14 +1,132 @@
 #pragma once
 #include <opencv2/opencv.hpp>
+#include <vector>
+#include <random>
 
 /**
 * Add Gaussian Noise or Speckle Noise for RGB CV_8U or CV_16U 3-channel-images
 *
+* The static functions generate a new noise image for each call.
+* An instance of NoiseFilter generates a pool of large noise tiles once and applies
+* a randomly placed window of a random tile to each image. Use it for batch processing.
+*
+* Usage:
+* NoiseFilter filter;
+* filter.setNoise(NoiseFilter::GAUSSIAN, 0.0, 0.1);
+* filter.apply(rendering, mask, rendering);
+*
+* ----------------------------------------------------------------------------------------
+* Last edits:
+*
+* Oct 19, 2026, RR:
+* - Added the noise tile pool with Gaussian, speckle, and Poisson noise.
+* - Replaced the deprecated C API in AddSpeckleNoiseRGB. The static functions are seeded randomly.
+* - Added nextWindow() and applyWindow() to add noise band by band, see AugmentationGraph.
 */
 class NoiseFilter
 {
 public:
-	
+
+	/**
+	* Supported noise types.
+	* GAUSSIAN - additive noise, sigma is the standard deviation relative to the max. value (0 to 1)
+	* SPECKLE - multiplicative noise, out = in * (1 + n), sigma is the standard deviation of n.
+	* POISSON - signal dependent shot noise (Gaussian approximation), sigma is the standard deviation
+	*           at the max. value, relative to the max. value (0 to 1).
+	*/
+	typedef enum {
+		GAUSSIAN,
+		SPECKLE,
+		POISSON
+	}NoiseType;
+
+
+	/**
+	* A noise window: a tile of the pool and the window offset in that tile.
+	*/
+	typedef struct _Window {
+		int tile;
+		int ox;
+		int oy;
+
+		_Window()
+		{
+			tile = 0;
+			ox = 0;
+			oy = 0;
+		}
+	}Window;
+
+
+	NoiseFilter();
+	~NoiseFilter();
+
+
+	/**
+	* Set the noise type and parameters. This invalidates the tile pool.
+	*
+	* @param type - the noise type.
+	* @param mean - Mean of Gaussian noise in pixel values. Only used by GAUSSIAN.
+	* @param sigma - Standard deviation of the noise, range from 0 to 1.
+	*/
+	void setNoise(NoiseType type, float mean, float sigma);
+
+
+	/**
+	* Set the random seed. The same seed produces the same tiles and placements.
+	* A random seed is used by default. This invalidates the tile pool.
+	*
+	* @param seed - the seed.
+	*/
+	void setSeed(unsigned int seed);
+
+
+	/**
+	* Set the number of noise tiles in the pool. The default is 4.
+	*
+	* @param num_tiles - the number of tiles.
+	*/
+	void setPoolSize(int num_tiles);
+
+
+	/**
+	* Add noise to an image. The function uses a random window of a random pool tile.
+	* The pool is created on the first call; it is recreated only if an image
+	* does not fit into the tiles. Pixels outside the mask are copied.
+	* Note that the function is not thread-safe since it advances the internal random engine.
+	*
+	* @param img - Input RGB CV_8UC3 image.
+	* @param mask - the foreground mask of type CV_8UC1, e.g., the compositing mask. Can be empty.
+	* @param dst - the output image of type CV_8UC3, can be img.
+	* @return true, if the noise was applied.
+	*/
+	bool apply(cv::Mat& img, cv::Mat& mask, cv::Mat& dst);
+
+
+	/**
+	* Draw a random noise window for an image of the given size.
+	* Creates the pool if necessary. Use it with applyWindow() to add noise to parts of an image.
+	*
+	* @param size - the size of the entire image.
+	* @param window - location for the window.
+	* @return true, if successful.
+	*/
+	bool nextWindow(cv::Size size, Window& window);
+
+
+	/**
+	* Add the noise of a window to a band of rows of an image.
+	* The function is const and can be called from multiple threads.
+	*
+	* @param window - a window from nextWindow().
+	* @param img - the band of rows, CV_8UC3.
+	* @param mask - the foreground mask of the band of type CV_8UC1. Can be empty.
+	* @param dst - the output band of type CV_8UC3, can be img.
+	* @param row_offset - the row of the entire image the band starts at.
+	*/
+	void applyWindow(const Window& window, const cv::Mat& img, const cv::Mat& mask, cv::Mat& dst, int row_offset) const;
+
+
 
 	/**
 	* Add Gaussian Noise for RGB CV_8U or CV_16U 3-channel-images
@@ -28,6 +146,42 @@ public:
 	* @return noise  Image with speckle noise
 	*/
 	static cv::Mat AddSpeckleNoiseRGB(cv::Mat img, float dev);
-	
 
-};
\ No newline at end of file
+
+private:
+
+	/*
+	Create the tile pool. The tiles are twice as large as the given image size
+	so that the random windows vary.
+	@param width, height - the image size in pixels.
+	*/
+	bool createPool(int width, int height);
+
+	/*
+	Apply one noise window to the rows of an image.
+	@param range - the rows to process.
+	*/
+	void applyRows(const cv::Mat& src, const cv::Mat& mask, const cv::Mat& tile, int ox, int oy, cv::Mat& dst, const cv::Range& range) const;
+
+	/*
+	Return a non-deterministic seed.
+	*/
+	static unsigned int RandomSeed(void);
+
+
+	NoiseType				_type;
+	float					_mean;
+	float					_sigma;
+	unsigned int			_seed;
+	int						_pool_size;
+
+	// the noise tiles, CV_16SC3. The content depends on the noise type:
+	// GAUSSIAN: noise in pixel values, SPECKLE and POISSON: noise in 1/256 fixed point.
+	std::vector<cv::Mat>	_tiles;
+
+	// POISSON: standard deviation per input value
+	int						_amplitude[256];
+
+	// picks the tile and the window offset
+	std::mt19937			_rng;
+};
@@ -72,9 +72,40 @@ Parser::Arguments Parser::Parse(int& argc, char** argv)
 			if (argc >= pos+1) opt.noise_sigma = atof(string(argv[pos+1]).c_str());
 			else ParamError(c_arg);
 		}
+		else if (c_arg.compare("-noise_type") == 0) { // noise type
+			if (argc > pos+1) {
+				string t(argv[pos+1]);
+				std::transform(t.begin(), t.end(), t.begin(), ::tolower);
+				if (t.compare("gaussian") == 0) opt.noise_type = 0;
+				else if (t.compare("speckle") == 0) opt.noise_type = 1;
+				else if (t.compare("poisson") == 0) opt.noise_type = 2;
+				else ParamError(c_arg);
+			}
+			else ParamError(c_arg);
+		}
+		else if (c_arg.compare("-seed") == 0) { // random seed
+			if (argc > pos+1) opt.seed = atoi(string(argv[pos+1]).c_str());
+			else ParamError(c_arg);
+		}
+		else if (c_arg.compare("-bg_samples") == 0) { // samples per background image
+			if (argc > pos+1) opt.bg_samples = atoi(string(argv[pos+1]).c_str());
+			else ParamError(c_arg);
+			if (opt.bg_samples < 1) ParamError(c_arg);
+		}
+		else if (c_arg.compare("-crop_scale") == 0) { // range of the crop window scale
+			if (argc > pos+2) {
+				opt.crop_scale_min = atof(string(argv[pos+1]).c_str());
+				opt.crop_scale_max = atof(string(argv[pos+2]).c_str());
+				if (opt.crop_scale_min <= 0.0 || opt.crop_scale_max > 1.0 || opt.crop_scale_min > opt.crop_scale_max) ParamError(c_arg);
+			}
+			else ParamError(c_arg);
+		}
 		else if(c_arg.compare("-chromatic") == 0){
 			opt.with_chromatic = true;
 		}
+		else if(c_arg.compare("-histmatch") == 0){
+			opt.with_histmatch = true;
+		}
 		else if(c_arg.compare("-help") == 0 || c_arg.compare("-h") == 0){ // help
 			Help();
 		}
@@ -112,7 +143,12 @@ void Parser::Help(void)
 	cout << "\tOptional:" << endl;
 	cout << "\t-h \t- shows this help dialog" << endl;
 	cout << "\t-noise [param] \t- enable noise and set the noise sigma value param (float)." << endl;
+	cout << "\t-noise_type [param] \t- set the noise type: gaussian, speckle, or poisson. Default is gaussian." << endl;
+	cout << "\t-seed [param] \t- set a seed (integer) to reproduce the noise." << endl;
 	cout << "\t-chromatic \t- enable chromatic image adapation." << endl;
+	cout << "\t-histmatch \t- enable histogram matching of the rendering to the background image." << endl;
+	cout << "\t-bg_samples [param] \t- set the number of samples generated from each background image (integer). Default is 1." << endl;
+	cout << "\t-crop_scale [min] [max] \t- set the scale range (0, 1] of the random background crop windows. Default is 1 1." << endl;
 
 	
 
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <algorithm>
 
 // local
 #include "types.h"
@@ -42,8 +43,15 @@ public:
 		bool		verbose;
 
 		float	noise_sigma;
+		int		noise_type; // 0: gaussian, 1: speckle, 2: poisson
+		int		seed; // -1: random seed
 		bool	with_noise;
 		bool	with_chromatic;
+		bool	with_histmatch;
+
+		int		bg_samples; // samples per background image
+		float	crop_scale_min; // range of the background crop window scale
+		float	crop_scale_max;
 
 		_Arguments()
 		{
@@ -58,8 +66,15 @@ public:
 			image_height = 512;
 
 			noise_sigma = 0.1;
+			noise_type = 0;
+			seed = -1;
 			with_noise = false;
 			with_chromatic = false;
+			with_histmatch = false;
+
+			bg_samples = 1;
+			crop_scale_min = 1.0;
+			crop_scale_max = 1.0;
 
 			num_images = 10000;
 			verbose = false;
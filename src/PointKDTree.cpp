@@ -0,0 +1,139 @@
+#include "PointKDTree.h"
+
+
+PointKDTree::PointKDTree()
+{
+	_root = -1;
+}
+
+
+PointKDTree::~PointKDTree()
+{
+
+}
+
+
+/*
+Build the tree. The points are copied.
+@param points - the point set.
+*/
+void PointKDTree::build(const std::vector<glm::vec3>& points)
+{
+	_points = points;
+	_nodes.clear();
+	_nodes.reserve(_points.size());
+	_root = -1;
+
+	if (_points.size() == 0) return;
+
+	std::vector<int> idx(_points.size());
+	for (int i = 0; i < (int)idx.size(); i++) idx[i] = i;
+
+	_root = buildRecursive(&idx[0], (int)idx.size());
+}
+
+
+/*
+Build the subtree for the points idx[0, n).
+Splits at the median of the axis with the largest extent.
+*/
+int PointKDTree::buildRecursive(int* idx, int n)
+{
+	if (n <= 0) return -1;
+
+	// axis with the largest extent
+	glm::vec3 min_p = _points[idx[0]];
+	glm::vec3 max_p = _points[idx[0]];
+	for (int i = 1; i < n; i++) {
+		min_p = glm::min(min_p, _points[idx[i]]);
+		max_p = glm::max(max_p, _points[idx[i]]);
+	}
+	glm::vec3 extent = max_p - min_p;
+	int axis = 0;
+	if (extent[1] > extent[axis]) axis = 1;
+	if (extent[2] > extent[axis]) axis = 2;
+
+	// partial sort, the median is at n/2
+	int m = n / 2;
+	const std::vector<glm::vec3>& points = _points;
+	std::nth_element(idx, idx + m, idx + n, [&points, axis](int a, int b) { return points[a][axis] < points[b][axis]; });
+
+	int node = (int)_nodes.size();
+	_nodes.push_back(KDNode());
+	_nodes[node].point = idx[m];
+	_nodes[node].axis = axis;
+
+	int left = buildRecursive(idx, m);
+	int right = buildRecursive(idx + m + 1, n - m - 1);
+	_nodes[node].left = left;
+	_nodes[node].right = right;
+
+	return node;
+}
+
+
+/*
+Find the k nearest neighbors of a query point.
+@param query - the query point.
+@param k - the number of neighbors. k is clamped to the number of points.
+@param indices - location for the point indices, sorted by distance.
+@return the number of neighbors found.
+*/
+int PointKDTree::knn(const glm::vec3& query, int k, std::vector<int>& indices) const
+{
+	indices.clear();
+
+	k = (std::min)(k, (int)_points.size());
+	if (k <= 0 || _root < 0) return 0;
+
+	std::vector<Candidate> heap;
+	heap.reserve(k + 1);
+
+	search(_root, query, k, heap);
+
+	// ascending by distance, then by index
+	std::sort_heap(heap.begin(), heap.end());
+
+	indices.reserve(heap.size());
+	for (const Candidate& c : heap) {
+		indices.push_back(c.second);
+	}
+
+	return (int)indices.size();
+}
+
+
+/*
+Search the subtree for the k nearest neighbors. The candidates are a max-heap of size <= k.
+*/
+void PointKDTree::search(int node, const glm::vec3& query, int k, std::vector<Candidate>& heap) const
+{
+	if (node < 0) return;
+
+	const KDNode& n = _nodes[node];
+	glm::vec3 d = _points[n.point] - query;
+	Candidate c(glm::dot(d, d), n.point);
+
+	if ((int)heap.size() < k) {
+		heap.push_back(c);
+		std::push_heap(heap.begin(), heap.end());
+	}
+	else if (c < heap.front()) {
+		std::pop_heap(heap.begin(), heap.end());
+		heap.back() = c;
+		std::push_heap(heap.begin(), heap.end());
+	}
+
+	// visit the side of the query first
+	float diff = query[n.axis] - _points[n.point][n.axis];
+	int near_side = diff < 0.0f ? n.left : n.right;
+	int far_side = diff < 0.0f ? n.right : n.left;
+
+	search(near_side, query, k, heap);
+
+	// the far side can only contain closer points if the splitting plane is closer than the k-th candidate.
+	// Equal distances are visited to resolve ties by index.
+	if ((int)heap.size() < k || diff * diff <= heap.front().first) {
+		search(far_side, query, k, heap);
+	}
+}
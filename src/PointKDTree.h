@@ -0,0 +1,107 @@
+/*
+class PointKDTree
+
+A static k-d tree for 3D points. It answers exact k-nearest-neighbor queries
+without computing the distances to all points. The balanced pose tree uses it to find
+the child view points of a node on the next polyhedron level.
+
+The tree is built once per point set. Queries are const and can run in parallel.
+Results are sorted by distance. Points with equal distance are sorted by their index,
+which keeps the results deterministic on symmetric point sets such as a polyhedron.
+
+Usage:
+PointKDTree index;
+index.build(points);
+vector<int> nn;
+index.knn(query, 6, nn);
+
+Rafael Radkowski
+Iowa State University
+rafael@iastate.edu
+Oct 2026
+MIT license
+----------------------------------------------------
+last edited:
+
+*/
+#pragma once
+
+// stl
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+// GLM include files
+#define GLM_FORCE_INLINE
+#include <glm/glm.hpp>
+
+
+class PointKDTree
+{
+public:
+
+	PointKDTree();
+	~PointKDTree();
+
+
+	/*
+	Build the tree. The points are copied.
+	@param points - the point set.
+	*/
+	void build(const std::vector<glm::vec3>& points);
+
+
+	/*
+	Find the k nearest neighbors of a query point.
+	@param query - the query point.
+	@param k - the number of neighbors. k is clamped to the number of points.
+	@param indices - location for the point indices, sorted by distance.
+	@return the number of neighbors found.
+	*/
+	int knn(const glm::vec3& query, int k, std::vector<int>& indices) const;
+
+
+	/*
+	Return the number of points in the tree.
+	*/
+	int size(void) const { return (int)_points.size(); }
+
+
+private:
+
+	typedef struct _KDNode {
+		int		point;	// the splitting point
+		int		axis;	// the splitting axis, 0, 1, or 2
+		int		left;	// child node indices, -1 if none
+		int		right;
+
+		_KDNode()
+		{
+			point = -1;
+			axis = 0;
+			left = -1;
+			right = -1;
+		}
+	}KDNode;
+
+	// squared distance and point index. pairs compare by distance first, then by index
+	typedef std::pair<float, int> Candidate;
+
+
+	/*
+	Build the subtree for the points idx[0, n).
+	@return the index of the subtree root node.
+	*/
+	int buildRecursive(int* idx, int n);
+
+
+	/*
+	Search the subtree for the k nearest neighbors. The candidates are a max-heap of size <= k.
+	*/
+	void search(int node, const glm::vec3& query, int k, std::vector<Candidate>& heap) const;
+
+
+	std::vector<glm::vec3>	_points;
+	std::vector<KDNode>		_nodes;
+	int						_root;
+};
@@ -1,18 +1,27 @@
 #include "PolyhedronGeometry.h"
 
 
-namespace PolyhedronGeometry_types
+using namespace arlab;
+
+
+/*
+Constructor. Creates level 0, the Icosahedron.
+*/
+PolyhedronGeometry::PolyhedronGeometry()
 {
-	vector<glm::vec3>		_vertices;
-	vector<glm::ivec3>		_triangle_index;
-	int						_I; // num indices
+	createIcosahedron();
+}
+
+
+PolyhedronGeometry::~PolyhedronGeometry()
+{
+
 }
 
 
-using namespace PolyhedronGeometry_types;
-using namespace arlab;
 /*
 Create an Icosahedron or Polyhedron, depending on the num of subdivisions. 
+The function subdivides a cached instance up to the requested level once and copies the level.
 @param divisions - the number of subdivisons. 0 creates an Icosahedron;
 @return - two lists. the first one is the list with all points. 
 			the second one is an index list with all triangles
@@ -21,29 +30,101 @@ Create an Icosahedron or Polyhedron, depending on the num of subdivisions.
 //static 
 std::pair< vector<glm::vec3>, vector<glm::ivec3> > PolyhedronGeometry::Create(int subdivisions)
 {
-	// create the basic Icosahedron
-	CreateIcosahedron();
+	static PolyhedronGeometry cache;
+	static std::mutex cache_mutex;
 
-	// subdivide it. 
-	for (int i=0; i<subdivisions; ++i)
-	{
-		_triangle_index = subdivide(_vertices, _triangle_index);
-	}
+	if (subdivisions < 0) subdivisions = 0;
+
+	std::lock_guard<std::mutex> lock(cache_mutex);
+
+	cache.subdivideTo(subdivisions);
+
+	vector<glm::vec3> vertices(cache._vertices.begin(), cache._vertices.begin() + cache._num_vertices[subdivisions]);
  
-	return make_pair(_vertices, _triangle_index);
+	return make_pair(vertices, cache._triangles[subdivisions]);
+}
 
 
+/*
+Subdivide the geometry until it has the given level. Existing levels are kept.
+*/
+bool PolyhedronGeometry::subdivideTo(int level)
+{
+	if (level < 0) {
+		cout << "[ERROR] - PolyhedronGeometry: the minimum level is 0." << endl;
+		return false;
+	}
+
+	while (numLevels() <= level) {
+		subdivide();
+	}
+	return true;
+}
+
+
+/*
+Return the number of vertices of a level.
+*/
+int PolyhedronGeometry::numVertices(int level) const
+{
+	if (level < 0 || level >= numLevels()) return 0;
+	return _num_vertices[level];
+}
+
+
+/*
+Return the triangles of a level.
+*/
+const vector<glm::ivec3>& PolyhedronGeometry::getTriangles(int level) const
+{
+	if (level < 0 || level >= numLevels()) {
+		static const vector<glm::ivec3> empty;
+		return empty;
+	}
+	return _triangles[level];
+}
+
+
+/*
+Return the parents of a vertex, the two vertices of the edge the vertex splits.
+*/
+glm::ivec2 PolyhedronGeometry::getParents(int vertex) const
+{
+	if (vertex < 0 || vertex >= _parents.size()) return glm::ivec2(-1, -1);
+	return _parents[vertex];
+}
+
+
+/*
+Return the children of a vertex on the next level.
+*/
+int PolyhedronGeometry::getChildren(int level, int vertex, vector<int>& children) const
+{
+	children.clear();
+
+	if (level < 0 || level >= _child_offsets.size()) return 0;
+	if (vertex < 0 || vertex >= _num_vertices[level]) return 0;
+
+	const vector<int>& offsets = _child_offsets[level];
+	children.assign(_child_ids[level].begin() + offsets[vertex], _child_ids[level].begin() + offsets[vertex + 1]);
+
+	return (int)children.size();
 }
 
 
 /*
 Create an Icosahedron
 */
-void PolyhedronGeometry::CreateIcosahedron(void)
+void PolyhedronGeometry::createIcosahedron(void)
 {
 	_vertices.clear();
-	_triangle_index.clear();
+	_num_vertices.clear();
+	_triangles.clear();
+	_parents.clear();
+	_child_offsets.clear();
+	_child_ids.clear();
 
+	vector<glm::ivec3> triangles;
 
 	const float X =.525731112119133606f;
 	const float Z =.850650808352039932f;
@@ -53,7 +134,6 @@ void PolyhedronGeometry::CreateIcosahedron(void)
  // {N,Z,X}, {N,Z,-X}, {N,-Z,X}, {N,-Z,-X},
 //  {Z,X,N}, {-Z,X, N}, {Z,-X,N}, {-Z,-X, N}
 
-
 	_vertices.push_back(glm::vec3(-X, N, Z));
 	_vertices.push_back(glm::vec3(X,N,Z));
 	_vertices.push_back(glm::vec3(-X,N,-Z));
@@ -69,55 +149,59 @@ void PolyhedronGeometry::CreateIcosahedron(void)
 	_vertices.push_back(glm::vec3(Z,-X,N));
 	_vertices.push_back(glm::vec3(-Z,-X, N));
 
-
 //	{0,4,1},{0,9,4},{9,5,4},{4,5,8},{4,8,1},
  // {8,10,1},{8,3,10},{5,3,8},{5,2,3},{2,7,3},
  // {7,10,3},{7,6,10},{7,11,6},{11,0,6},{0,1,6},
  // {6,1,10},{9,0,11},{9,11,2},{9,2,5},{7,2,11}
 
-	_triangle_index.push_back(glm::vec3(0,4,1));
-	_triangle_index.push_back(glm::vec3(0,9,4));
-	_triangle_index.push_back(glm::vec3(9,5,4));
-	_triangle_index.push_back(glm::vec3(4,5,8));
-	_triangle_index.push_back(glm::vec3(4,8,1));
-
-	_triangle_index.push_back(glm::vec3(8,10,1));
-	_triangle_index.push_back(glm::vec3(8,3,10));
-	_triangle_index.push_back(glm::vec3(5,3,8));
-	_triangle_index.push_back(glm::vec3(5,2,3));
-	_triangle_index.push_back(glm::vec3(2,7,3));
-
-	_triangle_index.push_back(glm::vec3(7,10,3));
-	_triangle_index.push_back(glm::vec3(7,6,10));
-	_triangle_index.push_back(glm::vec3(7,11,6));
-	_triangle_index.push_back(glm::vec3(11,0,6));
-	_triangle_index.push_back(glm::vec3(0,1,6));
-
-	_triangle_index.push_back(glm::vec3(6,1,10));
-	_triangle_index.push_back(glm::vec3(9,0,11));
-	_triangle_index.push_back(glm::vec3(9,11,2));
-	_triangle_index.push_back(glm::vec3(9,2,5));
-	_triangle_index.push_back(glm::vec3(7,2,11));
+	triangles.push_back(glm::ivec3(0,4,1));
+	triangles.push_back(glm::ivec3(0,9,4));
+	triangles.push_back(glm::ivec3(9,5,4));
+	triangles.push_back(glm::ivec3(4,5,8));
+	triangles.push_back(glm::ivec3(4,8,1));
+
+	triangles.push_back(glm::ivec3(8,10,1));
+	triangles.push_back(glm::ivec3(8,3,10));
+	triangles.push_back(glm::ivec3(5,3,8));
+	triangles.push_back(glm::ivec3(5,2,3));
+	triangles.push_back(glm::ivec3(2,7,3));
+
+	triangles.push_back(glm::ivec3(7,10,3));
+	triangles.push_back(glm::ivec3(7,6,10));
+	triangles.push_back(glm::ivec3(7,11,6));
+	triangles.push_back(glm::ivec3(11,0,6));
+	triangles.push_back(glm::ivec3(0,1,6));
+
+	triangles.push_back(glm::ivec3(6,1,10));
+	triangles.push_back(glm::ivec3(9,0,11));
+	triangles.push_back(glm::ivec3(9,11,2));
+	triangles.push_back(glm::ivec3(9,2,5));
+	triangles.push_back(glm::ivec3(7,2,11));
+
+	_num_vertices.push_back((int)_vertices.size());
+	_triangles.push_back(triangles);
+	_parents.assign(_vertices.size(), glm::ivec2(-1, -1));
 }
 
 
 
 
-int PolyhedronGeometry::vertex_for_edge(Lookup& lookup, vector<glm::vec3>& vertices, int first, int second)
+int PolyhedronGeometry::vertex_for_edge(Lookup& lookup, int first, int second)
 {
 	Lookup::key_type key(first, second);
 	if (key.first>key.second)
 		std::swap(key.first, key.second);
  
-	auto inserted=lookup.insert({key, vertices.size()});
+	auto inserted=lookup.insert({key, (int)_vertices.size()});
 
 	if (inserted.second)
 	{
-		glm::vec3& edge0 = vertices[first];
-		glm::vec3& edge1=vertices[second];
+		glm::vec3 edge0 = _vertices[first];
+		glm::vec3 edge1 = _vertices[second];
 		glm::vec3 point = glm::normalize(edge0+edge1);
 
-		vertices.push_back(point);
+		_vertices.push_back(point);
+		_parents.push_back(glm::ivec2(key.first, key.second));
 	}
  
 	return inserted.first->second;
@@ -125,19 +209,25 @@ int PolyhedronGeometry::vertex_for_edge(Lookup& lookup, vector<glm::vec3>& verti
 
 
 /*
-Subdivide the Icosahedron triangles
+Subdivide the triangles of the last level and append the next level.
+The new vertices are appended in the order of the triangles, which keeps 
+the vertex indices of the former implementation.
 */
-vector<glm::ivec3> PolyhedronGeometry::subdivide(vector<glm::vec3>& vertices, vector<glm::ivec3> triangles)
+void PolyhedronGeometry::subdivide(void)
 {
+	int level = numLevels() - 1;
+	int first_new = (int)_vertices.size();
+
 	Lookup lookup;
 	vector<glm::ivec3> result;
+	result.reserve(_triangles[level].size() * 4);
  
-	for (auto each:triangles)
+	for (auto each : _triangles[level])
 	{
 		std::array<int, 3> mid;
 		for (int edge=0; edge<3; edge++)
 		{
-			mid[edge]=vertex_for_edge(lookup, vertices, each[edge], each[(edge+1)%3]);
+			mid[edge]=vertex_for_edge(lookup, each[edge], each[(edge+1)%3]);
 		}
  
 		result.push_back({each[0], mid[0], mid[2]});
@@ -145,6 +235,28 @@ vector<glm::ivec3> PolyhedronGeometry::subdivide(vector<glm::vec3>& vertices, ve
 		result.push_back({each[2], mid[2], mid[1]});
 		result.push_back({mid[0], mid[1], mid[2]});
 	}
- 
-  return result;
+
+	// children of the vertices of this level: the vertex itself and all its edge vertices.
+	int n = _num_vertices[level];
+	vector<int> offsets(n + 1, 0);
+	for (int i = 0; i < n; i++) offsets[i + 1] = 1;
+	for (int v = first_new; v < (int)_vertices.size(); v++) {
+		offsets[_parents[v].x + 1]++;
+		offsets[_parents[v].y + 1]++;
+	}
+	for (int i = 0; i < n; i++) offsets[i + 1] += offsets[i];
+
+	vector<int> ids(offsets[n]);
+	vector<int> fill(offsets.begin(), offsets.end() - 1);
+	for (int i = 0; i < n; i++) ids[fill[i]++] = i;
+	for (int v = first_new; v < (int)_vertices.size(); v++) {
+		ids[fill[_parents[v].x]++] = v;
+		ids[fill[_parents[v].y]++] = v;
+	}
+
+	_child_offsets.push_back(offsets);
+	_child_ids.push_back(ids);
+
+	_num_vertices.push_back((int)_vertices.size());
+	_triangles.push_back(result);
 }
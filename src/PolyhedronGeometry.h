@@ -5,7 +5,24 @@ Class PolyhedronGeometry
 Create an Icosahedron and extend it to a Polyhedron by recursive decomposition.
 
 Algorithm credits to MARIUS ELVERT,
-see https://schneide.blog/2016/07/15/generating-an-icosphere-in-c/ for details. 
+see https://schneide.blog/2016/07/15/generating-an-icosphere-in-c/ for details.
+
+An instance keeps all levels of the decomposition. Level 0 is the Icosahedron;
+level l + 1 is level l with each triangle split into four. Subdividing appends the new
+vertices, thus, the vertices of level l are the first numVertices(l) vertices of all higher levels.
+The instance also keeps the parent/child relations between the vertices of two levels:
+- the parents of a vertex are the two vertices of the edge it splits (-1 for Icosahedron vertices).
+- the children of a vertex of level l are the vertex itself and the 5 or 6 vertices
+  that split its edges on level l + 1.
+
+Instances do not share state. The static Create() function uses a cached instance
+and is thread-safe.
+
+Usage:
+arlab::PolyhedronGeometry geometry;
+geometry.subdivideTo(4);
+const vector<glm::vec3>& points = geometry.getVertices(); // use the first geometry.numVertices(l) points for level l
+
 
 Rafael Radkowski
 Iowa State University
@@ -13,6 +30,13 @@ rafael@iastate.edu
 +1 (515) 294 7044
 Jan 2019
 All copyrights reserved
+-------------------------------------------------------------------------------
+Last edits:
+
+Oct 19, 2026, RR:
+- Replaced the namespace-global vertex and triangle lists with instance members.
+- Levels are subdivided incrementally and kept; added the parent/child vertex relations.
+- Create() reuses a cached instance instead of subdividing from scratch for each call.
 */
 
 #include <iostream>
@@ -20,6 +44,7 @@ All copyrights reserved
 #include <vector>
 #include <map>
 #include <array>
+#include <mutex>
 
 // GLEW include
 #include <GL/glew.h>
@@ -38,39 +63,111 @@ namespace arlab
 {
 
 	class PolyhedronGeometry {
-	
+
 		public:
 
 			/*
-				Create an Icosahedron or Polyhedron, depending on the num of subdivisions. 
+			Constructor. Creates level 0, the Icosahedron.
+			*/
+			PolyhedronGeometry();
+			~PolyhedronGeometry();
+
+
+			/*
+			Subdivide the geometry until it has the given level. Existing levels are kept.
+			@param level - the highest level. 0 is the Icosahedron.
+			@return - true, if successful.
+			*/
+			bool subdivideTo(int level);
+
+
+			/*
+			Return the number of levels.
+			*/
+			int numLevels(void) const { return (int)_triangles.size(); }
+
+
+			/*
+			Return the number of vertices of a level.
+			@param level - the level, 0 to numLevels() - 1.
+			*/
+			int numVertices(int level) const;
+
+
+			/*
+			Return the vertices of all levels. The first numVertices(l) vertices belong to level l.
+			*/
+			const vector<glm::vec3>& getVertices(void) const { return _vertices; }
+
+
+			/*
+			Return the triangles of a level.
+			@param level - the level, 0 to numLevels() - 1.
+			*/
+			const vector<glm::ivec3>& getTriangles(int level) const;
+
+
+			/*
+			Return the parents of a vertex, the two vertices of the edge the vertex splits.
+			@param vertex - the vertex index.
+			@return - the parent indices, (-1, -1) for the vertices of the Icosahedron.
+			*/
+			glm::ivec2 getParents(int vertex) const;
+
+
+			/*
+			Return the children of a vertex on the next level.
+			@param level - the level of the vertex, 0 to numLevels() - 2.
+			@param vertex - the vertex index, 0 to numVertices(level) - 1.
+			@param children - location for the child indices. The first child is the vertex itself.
+			@return - the number of children.
+			*/
+			int getChildren(int level, int vertex, vector<int>& children) const;
+
+
+			/*
+				Create an Icosahedron or Polyhedron, depending on the num of subdivisions.
 				@param subdivisions - the number of subdivisons. 0 creates an Icosahedron;
-				@return - two lists. the first one is the list with all points. 
+				@return - two lists. the first one is the list with all points.
 						  the second one is an index list with all triangles
 						  <vertices, triangle indices >
 			*/
 			static std::pair< vector<glm::vec3>, vector<glm::ivec3> > Create(int subdivisions);
-	
+
 		private:
-			// lookup table 
+			// lookup table
 			typedef  std::map<std::pair<int, int>, int> Lookup;
-			
+
 			/*
 			Create an Icosahedron
 			*/
-			static void CreateIcosahedron(void);
-
+			void createIcosahedron(void);
 
 
-			static int vertex_for_edge(Lookup& lookup, vector<glm::vec3>& vertices, int first, int second);
+			int vertex_for_edge(Lookup& lookup, int first, int second);
 
 			/*
-			Subdivide the Icosahedron triangles
+			Subdivide the triangles of the last level and append the next level.
 			*/
-			static  vector<glm::ivec3> subdivide(vector<glm::vec3>& vertices, vector<glm::ivec3> triangles);
+			void subdivide(void);
+
+
+			// vertices of all levels, and the vertex count per level
+			vector<glm::vec3>			_vertices;
+			vector<int>					_num_vertices;
+
+			// triangles per level
+			vector<vector<glm::ivec3> >	_triangles;
 
+			// parents per vertex
+			vector<glm::ivec2>			_parents;
 
+			// children per level, compressed rows: the children of vertex v of level l
+			// are _child_ids[l][_child_offsets[l][v]] to _child_ids[l][_child_offsets[l][v + 1] - 1]
+			vector<vector<int> >		_child_offsets;
+			vector<vector<int> >		_child_ids;
 
 	};
 
 
-}//namespace arlab
\ No newline at end of file
+}//namespace arlab
@@ -76,6 +76,24 @@ void PolyhedronViewRenderer::create(float camera_distance, int subdivisions)
 		}
 	}
 
+	// keep one view per set of views that are equivalent under the model symmetry.
+	if (_with_symmetry && _symmetry.type != ModelSymmetry::NONE) {
+		vector<int> representative;
+		int N = ModelSymmetry::Reduce(_symmetry, _points, representative);
+
+		cout << "[INFO] - Symmetry " << ModelSymmetry::ToString(_symmetry) << ": reduced " << _points.size() << " views to " << N << "." << endl;
+
+		vector<glm::vec3> points;
+		vector<glm::vec3> normals;
+		for (int i = 0; i < _points.size(); i++) {
+			if (representative[i] != i) continue;
+			points.push_back(_points[i]);
+			normals.push_back(_normals[i]);
+		}
+		_points = points;
+		_normals = normals;
+	}
+
 	_N = _points.size();
 	
 	if(_verbose)
@@ -109,13 +127,8 @@ bool PolyhedronViewRenderer::draw_sequence(void)
 
 
 		// This prevents that the view matrix becomes NaN when eye and up vector align. 
-		float ang = glm::dot(glm::normalize(eye), _up);
-		float s = 1.0;
-		if (ang < 0) s = -1.0;
-		if (abs(ang) > 0.999)
-			_up = glm::vec3(0.0, 0.0, -s);
-		else
-			_up = glm::vec3(0.0, 1.0, 0.0);
+		// The symmetry reduction compares views with the same up-vector.
+		_up = ModelSymmetry::CameraUp(eye);
 
 
 		glm::mat4 vm = glm::lookAt(eye, _center, _up );
@@ -43,6 +43,10 @@ Jan 21, 2019:
 Aug 8, 2019, RR
 - Added a function that removes all canera viewpoints in the lower hemisphere of the polyhedron. 
 	As a result, the 3D model will only be rendered in its upright position. 
+Oct 19, 2026, RR
+- create() keeps one viewpoint per set of equivalent viewpoints if the symmetry reduction is enabled. 
+	Call setSymmetryReduction() before create(). 
+- The up-vector of the camera comes from ModelSymmetry::CameraUp(), the symmetry reduction compares it.
 */
 
 
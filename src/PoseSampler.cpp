@@ -0,0 +1,132 @@
+#include "PoseSampler.h"
+
+
+/*
+Generate poses from the Halton sequence.
+*/
+//static
+int PoseSampler::Generate(int num_samples, glm::vec3 min_t, glm::vec3 max_t, bool upper_hemisphere,
+	std::vector<glm::quat>& rotations, std::vector<glm::vec3>& translations, int offset)
+{
+	rotations.clear();
+	translations.clear();
+	if (num_samples <= 0) return 0;
+
+	rotations.reserve(num_samples);
+	translations.reserve(num_samples);
+
+	// index 0 is the origin of all dimensions
+	int index = (std::max)(1, offset);
+	int max_index = index + num_samples * 8; // prevents deadlocks with the hemisphere rejection
+
+	while (rotations.size() < num_samples && index < max_index) {
+
+		glm::quat q = UniformRotation(Halton(index, 2), Halton(index, 3), Halton(index, 5));
+		glm::vec3 t = min_t + (max_t - min_t) * glm::vec3(Halton(index, 7), Halton(index, 11), Halton(index, 13));
+		index++;
+
+		// the camera position in object coordinates is R^T * (0, 0, 1). Up is y.
+		if (upper_hemisphere) {
+			glm::vec3 eye = glm::inverse(q) * glm::vec3(0.0f, 0.0f, 1.0f);
+			if (eye.y < 0.0f) continue;
+		}
+
+		rotations.push_back(q);
+		translations.push_back(t);
+	}
+
+	return (int)rotations.size();
+}
+
+
+/*
+Measure the angular spacing of a set of rotations.
+*/
+//static
+PoseSampler::Coverage PoseSampler::CoverageReport(const std::vector<glm::quat>& rotations, int max_queries)
+{
+	Coverage c;
+	int N = (int)rotations.size();
+	c.num_samples = N;
+	if (N < 2) return c;
+
+	int Q = (std::min)(N, (std::max)(1, max_queries));
+	int step = N / Q;
+
+	// nearest neighbor of a subset of the samples, and of random rotations
+	std::vector<float> nn(Q, 0.0f);
+	std::vector<float> probe(Q, 0.0f);
+	std::vector<glm::quat> probes(Q);
+	std::mt19937 rng(1);
+	std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+	for (int i = 0; i < Q; i++) {
+		probes[i] = UniformRotation(uniform(rng), uniform(rng), uniform(rng));
+	}
+
+	cv::parallel_for_(cv::Range(0, Q), [&](const cv::Range& range) {
+		for (int i = range.start; i < range.end; i++) {
+			int s = i * step;
+			float best_s = 3.14159265f;
+			float best_p = 3.14159265f;
+			for (int j = 0; j < N; j++) {
+				if (j != s) best_s = (std::min)(best_s, Angle(rotations[s], rotations[j]));
+				best_p = (std::min)(best_p, Angle(probes[i], rotations[j]));
+			}
+			nn[i] = best_s;
+			probe[i] = best_p;
+		}
+	});
+
+	const float to_deg = 180.0f / 3.14159265f;
+	c.nn_min = *std::min_element(nn.begin(), nn.end()) * to_deg;
+	c.nn_max = *std::max_element(nn.begin(), nn.end()) * to_deg;
+	double sum = 0.0;
+	for (float a : nn) sum += a;
+	c.nn_mean = float(sum / Q) * to_deg;
+	c.covering = *std::max_element(probe.begin(), probe.end()) * to_deg;
+
+	return c;
+}
+
+
+/*
+Return element 'index' of the Halton sequence for a prime base, in [0, 1).
+*/
+//static
+float PoseSampler::Halton(int index, int base)
+{
+	double f = 1.0;
+	double r = 0.0;
+	while (index > 0) {
+		f = f / base;
+		r = r + f * (index % base);
+		index = index / base;
+	}
+	return (float)r;
+}
+
+
+/*
+Map three numbers in [0, 1) onto a uniformly distributed unit quaternion (Shoemake).
+*/
+//static
+glm::quat PoseSampler::UniformRotation(float u1, float u2, float u3)
+{
+	const float two_pi = 6.28318531f;
+	float a = sqrt(1.0f - u1);
+	float b = sqrt(u1);
+
+	// glm::quat(w, x, y, z)
+	return glm::quat(b * cos(two_pi * u3), a * sin(two_pi * u2), a * cos(two_pi * u2), b * sin(two_pi * u3));
+}
+
+
+/*
+Return the geodesic angle between two rotations in radians.
+*/
+//static
+float PoseSampler::Angle(const glm::quat& q0, const glm::quat& q1)
+{
+	float d = fabs(glm::dot(q0, q1));
+	return 2.0f * acos((std::min)(1.0f, d));
+}
@@ -0,0 +1,111 @@
+/*
+class PoseSampler
+
+Generates object poses, rotations and translations, from a low-discrepancy sequence.
+A 6D Halton sequence (bases 2, 3, 5, 7, 11, 13) is mapped onto SO(3) x box:
+the first three dimensions become a rotation using Shoemake's uniform quaternion mapping,
+the last three dimensions become a translation within the given limits.
+In contrast to i.i.d. random poses, the samples do not cluster. Thus, equal coverage of
+the pose space requires fewer samples.
+
+The coverage report measures the achieved angular spacing of the rotations
+(geodesic angle on SO(3), in degrees).
+
+Usage:
+std::vector<glm::quat> rotations;
+std::vector<glm::vec3> translations;
+PoseSampler::Generate(1000, glm::vec3(-1, -1, -3), glm::vec3(1, 1, -1.5), false, rotations, translations);
+PoseSampler::Coverage c = PoseSampler::CoverageReport(rotations);
+
+Rafael Radkowski
+Iowa State University
+rafael@iastate.edu
+Oct 2026
+MIT license
+----------------------------------------------------
+last edited:
+
+*/
+#pragma once
+
+// stl
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <random>
+
+// opencv
+#include <opencv2/opencv.hpp>
+
+// GLM include files
+#define GLM_FORCE_INLINE
+#include <glm/glm.hpp>
+#include <glm/gtx/quaternion.hpp> // quaternions
+
+
+class PoseSampler
+{
+public:
+
+	/*
+	Rotation coverage, all angles in degrees.
+	*/
+	typedef struct _Coverage {
+		int		num_samples;
+		float	nn_min;		// smallest angle between a sample and its nearest neighbor
+		float	nn_mean;	// mean angle between a sample and its nearest neighbor
+		float	nn_max;		// largest angle between a sample and its nearest neighbor
+		float	covering;	// largest angle between a random rotation and its nearest sample (estimate)
+
+		_Coverage()
+		{
+			num_samples = 0;
+			nn_min = 0.0f;
+			nn_mean = 0.0f;
+			nn_max = 0.0f;
+			covering = 0.0f;
+		}
+	}Coverage;
+
+
+	/*
+	Generate poses from the Halton sequence.
+	@param num_samples - the number of poses to generate.
+	@param min_t, max_t - the translation limits.
+	@param upper_hemisphere - only accept rotations that view the object from the upper hemisphere (y >= 0).
+	@param rotations - location for the rotations, from object to camera coordinates.
+	@param translations - location for the translations.
+	@param offset - the first index of the sequence, use it to continue a sequence.
+	@return the number of generated poses.
+	*/
+	static int Generate(int num_samples, glm::vec3 min_t, glm::vec3 max_t, bool upper_hemisphere,
+		std::vector<glm::quat>& rotations, std::vector<glm::vec3>& translations, int offset = 1);
+
+
+	/*
+	Measure the angular spacing of a set of rotations.
+	The nearest neighbor angles and the covering radius are estimated with up to max_queries query rotations.
+	@param rotations - the rotations.
+	@param max_queries - the max. number of query rotations.
+	@return the coverage.
+	*/
+	static Coverage CoverageReport(const std::vector<glm::quat>& rotations, int max_queries = 2000);
+
+
+	/*
+	Return element 'index' of the Halton sequence for a prime base, in [0, 1).
+	*/
+	static float Halton(int index, int base);
+
+
+	/*
+	Map three numbers in [0, 1) onto a uniformly distributed unit quaternion (Shoemake).
+	*/
+	static glm::quat UniformRotation(float u1, float u2, float u3);
+
+
+	/*
+	Return the geodesic angle between two rotations in radians.
+	*/
+	static float Angle(const glm::quat& q0, const glm::quat& q1);
+};
@@ -18,9 +18,16 @@ RandomImageGenerator::RandomImageGenerator(int image_height, int image_widht) :
 	_rendering_widht = image_widht;
 
 	_with_chromatic_adpat = false;
+	_with_histogram_adapt = false;
 	_wtih_noise_adapt = false;
 	_noise_sigma = 0.1;
 	_noise_mean = 0.0;
+	_noise_type = NoiseFilter::GAUSSIAN;
+	_noiseFilter.setNoise(_noise_type, _noise_mean, _noise_sigma);
+
+	_bg_samples = 1;
+	_crop_scale_min = 1.0f;
+	_crop_scale_max = 1.0f;
 }
 
 RandomImageGenerator::~RandomImageGenerator()
@@ -72,6 +79,7 @@ The parameters param1 and param2 depend on the filter to be set.
 @param param1 - depends on the filter to set. 
 			For NOISE: param1: sigma, param2: mean
 			For CHROMATIC: no parameters
+			For HISTOGRAM: no parameters
 */
 void RandomImageGenerator::setFilter(Filtertype type, bool enable, float param1, float param2)
 {
@@ -80,11 +88,48 @@ void RandomImageGenerator::setFilter(Filtertype type, bool enable, float param1,
 		_wtih_noise_adapt = enable;
 		_noise_sigma = param1;
 		_noise_mean = param2;
+		_noiseFilter.setNoise(_noise_type, _noise_mean, _noise_sigma);
 		break;
 	case CHROMATIC:
 		_with_chromatic_adpat = enable;
 		break;
+	case HISTOGRAM:
+		_with_histogram_adapt = enable;
+		break;
+	}
+}
+
+
+/*
+Set the noise type for the NOISE filter. 
+@param type - GAUSSIAN, SPECKLE, or POISSON. GAUSSIAN is the default.
+@param seed - a seed for reproducible noise. A random seed is used if seed < 0.
+*/
+void RandomImageGenerator::setNoiseType(NoiseFilter::NoiseType type, int seed)
+{
+	_noise_type = type;
+	_noiseFilter.setNoise(_noise_type, _noise_mean, _noise_sigma);
+	if (seed >= 0) {
+		_noiseFilter.setSeed((unsigned int)seed);
+	}
+}
+
+
+/*
+Set the number of samples generated from each decoded background image. 
+@param samples - the number of samples per background image, >= 1.
+@param scale_min, scale_max - the range of the window scale, (0, 1].
+*/
+void RandomImageGenerator::setBackgroundSampling(int samples, float scale_min, float scale_max)
+{
+	if (samples < 1 || scale_min <= 0.0f || scale_max > 1.0f || scale_min > scale_max) {
+		std::cout << "[ERROR] - Invalid background sampling parameters. Samples must be >= 1 and 0 < scale_min <= scale_max <= 1." << std::endl;
+		return;
 	}
+
+	_bg_samples = samples;
+	_crop_scale_min = scale_min;
+	_crop_scale_max = scale_max;
 }
 
 
@@ -159,15 +204,10 @@ int RandomImageGenerator::process_combine(int num_images)
         if(backup_i > num_images*3) break;
 
         int dice_image = distribution(generator); 
-        int dice_rendering = distribution_render(generator);
         //cout << dice_image << " : " << image_filenames[dice_image] << "\n";
 
-		// Get the image paths. 
+		// Get the image path. 
         string path0 = image_filenames[dice_image];
-        string path1 = rendered_files[dice_rendering].rgb_file;
-		string path2 = rendered_files[dice_rendering].normal_file;
-		string path3 = rendered_files[dice_rendering].depth_file;
-		string path4 = rendered_files[dice_rendering].maske_file;
 
 		//----------------------------------------------
 		// Read the background image and check if its ok.
@@ -181,126 +221,149 @@ int RandomImageGenerator::process_combine(int num_images)
         
         if(r < int(_image_height / 2) || c < int(_image_widht / 2) ) continue; // image too tiny
 
-        cv::Mat img_resized = adaptImage(img);
-
 		//----------------------------------------------
-		// process renderer images
+		// Generate multiple samples from one decoded background image. 
+		// Each sample uses a different crop window and a different rendering.
 
-        cv::Mat rendering = cv::imread(path1);
-		if(rendering.rows == 0||rendering.cols == 0){
-			std::cout << "[ERROR] - Did not find image " << path1 << ". Check the path." << std::endl;
-		}
+		bool with_windows = _bg_samples > 1 || _crop_scale_min < 1.0f;
 
-        int roi_x, roi_y, roi_width, roi_height;
-        cv::Mat rendered_image = adaptRendering(rendering, roi_x, roi_y, roi_width, roi_height);
-        //cout << roi_x << " : " << roi_y << "\n";
+		for (int k = 0; k < _bg_samples && i < num_images; k++) {
 
+			int dice_rendering = distribution_render(generator);
 
-		//----------------------------------------------
-		// Chromatic adaptation and noise filtering
-		if (_with_chromatic_adpat) {
-			_imageFilter.setChromaticTemplate(img_resized);
-			_imageFilter.apply(rendered_image, rendered_image);
-		}
+			// Get the rendering paths. 
+	        string path1 = rendered_files[dice_rendering].rgb_file;
+			string path2 = rendered_files[dice_rendering].normal_file;
+			string path3 = rendered_files[dice_rendering].depth_file;
+			string path4 = rendered_files[dice_rendering].maske_file;
 
-		if (_wtih_noise_adapt) {
-			rendered_image = NoiseFilter::AddGaussianNoise(rendered_image, _noise_mean, _noise_sigma);
-		}
+			cv::Mat img_resized;
+			if (with_windows) {
+				cv::Rect window = randomWindow(img, generator);
+				cv::resize(img(window), img_resized, cv::Size(_image_height, _image_widht));
+			}
+			else {
+				img_resized = adaptImage(img);
+			}
 
+			//----------------------------------------------
+			// process renderer images
 
-		//----------------------------------------------
-		// Combine foreground with background
+	        cv::Mat rendering = cv::imread(path1);
+			if(rendering.rows == 0||rendering.cols == 0){
+				std::cout << "[ERROR] - Did not find image " << path1 << ". Check the path." << std::endl;
+			}
 
-        cv::Mat ready_rgb = combineImages(img_resized, rendered_image, 0.0);
-		cv::Mat output = ready_rgb.clone();
-		cv::rectangle( output, cv::Point(roi_x, roi_y), cv::Point(roi_x + roi_width, roi_y + roi_height), cv::Scalar(255,0,0));
-		
+	        PlacementTransform transform = renderingTransform(rendering);
+			cv::Rect roi = transformRoI(rendered_files[dice_rendering].roi, transform);
 
-		//-----------------------------------------------------------------------------
-		// normal processing
 
-		// calculate the normal map
-		cv::Mat img_normals;
-		NormalMapSobel::EstimateNormalMap(img_resized, img_normals, 3, 25);
+			//----------------------------------------------
+			// Resize, chromatic adaptation, noise filtering, and combining foreground with background.
+			// The graph runs all steps band by band in one pass. 
+			// The foreground mask is computed before the noise is added so that noise cannot change the foreground.
 
-		// process normal image
-		cv::Mat rendering_normals = cv::imread(path2, cv::IMREAD_ANYDEPTH | cv::IMREAD_UNCHANGED); // 16UC3
-		if(rendering_normals.rows == 0||rendering_normals.cols == 0){
-			std::cout << "[ERROR] - Did not find normal map " << path2 << ". Check the path." << std::endl;
-		}
-		cv::Mat rendering_normals_32F;
-		rendering_normals.convertTo(rendering_normals_32F, CV_32FC3, 1.0/65534.0);
+			_graph.clear();
+			_graph.setBackground(img_resized);
+			_graph.setForeground(rendering);
 
-	//	cout << MatHelpers::Type2str(rendering_normals.type()) << endl;
-	//	cv::imshow("in_normals", rendering_normals );
-	//	cv::imshow("out_normals", rendering_normals_32F );
-    //    cv::waitKey();
+			if (_with_chromatic_adpat || _with_histogram_adapt) {
+				_imageFilter.setFilterMethod(_with_histogram_adapt ? ImageFilter::HISTOGRAM : ImageFilter::CHROMATIC);
+				_graph.addColorAdaptation(&_imageFilter);
+			}
 
+			if (_wtih_noise_adapt) {
+				_graph.addNoise(&_noiseFilter);
+			}
+			_graph.addComposite(0);
 
-        int r_n = rendering_normals.rows;
-        int c_n = rendering_normals.cols;
-		cv::Mat rendered_normals2;
-		cv::resize(rendering_normals_32F, rendered_normals2, cv::Size(_rendering_height, _rendering_widht ));
-		cv::Mat ready_normals = combineNormals(img_normals, rendered_normals2, rendered_image,  0);
+			cv::Mat ready_rgb, fg_mask;
+			if (!_graph.compile(cv::Size(_rendering_height, _rendering_widht)) || !_graph.run(ready_rgb, fg_mask)) {
+				continue;
+			}
+			cv::Mat output = ready_rgb.clone();
+			cv::rectangle( output, roi, cv::Scalar(255,0,0));
 		
 
-		//-----------------------------------------------------------------------------
-		// Read and resize depth file
-		cv::Mat ready_depth;
-		cv::Mat img_depth = cv::imread(path3,  cv::IMREAD_UNCHANGED | cv::IMREAD_ANYDEPTH); // 16UC3
-		if(img_depth.rows == 0||img_depth.cols == 0){
-			std::cout << "[ERROR] - Did not find the depth image " << path3 << ". Check the path." << std::endl;
-		}else
-			cv::resize(img_depth, ready_depth, cv::Size(_rendering_height, _rendering_widht ));
-
+			//-----------------------------------------------------------------------------
+			// normal processing
 
-		//-----------------------------------------------------------------------------
-		// Read and resize mask file
-		cv::Mat ready_mask;
-		cv::Mat img_mask = cv::imread(path4,  cv::IMREAD_UNCHANGED | cv::IMREAD_ANYDEPTH); // 16UC3
-		if(img_mask.rows == 0||img_mask.cols == 0){
-			std::cout << "[ERROR] - Did not find the depth image " << path3 << ". Check the path." << std::endl;
-		}else
-			cv::resize(img_mask, ready_mask, cv::Size(_rendering_height, _rendering_widht ));
-
-
-		//-----------------------------------------------------------------------------
-		// Scale the control points so that they meet the new image size. 
+			// calculate the normal map
+			cv::Mat img_normals;
+			NormalMapSobel::EstimateNormalMap(img_resized, img_normals, 3, 25);
 
-		ControlPointsHelper::CPType cptype;
-		std::vector<glm::vec2> cpoints;
-		std::vector<glm::vec2> cpoint_new;
-		ControlPointsHelper::Read(rendered_files[dice_rendering].control_point_file, cptype, cpoints);
-
-		float scale_x = float(_rendering_height)/float(rendering.rows);
-		float scale_y = float(_rendering_widht)/float(rendering.cols);
-
-		for each(glm::vec2 p in cpoints){
-			cpoint_new.push_back(glm::vec2(scale_x* p.x, scale_y * p.y) );
-		}
-		ControlPointsHelper::Write("temp_cp.txt", cptype, cpoint_new);
-
-		//-----------------------------------------------------------------------------
-		// write data to file
+			// process normal image
+			cv::Mat rendering_normals = cv::imread(path2, cv::IMREAD_ANYDEPTH | cv::IMREAD_UNCHANGED); // 16UC3
+			if(rendering_normals.rows == 0||rendering_normals.cols == 0){
+				std::cout << "[ERROR] - Did not find normal map " << path2 << ". Check the path." << std::endl;
+			}
+			cv::Mat rendering_normals_32F;
+			rendering_normals.convertTo(rendering_normals_32F, CV_32FC3, 1.0/65534.0);
 
+		//	cout << MatHelpers::Type2str(rendering_normals.type()) << endl;
+		//	cv::imshow("in_normals", rendering_normals );
+		//	cv::imshow("out_normals", rendering_normals_32F );
+	    //    cv::waitKey();
 
-		writeDataEx(i, ready_rgb, ready_normals, ready_depth, ready_mask, rendered_files[dice_rendering], cv::Rect(roi_x, roi_y, roi_width, roi_height));
 
-        cv::imshow("out",output );
-		cv::Mat img_normals_out;
-		//cv::cvtColor(img_normals, img_normals_out, cv::COLOR_RGB2BGR);
-		cv::imshow("out_normals", ready_normals );
-        cv::waitKey(1);
-		//Sleep(0.015);
-        i++;
+	        int r_n = rendering_normals.rows;
+	        int c_n = rendering_normals.cols;
+			cv::Mat rendered_normals2;
+			cv::resize(rendering_normals_32F, rendered_normals2, cv::Size(_rendering_height, _rendering_widht ));
+			cv::Mat ready_normals = combineNormals(img_normals, rendered_normals2, fg_mask);
+		
 
-		// progress ticker
-		if (i > 1 && i % 100 == 0) {
-			cout << ". ";
-			if (i % 1000 == 0) {
-				cout << " [" <<i << "/"<< num_images<< "]\n";
+			//-----------------------------------------------------------------------------
+			// Read and resize depth file
+			cv::Mat ready_depth;
+			cv::Mat img_depth = cv::imread(path3,  cv::IMREAD_UNCHANGED | cv::IMREAD_ANYDEPTH); // 16UC3
+			if(img_depth.rows == 0||img_depth.cols == 0){
+				std::cout << "[ERROR] - Did not find the depth image " << path3 << ". Check the path." << std::endl;
+			}else
+				cv::resize(img_depth, ready_depth, cv::Size(_rendering_height, _rendering_widht ));
+
+
+			//-----------------------------------------------------------------------------
+			// Read and resize mask file
+			cv::Mat ready_mask;
+			cv::Mat img_mask = cv::imread(path4,  cv::IMREAD_UNCHANGED | cv::IMREAD_ANYDEPTH); // 16UC3
+			if(img_mask.rows == 0||img_mask.cols == 0){
+				std::cout << "[ERROR] - Did not find the depth image " << path3 << ". Check the path." << std::endl;
+			}else
+				cv::resize(img_mask, ready_mask, cv::Size(_rendering_height, _rendering_widht ));
+
+
+			//-----------------------------------------------------------------------------
+			// Transform the control points so that they meet the new image size. 
+
+			ControlPointsHelper::CPType cptype = ControlPointsHelper::NONE;
+			std::vector<glm::vec2> cpoints;
+			std::vector<glm::vec2> cpoint_new;
+			ControlPointsHelper::Read(rendered_files[dice_rendering].control_point_file, cptype, cpoints);
+			transformControlPoints(cpoints, transform, cpoint_new);
+
+			//-----------------------------------------------------------------------------
+			// write data to file
+
+
+			writeDataEx(i, ready_rgb, ready_normals, ready_depth, ready_mask, rendered_files[dice_rendering], roi, cptype, cpoint_new);
+
+	        cv::imshow("out",output );
+			cv::Mat img_normals_out;
+			//cv::cvtColor(img_normals, img_normals_out, cv::COLOR_RGB2BGR);
+			cv::imshow("out_normals", ready_normals );
+	        cv::waitKey(1);
+			//Sleep(0.015);
+	        i++;
+
+			// progress ticker
+			if (i > 1 && i % 100 == 0) {
+				cout << ". ";
+				if (i % 1000 == 0) {
+					cout << " [" <<i << "/"<< num_images<< "]\n";
+				}
 			}
-		}
+		} // end samples
     }
 
    // cout << "[INFO] - Created " << i << " images." << endl;
@@ -354,10 +417,11 @@ int RandomImageGenerator::process_rendering(void)
 		if(rendering.rows == 0||rendering.cols == 0){
 			std::cout << "[ERROR] - Did not find image " << path1 << ". Check the path." << std::endl;
 		}
-        int roi_x, roi_y, roi_width, roi_height;
-        cv::Mat ready_rgb = adaptRendering(rendering, roi_x, roi_y, roi_width, roi_height);
+        PlacementTransform transform;
+        cv::Mat ready_rgb = adaptRendering(rendering, transform);
+		cv::Rect roi = transformRoI(rendered_files[dice_rendering].roi, transform);
 		cv::Mat output = ready_rgb.clone();
-		cv::rectangle( output, cv::Point(roi_x, roi_y), cv::Point(roi_x + roi_width, roi_y + roi_height), cv::Scalar(255,0,0));
+		cv::rectangle( output, roi, cv::Scalar(255,0,0));
 		
 
 		//-----------------------------------------------------------------------------
@@ -380,7 +444,7 @@ int RandomImageGenerator::process_rendering(void)
 		// write data to file
 
 
-		writeData(i, ready_rgb, ready_normals, rendered_files[dice_rendering], cv::Rect(roi_x, roi_y, roi_width, roi_height));
+		writeData(i, ready_rgb, ready_normals, rendered_files[dice_rendering], roi);
 
         cv::imshow("out",output );
 		cv::Mat img_normals_out;
@@ -402,7 +466,7 @@ Adapt the loaded image to geometric constraints.
 */
 cv::Mat RandomImageGenerator::adaptImage(cv::Mat& image)
 {
-    static float aspect = float(_image_height) / float(_image_widht);
+    float aspect = float(_image_height) / float(_image_widht);
 
     int r = image.rows;
     int c = image.cols;
@@ -428,113 +492,120 @@ cv::Mat RandomImageGenerator::adaptImage(cv::Mat& image)
 
 
 
-cv::Mat RandomImageGenerator::adaptRendering(cv::Mat& image, int& x, int& y, int& width, int& height)
+/*
+Draw a random crop window with the output aspect ratio from an image.
+The window size is scale * the largest window that fits into the image, with 
+scale in [_crop_scale_min, _crop_scale_max]. The position is uniformly distributed. 
+*/
+cv::Rect RandomImageGenerator::randomWindow(cv::Mat& image, std::random_device& generator)
 {
-    static float aspect = float(_rendering_height) / float(_rendering_widht);
-    int r = image.rows;
-    int c = image.cols;
-    
-    float a = float(r)/float(c);
+	// the output image is cv::Size(_image_height, _image_widht), i.e., cols x rows
+	float aspect = float(_image_height) / float(_image_widht);
+
+	// largest window with the output aspect ratio
+	float w_max = (std::min)(float(image.cols), float(image.rows) * aspect);
+	float h_max = w_max / aspect;
+
+	std::uniform_real_distribution<float> distribution_scale(_crop_scale_min, _crop_scale_max);
+	float scale = distribution_scale(generator);
+
+	int w = (std::max)(1, (std::min)(image.cols, int(w_max * scale + 0.5f)));
+	int h = (std::max)(1, (std::min)(image.rows, int(h_max * scale + 0.5f)));
+
+	std::uniform_int_distribution<int> distribution_x(0, image.cols - w);
+	std::uniform_int_distribution<int> distribution_y(0, image.rows - h);
+
+	return cv::Rect(distribution_x(generator), distribution_y(generator), w, h);
+}
+
 
+/*
+Adapt the aspect ratio of the rendering to meet the output aspect ratio.
+The RoI is not searched in the image anymore. It is transformed with 'transform', see transformRoI().
+*/
+cv::Mat RandomImageGenerator::adaptRendering(cv::Mat& image, PlacementTransform& transform)
+{
     cv::Mat result;
     cv::resize(image, result, cv::Size(_rendering_height, _rendering_widht ));
-    
-
-    //cv::imshow("searrch",result );
-   // cv::waitKey(1);
-
-    // find roi
-    x = _rendering_widht;
-    y = _rendering_height;
-    width = 1;
-    height = 1;
-
-    cv::Vec3b last_pixel(0,0,0);
-	int xr = 0;
-	int yd = 0;
-
-    for(int i =0; i<result.rows; i++){
-        for(int j =0; j<result.cols; j++){
-            cv::Vec3b col = result.at<cv::Vec3b>(i,j);
-            // search for the first not 0 pixel
-            bool all_zero =false;
-            if(col[0] > 0 || col[1] > 0 || col[2] > 0){
-                all_zero = true;
-                if(j < x){
-                    x = j;
-                }
-                if(i < y){
-                    y = i;
-                }
-            }
-            // search for the last not zero pixel
-            if(last_pixel[0] > 0 || last_pixel[1] > 0 || last_pixel[2] > 0){
-                if(all_zero == true){
-                    if(j > xr){
-						xr = j;
-                    }
-                    if(i > height + y){
-                        height = i - y;
-                    }
-                }
-            }
-
-			
-
-
-            last_pixel = col;
-        }
-		
-    }
-	width = xr - x;
-
-    x = max((int)0, min((int)x, (int)_rendering_widht));
-    y = max((int)0, min((int)y, (int)_rendering_height));
 
-    width = max(1, min(width, _rendering_widht));
-    height = max(1, min(height, _rendering_height));
+	transform = renderingTransform(image);
 
     return result;
 }
 
 
-
-cv::Mat RandomImageGenerator::combineImages(cv::Mat image1, cv::Mat image2, int threshold_value)
+/*
+Return the transform adaptRendering applies to a rendering.
+*/
+RandomImageGenerator::PlacementTransform RandomImageGenerator::renderingTransform(cv::Mat& image)
 {
+	// adaptRendering resizes to cv::Size(_rendering_height, _rendering_widht), i.e., cols x rows
+	PlacementTransform transform;
+	transform.sx = float(_rendering_height) / float(image.cols);
+	transform.sy = float(_rendering_widht) / float(image.rows);
+	transform.tx = 0.0f;
+	transform.ty = 0.0f;
+
+	return transform;
+}
 
-	// find the rendering first by assuming that the background is black. 
-    cv::Mat img, mask, grayscaleMat;
-    img = image2.clone();
-    cvtColor(img, grayscaleMat, CV_RGB2GRAY);
-    cv::threshold(grayscaleMat, mask, threshold_value, 255, CV_THRESH_BINARY);
 
-    cv::Mat result, mask_inv;
-    cv::bitwise_not(mask, mask_inv);
-    cv::bitwise_or(image1, image1, result, mask_inv );
-    cv::bitwise_or(result, image2, result, mask );
+/*
+Transform the region of interest stored in the render log into the output image. 
+*/
+cv::Rect RandomImageGenerator::transformRoI(const cv::Rect2f& roi, const PlacementTransform& transform)
+{
+	int x0 = (int)std::floor(transform.sx * roi.x + transform.tx);
+	int y0 = (int)std::floor(transform.sy * roi.y + transform.ty);
+	int x1 = (int)std::ceil(transform.sx * (roi.x + roi.width) + transform.tx);
+	int y1 = (int)std::ceil(transform.sy * (roi.y + roi.height) + transform.ty);
+
+	// same limits the former pixel scan applied
+	int x = max((int)0, min(x0, (int)_rendering_height));
+	int y = max((int)0, min(y0, (int)_rendering_widht));
+	int width = max(1, min(x1 - x, _rendering_height - x));
+	int height = max(1, min(y1 - y, _rendering_widht - y));
+
+	return cv::Rect(x, y, width, height);
+}
 
 
-    //cv::imshow("th",mask );
-    //cv::waitKey(1);
+/*
+Transform control points into the output image. 
+*/
+void RandomImageGenerator::transformControlPoints(const std::vector<glm::vec2>& points, const PlacementTransform& transform, std::vector<glm::vec2>& points_out)
+{
+	points_out.clear();
+	points_out.reserve(points.size());
+
+	for (const glm::vec2& p : points) {
+		// keep the out-of-frame marker
+		if (p.x == -1.0f && p.y == -1.0f) {
+			points_out.push_back(p);
+			continue;
+		}
 
-    return result;
+		float u = transform.sx * p.x + transform.tx;
+		float v = transform.sy * p.y + transform.ty;
+
+		if (u < 0.0f || u > float(_rendering_height) || v < 0.0f || v > float(_rendering_widht)) {
+			u = -1.0f;
+			v = -1.0f;
+		}
+		points_out.push_back(glm::vec2(u, v));
+	}
 }
 
 
-cv::Mat RandomImageGenerator::combineNormals(cv::Mat image1, cv::Mat image2, cv::Mat image_rgb, int threshold_value)
+
+cv::Mat RandomImageGenerator::combineNormals(cv::Mat image1, cv::Mat image2, cv::Mat& mask)
 {
-    cv::Mat img, mask, grayscaleMat;
-    img = image_rgb.clone();
-    cvtColor(img, grayscaleMat, CV_RGB2GRAY);
-    cv::threshold(grayscaleMat, mask, threshold_value, 255, CV_THRESH_BINARY);
     cv::Mat result, mask_inv;
     cv::bitwise_not(mask, mask_inv);
     cv::bitwise_or(image1, image1, result, mask_inv );
     cv::bitwise_or(result, image2, result, mask );
 	//cout << MatHelpers::Type2str(image2.type()) << endl;
 	//cout << MatHelpers::Type2str(image1.type()) << endl;
-    //cv::imshow("th",mask );
-    //cv::waitKey(1);
 
     return result;
 }
@@ -648,7 +719,8 @@ bool RandomImageGenerator::writeData(int id,  cv::Mat& image_rgb, cv::Mat& image
 
 
 
-bool RandomImageGenerator::writeDataEx(int id, cv::Mat& image_rgb, cv::Mat& image_normal, cv::Mat& image_depth, cv::Mat& image_mask, ImageLogReader::ImageLog& data, cv::Rect& roi)
+bool RandomImageGenerator::writeDataEx(int id, cv::Mat& image_rgb, cv::Mat& image_normal, cv::Mat& image_depth, cv::Mat& image_mask, ImageLogReader::ImageLog& data, cv::Rect& roi,
+									   ControlPointsHelper::CPType cptype, std::vector<glm::vec2>& control_points)
 {
 	//----------------------------------------------
 	// RGB image
@@ -752,9 +824,6 @@ bool RandomImageGenerator::writeDataEx(int id, cv::Mat& image_rgb, cv::Mat& imag
 
 	//----------------------------------------------
 	// Control points
-	ControlPointsHelper::CPType cptype;
-	std::vector<glm::vec2> cpoints;
-	ControlPointsHelper::Read("temp_cp.txt", cptype, cpoints);
 
 	string name_cp = _output_path;
 	name_cp.append("/");
@@ -775,7 +844,7 @@ bool RandomImageGenerator::writeDataEx(int id, cv::Mat& image_rgb, cv::Mat& imag
 
 	}
 
-	ControlPointsHelper::Write(name_cp, cptype, cpoints);
+	ControlPointsHelper::Write(name_cp, cptype, control_points);
 
 
 	//----------------------------------------------
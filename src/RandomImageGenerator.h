@@ -26,6 +26,14 @@ Dec 10, 2019, RR:
 June 6, 2020, RR:
 - Included #include "ControlPointsHelper.h"
 - Added code to read control points from a file, to scale them if necessary, and to write them to a new location.
+Oct 19, 2026, RR:
+- Removed the RoI pixel scan from adaptRendering. The RoI from the render log is transformed with the resize transform.
+- Control points are transformed in memory and passed to writeDataEx. The temp_cp.txt round trip is gone.
+- Added the HISTOGRAM filter type to match the rendering histogram to the background.
+- The noise filter uses a NoiseFilter instance with a precomputed noise tile pool.
+- Resize, chromatic adaptation, noise, and combining the rgb images run in one pass in an AugmentationGraph. 
+  The graph also returns the foreground mask, which combineNormals uses. createMask() and combineImages() were removed.
+- Each decoded background image can yield multiple samples using random crop windows, see setBackgroundSampling().
 */
 
 
@@ -49,6 +57,7 @@ June 6, 2020, RR:
 #include "NoiseFilter.h" // for noise
 #include "FileUtils.h"
 #include "ControlPointsHelper.h"
+#include "AugmentationGraph.h" // fused resize, color, noise, and composite pass
 
 using namespace std;
 
@@ -59,9 +68,29 @@ public:
 
 	typedef enum {
 		NOISE,
-		CHROMATIC
+		CHROMATIC,
+		HISTOGRAM
 	} Filtertype;
 
+	/*
+	Maps a pixel (u, v) of the original rendering into the output image:
+	u' = sx * u + tx, v' = sy * v + ty
+	*/
+	typedef struct _PlacementTransform {
+		float sx;
+		float sy;
+		float tx;
+		float ty;
+
+		_PlacementTransform()
+		{
+			sx = 1.0f;
+			sy = 1.0f;
+			tx = 0.0f;
+			ty = 0.0f;
+		}
+	}PlacementTransform;
+
     /*
     Constructor
     @param image_height, image_width - the output image size in pixels. 
@@ -94,14 +123,34 @@ public:
 	/*
 	Set a filter and its parameters. The filter to be change is set with 'type'
 	The parameters param1 and param2 depend on the filter to be set.
-	@param type - a filter of type Filtertype, NOISE or CHROMATIC
+	@param type - a filter of type Filtertype, NOISE, CHROMATIC, or HISTOGRAM
 	@param enable - enable or disable this filter with true or false. Default is false. 
 	@param param1 - depends on the filter to set. 
 				For NOISE: param1: sigma, param2: mean
 				For CHROMATIC: no parameters
+				For HISTOGRAM: no parameters. Histogram matching replaces the chromatic adaptation if both are enabled.
 	*/
 	void setFilter(Filtertype type, bool enable, float param1, float param2);
 
+
+	/*
+	Set the noise type for the NOISE filter. 
+	@param type - GAUSSIAN, SPECKLE, or POISSON. GAUSSIAN is the default.
+	@param seed - a seed for reproducible noise. A random seed is used if seed < 0.
+	*/
+	void setNoiseType(NoiseFilter::NoiseType type, int seed = -1);
+
+
+	/*
+	Set the number of samples generated from each decoded background image. 
+	Each sample uses a random crop window with the output aspect ratio and combines it with a different rendering. 
+	The window size is scale * the largest window that fits into the background image.
+	By default, one sample per background image is generated and the image is adapted with adaptImage().
+	@param samples - the number of samples per background image, >= 1.
+	@param scale_min, scale_max - the range of the window scale, (0, 1].
+	*/
+	void setBackgroundSampling(int samples, float scale_min, float scale_max);
+
     /*
     Start processing.
 	The function distinguises the "combine" mode and the "rendering only" mode using the 
@@ -139,39 +188,64 @@ private:
     */
     cv::Mat adaptImage(cv::Mat& image);
 
+
+	/*
+	Draw a random crop window with the output aspect ratio from an image.
+	@param image - the background image. 
+	@param generator - the random number generator.
+	@return the window in image pixels.
+	*/
+	cv::Rect randomWindow(cv::Mat& image, std::random_device& generator);
+
 	
     /*
     Adapt the aspect ratio of the rendering to meet the output aspect ratio.
-	ToDo: Note that this function currently alsow looks for the ROI. 
-	This is legacy code which can be removed. 
 	@param iamge - the input image of type CV_8UC3
+	@param transform - returns the transform that maps rendering pixels to output pixels.
 	@return - the adapted output image
     */
-    cv::Mat adaptRendering(cv::Mat& image, int& x, int& y, int& width, int& height);
+    cv::Mat adaptRendering(cv::Mat& image, PlacementTransform& transform);
 
 
 	/*
-	Combine the background image with a foreground image. 
-	Note that this function assumes that the entire background of the rendererd image is black. 
-	If not, the function will not work since it applies a bitwise or operation to combine images 
-	@param image1 - the background image. 
-	@param image2 - the rendering, it must have a black background with all values (0,0,0)
-	@param threshold - the threshold to segment the rendered background from its foreground. 
-	@return the combine image stack. 
+	Return the transform adaptRendering applies to a rendering, without resizing it. 
+	@param image - the rendering
+	@return the resize transform
 	*/
-    cv::Mat combineImages(cv::Mat image1, cv::Mat image2, int threshold);
+	PlacementTransform renderingTransform(cv::Mat& image);
+
+
+	/*
+	Transform the region of interest stored in the render log into the output image. 
+	The result is clamped to the output image size. 
+	@param roi - the region of interest of the original rendering. 
+	@param transform - the resize/placement transform from adaptRendering.
+	@return the region of interest in output image coordinates. 
+	*/
+	cv::Rect transformRoI(const cv::Rect2f& roi, const PlacementTransform& transform);
+
+
+	/*
+	Transform control points into the output image. 
+	Points marked as out of frame (-1, -1) stay marked. Points that leave the 
+	output image are marked with (-1, -1), as PointProjection does. 
+	@param points - the control points of the original rendering in (u, v) pixels. 
+	@param transform - the resize/placement transform from adaptRendering.
+	@param points_out - location for the transformed points. 
+	*/
+	void transformControlPoints(const std::vector<glm::vec2>& points, const PlacementTransform& transform, std::vector<glm::vec2>& points_out);
+
 
 	/*
 	Combine the background normal map with the foreground normal map. 
-	Note that this function assumes that the entire background of the rendererd image is black. 
-	If not, the function will not work since it applies a bitwise or operation to combine images 
-	@param image1 - the background image. 
-	@param image2 - the rendering, it must have a black background with all values (0,0,0)
-	@param image_rgb - the color rendering. It is used to segment the bunny from its background. 
-	@param threshold - the threshold to segment the rendered background from its foreground. 
-	@return the combine image stack. 
+	@param image1 - the background normal map. 
+	@param image2 - the rendered normal map, resized to the output size.
+	@param mask - the foreground mask (CV_8UC1) that AugmentationGraph::run() returns with the rgb composite. 
+				It is computed from the resized color rendering before the noise step, 
+				so the normals use the same foreground pixels as the rgb image.
+	@return the combined normal map. 
 	*/
-	cv::Mat combineNormals(cv::Mat image1, cv::Mat image2, cv::Mat image_rgb, int threshold);
+	cv::Mat combineNormals(cv::Mat image1, cv::Mat image2, cv::Mat& mask);
 
 	//----------------------------------------
     // File output
@@ -203,9 +277,12 @@ private:
 	@param image_mask - the image mask. 
 	@param data - additional log data such as the image path and files. 
 	@param roi - the region of interest of the rendered object. 
+	@param cptype - the control point type.
+	@param control_points - the control points in output image coordinates. 
 	@return true - if the data was successfully written. 
 	*/
-	bool writeDataEx(int id, cv::Mat& image_rgb, cv::Mat& image_normal, cv::Mat& image_depth,cv::Mat& image_mask, ImageLogReader::ImageLog& data, cv::Rect& roi);
+	bool writeDataEx(int id, cv::Mat& image_rgb, cv::Mat& image_normal, cv::Mat& image_depth,cv::Mat& image_mask, ImageLogReader::ImageLog& data, cv::Rect& roi,
+					 ControlPointsHelper::CPType cptype, std::vector<glm::vec2>& control_points);
 
     //----------------------------------------
     // members
@@ -232,7 +309,16 @@ private:
 
 	ImageFilter		_imageFilter;
 	bool			_with_chromatic_adpat; // enable the chromatic adaptation
+	bool			_with_histogram_adapt; // enable the histogram matching
 	bool			_wtih_noise_adapt; // enable the noise filter
 	float			_noise_sigma; // noise standard deviation
 	float			_noise_mean;
+	NoiseFilter::NoiseType	_noise_type;
+	NoiseFilter		_noiseFilter;
+
+	AugmentationGraph	_graph;
+
+	int				_bg_samples; // samples per decoded background image
+	float			_crop_scale_min; // range of the background crop window scale
+	float			_crop_scale_max;
 };
\ No newline at end of file
@@ -26,6 +26,11 @@ RandomPoseViewRenderer::RandomPoseViewRenderer(int window_width, int window_heig
 	_lim_ny = 2;
 	_lim_pz = -3;
 	_lim_nz = -1;
+
+	_sampler = RANDOM;
+	_min_visible = 0.0f;
+	_num_rejected = 0;
+	_num_failed = 0;
 }
 
 RandomPoseViewRenderer::~RandomPoseViewRenderer()
@@ -92,6 +97,41 @@ void RandomPoseViewRenderer::create(int num_images ,  int subdivisions)
 
 
 
+	// low-discrepancy poses
+	_sampled_rotations.clear();
+	_sampled_translations.clear();
+	_num_rejected = 0;
+	_num_failed = 0;
+	if (_sampler == LOW_DISCREPANCY) {
+		// with the visibility test, draw more candidates and keep the first _N visible ones. 
+		int num_candidates = _min_visible > 0.0f ? 4 * _N : _N;
+		PoseSampler::Generate(num_candidates, glm::vec3(_lim_nx, _lim_ny, _lim_nz), glm::vec3(_lim_px, _lim_py, _lim_pz), _upper_hemisphere, 
+							  _sampled_rotations, _sampled_translations);
+
+		if (_min_visible > 0.0f) {
+			int j = 0;
+			for (int i = 0; i < _sampled_rotations.size() && j < _N; i++) {
+				if (visibleFraction(poseMatrix(_sampled_rotations[i], _sampled_translations[i])) < _min_visible) {
+					_num_rejected++;
+					continue;
+				}
+				_sampled_rotations[j] = _sampled_rotations[i];
+				_sampled_translations[j] = _sampled_translations[i];
+				j++;
+			}
+			_sampled_rotations.resize(j);
+			_sampled_translations.resize(j);
+			cout << "[INFO] - Rejected " << _num_rejected << " poses below the visible fraction " << _min_visible << "." << endl;
+		}
+		if (_sampled_rotations.size() < _N) {
+			cout << "[WARNING] - Only " << _sampled_rotations.size() << " of " << _N << " poses are valid. Check the pose limits." << endl;
+		}
+		_N = _sampled_rotations.size();
+
+		PoseSampler::Coverage c = PoseSampler::CoverageReport(_sampled_rotations);
+		cout << "[INFO] - Pose coverage for " << c.num_samples << " rotations (deg): nearest neighbor min " << c.nn_min << ", mean " << c.nn_mean 
+			 << ", max " << c.nn_max << "; covering radius " << c.covering << "." << endl;
+	}
 	
 	if(_verbose)
 		cout << "[INFO] - Created " << _N << " coordinates around a sphere." << endl;
@@ -144,6 +184,26 @@ void RandomPoseViewRenderer::setHemisphere(bool upright)
 	_upper_hemisphere = upright;
 }
 
+
+/*
+Set the pose sampler. RANDOM is the default. 
+@param type - RANDOM or LOW_DISCREPANCY
+*/
+void RandomPoseViewRenderer::setSampler(SamplerType type)
+{
+	_sampler = type;
+}
+
+
+/*
+Set the min. fraction of the projected model bounding box that must be inside the image. 
+@param fraction - the min. visible fraction, 0 to 1.
+*/
+void RandomPoseViewRenderer::setMinVisibleFraction(float fraction)
+{
+	_min_visible = (std::min)(1.0f, (std::max)(0.0f, fraction));
+}
+
 /*
 Draw the image sequence and save all images to a file
 @return - false, if images still need to be rendered.
@@ -153,7 +213,7 @@ bool RandomPoseViewRenderer::draw_sequence(void)
 {
 	if (_N_current < _N) {
 
-		glm::mat4 pose = getRandomPosition();
+		glm::mat4 pose = (_sampler == LOW_DISCREPANCY) ? getSampledPose(_N_current) : getRandomPosition();
 		setCameraMatrix(pose);
 
 		enable_writer(true);
@@ -164,6 +224,11 @@ bool RandomPoseViewRenderer::draw_sequence(void)
 		if (_N_current == _N){
 			if(_verbose)
 				cout << "[INFO] - DONE - rendered " << _N_current << " sets." <<  endl;
+			if (_min_visible > 0.0f && _sampler == RANDOM) {
+				cout << "[INFO] - Rejected " << _num_rejected << " poses below the visible fraction " << _min_visible << "." << endl;
+				if (_num_failed > 0)
+					cout << "[WARNING] - " << _num_failed << " of " << _N << " images are below the visible fraction " << _min_visible << ". Check the position limits." << endl;
+			}
 		}
 	
 		return false;
@@ -218,12 +283,43 @@ glm::mat4  RandomPoseViewRenderer::getRandomPosition(void)
     std::uniform_real_distribution<float> distribution_x(_lim_nx,_lim_px);
 	std::uniform_real_distribution<float> distribution_y(_lim_ny,_lim_py);
 	std::uniform_real_distribution<float> distribution_z(_lim_nz,_lim_pz);
-    float x = distribution_x(generator); 
-	float y = distribution_y(generator); 
-	float z = distribution_z(generator); 
 
-	// subtract the camera distance to account for the camera at location _camera_distance
-	glm::mat4 pose = glm::translate(glm::vec3(x, y, z+_camera_distance));
+	float x, y, z;
+	glm::mat4 pose;
+
+	// resample the position until enough of the bounding box is visible. 
+	// If no position passes, the most visible one is used and counted as a failure. 
+	const int max_tries = 100;
+	float best = -1.0f;
+	glm::vec3 best_xyz;
+	for (int i = 0; i < max_tries; i++) {
+		x = distribution_x(generator); 
+		y = distribution_y(generator); 
+		z = distribution_z(generator); 
+
+		// subtract the camera distance to account for the camera at location _camera_distance
+		pose = glm::translate(glm::vec3(x, y, z+_camera_distance));
+
+		if (_min_visible <= 0.0f) break;
+		float visible = visibleFraction(pose * vm);
+		if (visible >= _min_visible) break;
+		_num_rejected++;
+
+		if (visible > best) {
+			best = visible;
+			best_xyz = glm::vec3(x, y, z);
+		}
+
+		if (i == max_tries - 1) {
+			x = best_xyz.x;
+			y = best_xyz.y;
+			z = best_xyz.z;
+			pose = glm::translate(glm::vec3(x, y, z + _camera_distance));
+			_num_failed++;
+			cout << "[WARNING] - Image " << _N_current << ": no position within " << max_tries << " tries has the visible fraction " << _min_visible 
+				<< ", rendered the best one with " << best << "." << endl;
+		}
+	}
 
 	if (_verbose) {
 		std::cout << std::fixed;
@@ -244,3 +340,43 @@ glm::mat4  RandomPoseViewRenderer::getRandomPosition(void)
 }
 
 
+/*
+Return the pose with index i of the low-discrepancy sequence.
+*/
+glm::mat4  RandomPoseViewRenderer::getSampledPose(int i)
+{
+	glm::quat q = _sampled_rotations[i];
+	glm::vec3 t = _sampled_translations[i];
+
+	if (_verbose) {
+		glm::vec3 eye = (glm::inverse(q) * glm::vec3(0.0f, 0.0f, 1.0f)) * _camera_distance;
+		std::cout << std::fixed;
+		std::cout << std::setprecision(2);
+		cout << "[INFO] - Render image " << _N_current << " from pos: (" << eye[0] << ", " << eye[1] << ", " << eye[2] << "), with translation (" << t.x << ", " << t.y << ", " << t.z << ")." << endl;
+	}
+	else
+	{
+		if (_N_current % 100 == 0 && _N_current > 0) {
+			std::cout << ". ";
+		}
+		if (_N_current % 1000 == 0 && _N_current > 0) {
+			std::cout << _N_current << "/" << _N << std::endl;
+		}
+	}
+	return poseMatrix(q, t);
+}
+
+
+/*
+Return the view matrix for a rotation and a translation in camera space.
+*/
+glm::mat4  RandomPoseViewRenderer::poseMatrix(const glm::quat& rotation, const glm::vec3& translation)
+{
+	// the rotation replaces the lookAt matrix, which moves the camera to _camera_distance
+	glm::mat4 vm = glm::translate(glm::vec3(0.0f, 0.0f, -_camera_distance)) * glm::mat4_cast(rotation);
+
+	// subtract the camera distance to account for the camera at location _camera_distance
+	glm::mat4 pose = glm::translate(glm::vec3(translation.x, translation.y, translation.z + _camera_distance));
+
+	return pose * vm;
+}
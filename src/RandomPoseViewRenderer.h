@@ -50,6 +50,11 @@ Jan 21, 2019:
 Aug 8, 2019, RR
 - Added a function that removes all canera viewpoints in the lower hemisphere of the polyhedron. 
 	As a result, the 3D model will only be rendered in its upright position. 
+Oct 19, 2026, RR
+- Added the LOW_DISCREPANCY sampler. It samples rotations over SO(3) and translations from a Halton sequence, 
+	see PoseSampler, and reports the achieved angular spacing. 
+- Added a min. visible fraction. Poses that project the bounding box mostly outside the image are resampled before rendering.
+	If no RANDOM position passes within 100 tries, the most visible one is rendered with a warning. 
 */
 
 
@@ -74,11 +79,17 @@ Aug 8, 2019, RR
 
 #include "PolyhedronGeometry.h" // for the Polyhedron geometry
 #include "ModelRenderer.h"
+#include "PoseSampler.h"
 
 class RandomPoseViewRenderer : public ModelRenderer
 {
 public:
 
+	typedef enum {
+		RANDOM,			// random polyhedron vertex and random translation
+		LOW_DISCREPANCY	// rotation over SO(3) and translation from a Halton sequence
+	}SamplerType;
+
 	/*
 	Constructor
 	@param - window_width, window_height - width and height of the opengl, glfw output image in pixel
@@ -114,6 +125,26 @@ public:
 	*/
 	void setHemisphere(bool upright);
 
+
+	/*
+	Set the pose sampler. RANDOM is the default. 
+	LOW_DISCREPANCY ignores the polyhedron subdivisions and also samples the in-plane rotation.
+	Call it before create().
+	@param type - RANDOM or LOW_DISCREPANCY
+	*/
+	void setSampler(SamplerType type);
+
+
+	/*
+	Set the min. fraction of the projected model bounding box that must be inside the image. 
+	Poses below this fraction are resampled before rendering. The default 0 disables the test.
+	A RANDOM pose without a passing position after 100 tries uses the most visible position, prints a warning, 
+	and is counted in the summary. 
+	Call it after setModel() and before create().
+	@param fraction - the min. visible fraction, 0 to 1.
+	*/
+	void setMinVisibleFraction(float fraction);
+
 	/*
 	Draw the image sequence and save all images to a file
 	@return - false, if images still need to be rendered. 
@@ -129,6 +160,16 @@ private:
 	*/
 	glm::mat4 getRandomPosition(void);
 
+	/*
+	Return the pose with index i of the low-discrepancy sequence.
+	*/
+	glm::mat4 getSampledPose(int i);
+
+	/*
+	Return the view matrix for a rotation and a translation in camera space.
+	*/
+	glm::mat4 poseMatrix(const glm::quat& rotation, const glm::vec3& translation);
+
 
 
 	//--------------------------------------------------------------
@@ -157,6 +198,14 @@ private:
 	float					_lim_pz, _lim_nz;
 
 	std::random_device		_rd;
+
+	SamplerType				_sampler;
+	std::vector<glm::quat>	_sampled_rotations; // LOW_DISCREPANCY poses
+	std::vector<glm::vec3>	_sampled_translations;
+
+	float					_min_visible; // min. visible fraction of the bounding box
+	int						_num_rejected; // number of rejected poses
+	int						_num_failed; // number of RANDOM images without a position above _min_visible
 };
 
 
@@ -1,6 +1,31 @@
 #include "RoIDetect.h"
 
 
+namespace RoIDetectInternal
+{
+	/*
+	Return the first and the last non-zero element of a row or column vector, -1 if all are zero. 
+	*/
+	void FirstLast(const cv::Mat& v, int& first, int& last)
+	{
+		cv::Mat nz;
+		cv::compare(v, 0, nz, cv::CMP_GT); // CV_8U, continuous
+
+		const unsigned char* p = nz.ptr<unsigned char>();
+		int n = (int)nz.total();
+
+		first = -1;
+		last = -1;
+		for (int i = 0; i < n; i++) {
+			if (p[i]) { first = i; break; }
+		}
+		for (int i = n - 1; i >= first && first >= 0; i--) {
+			if (p[i]) { last = i; break; }
+		}
+	}
+}
+
+
 /*
 Detect a region of interest in an RGB rendering.
 Note that this is a primitive function which assumes that only one 
@@ -86,6 +111,47 @@ bool RoIDetect::Extract(cv::Mat& image, cv::Rect2f& roi )
 
 
 
+/*
+Detect the region of interest in a mask or id image. 
+@param mask - a single-channel image.
+@param roi - location to return the region of interest. 
+*/
+//static 
+bool RoIDetect::ExtractFromMask(const cv::Mat& mask, cv::Rect2f& roi)
+{
+	if (mask.empty() || mask.channels() != 1) return false;
+
+	// the same result as Extract() for an image without object pixels
+	roi.x = mask.cols;
+	roi.y = mask.rows;
+	roi.width = 1;
+	roi.height = 1;
+
+	// the max. of each row tells whether the row has object pixels
+	cv::Mat rows_any;
+	cv::reduce(mask, rows_any, 1, cv::REDUCE_MAX);
+
+	int y0, y1;
+	RoIDetectInternal::FirstLast(rows_any, y0, y1);
+	if (y0 < 0) return true;
+
+	// only the rows between the first and the last object row
+	cv::Mat cols_any;
+	cv::reduce(mask.rowRange(y0, y1 + 1), cols_any, 0, cv::REDUCE_MAX);
+
+	int x0, x1;
+	RoIDetectInternal::FirstLast(cols_any, x0, x1);
+
+	roi.x = x0;
+	roi.y = y0;
+	roi.width = (std::max)(1, x1 - x0);
+	roi.height = (std::max)(1, y1 - y0);
+
+	return true;
+}
+
+
+
 /*
 Render the RoI
 @param image - a reference to the image.
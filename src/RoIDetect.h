@@ -22,6 +22,9 @@ Last edited:
 
 July 4th, 2019, RR
 - Fixed a bug that displayed an incorred ROI when image rows != cols
+Oct 19, 2026, RR
+- Added ExtractFromMask(), which finds the roi in a mask or id image with a row and a column max. reduction 
+  instead of a pixel scan. 
 */
 
 #include <iostream>
@@ -50,6 +53,19 @@ public:
 	static bool Extract(cv::Mat& image, cv::Rect2f& roi);
 
 
+	/*
+	Detect the region of interest in a mask or id image, where every non-zero pixel belongs to the object. 
+	The function reduces the image to the max. per row, and the rows with object pixels to the max. per column. 
+	Both are vectorized reductions, so no pixel is visited by branchy per-pixel code. 
+	The roi follows the convention of Extract(): x, y is the first object pixel, the width and the height are 
+	the distance to the last object pixel, at least 1. 
+	@param mask - a single-channel image, e.g., CV_8UC1 or CV_16UC1.
+	@param roi - location to return the region of interest. 
+	@return - false, if the image is empty or has more than one channel.
+	*/
+	static bool ExtractFromMask(const cv::Mat& mask, cv::Rect2f& roi);
+
+
 	/*
 	Render the RoI
 	@param image - a reference to the image.
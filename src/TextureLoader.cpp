@@ -1,25 +1,166 @@
 #include "TextureLoader.h"
 
+#include <map>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+
 
 namespace TextureLoaderInternal {
 
-	vector<cv::Mat>	textures_storage;
-	vector<string>	files;
+	/*
+	A cached texture file.
+	*/
+	typedef struct _TextureEntry {
+		cv::Mat			image; // mipmap level 0 for Load(), empty if not loaded
+		unsigned int	tex_id; // gl texture for LoadTexture2D(), 0 if not created
+		int				data_refs; // references to image
+		int				texture_refs; // references to tex_id
+
+		_TextureEntry()
+		{
+			tex_id = 0;
+			data_refs = 0;
+			texture_refs = 0;
+		}
+	}TextureEntry;
+
+	map<string, TextureEntry>	textures;
+	bool						cache_enabled = true;
+
+	// texture cache file
+	const char magic[8] = { 'S', 'F', 'T', 'E', 'X', '\0', '\0', '\0' };
+	const uint32_t version = 1; // increase if the format or the preprocessing changes
+	const uint32_t byte_order = 0x01020304;
+	const int32_t max_size = 1 << 15;
+
 
+	/*
+	Remove an entry without references.
+	*/
+	void Erase(map<string, TextureEntry>::iterator it)
+	{
+		if (it->second.data_refs == 0 && it->second.texture_refs == 0)
+			textures.erase(it);
+	}
 }
 
 using namespace TextureLoaderInternal;
 
-//static 
+//static
 bool  TextureLoader::Load(string path_and_name, unsigned char** texture, int* width, int* height, int* channels)
 {
+	auto it = textures.find(path_and_name);
+
+	// only the first user of the file loads the image
+	if (it == textures.end() || it->second.image.empty()) {
+		vector<cv::Mat> levels;
+		if (!LoadLevels(path_and_name, levels)) return false;
+
+		it = textures.insert(make_pair(path_and_name, TextureEntry())).first;
+		it->second.image = levels[0];
+	}
+
+	TextureEntry& e = it->second;
+	e.data_refs++;
+
+	(*texture) = (unsigned char*) e.image.data;
+	(*width) = e.image.cols;
+	(*height) = e.image.rows;
+	(*channels) = e.image.channels();
+
+	return true;
+
+}
+
+
+//static
+void TextureLoader::Release(string path_and_name)
+{
+	auto it = textures.find(path_and_name);
+	if (it == textures.end() || it->second.data_refs == 0) return;
+
+	if (--it->second.data_refs == 0)
+		it->second.image.release();
+	Erase(it);
+}
+
+
+//static
+bool TextureLoader::LoadTexture2D(string path_and_name, unsigned int* tex_id, int wrap_mode)
+{
+	auto it = textures.find(path_and_name);
+
+	// only the first user of the file creates the texture
+	if (it == textures.end() || it->second.tex_id == 0) {
+		vector<cv::Mat> levels;
+		if (!LoadLevels(path_and_name, levels)) return false;
+
+		it = textures.insert(make_pair(path_and_name, TextureEntry())).first;
+
+		glGenTextures(1, &it->second.tex_id);
+		glBindTexture(GL_TEXTURE_2D, it->second.tex_id);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap_mode);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap_mode);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (int)levels.size() - 1);
+
+		// the rows of small levels with three channels are not 4-byte aligned
+		GLint alignment = 4;
+		glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+		for (int i = 0; i < levels.size(); i++) {
+			if (levels[i].channels() == 4)
+				glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA, levels[i].cols, levels[i].rows, 0, GL_BGRA, GL_UNSIGNED_BYTE, levels[i].data);
+			else
+				glTexImage2D(GL_TEXTURE_2D, i, GL_RGB, levels[i].cols, levels[i].rows, 0, GL_BGR, GL_UNSIGNED_BYTE, levels[i].data);
+		}
+
+		glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+	}
+
+	it->second.texture_refs++;
+	(*tex_id) = it->second.tex_id;
+
+	return true;
+}
 
 
+//static
+void TextureLoader::ReleaseTexture2D(string path_and_name)
+{
+	auto it = textures.find(path_and_name);
+	if (it == textures.end() || it->second.texture_refs == 0) return;
+
+	if (--it->second.texture_refs == 0) {
+		glDeleteTextures(1, &it->second.tex_id);
+		it->second.tex_id = 0;
+	}
+	Erase(it);
+}
+
+
+//static
+void TextureLoader::SetCacheEnabled(bool enable)
+{
+	cache_enabled = enable;
+}
+
+
+//static
+bool TextureLoader::LoadLevels(string path_and_name, vector<cv::Mat>& levels)
+{
 	if (!FileUtils::Exists(path_and_name)) {
 		cout << "[ERROR] - Could not find file " << path_and_name << ". Check the file" << endl;
 		return false;
 	}
 
+	if (ReadCache(path_and_name, levels)) return true;
+
 
 	cv::Mat image = cv::imread(path_and_name, cv::IMREAD_ANYCOLOR);
 
@@ -28,6 +169,10 @@ bool  TextureLoader::Load(string path_and_name, unsigned char** texture, int* wi
 		return false;
 	}
 
+	// the gl texture supports three and four channels
+	if (image.channels() == 1)
+		cv::cvtColor(image, image, cv::COLOR_GRAY2BGR);
+
 	cv::Mat image_rs;
 	int new_size = (std::max)( FindNextPower2(image.rows), FindNextPower2(image.cols));
 	cv::resize(image, image_rs, cv::Size2f(new_size, new_size));
@@ -35,26 +180,106 @@ bool  TextureLoader::Load(string path_and_name, unsigned char** texture, int* wi
 	// flip the texture to match the opengl coordinate system
 	cv::flip(image_rs, image_rs, 0);
 
-	textures_storage.push_back(image_rs);
-	files.push_back(path_and_name);
+	// the mipmap levels, down to 1 x 1 pixels
+	levels.clear();
+	levels.push_back(image_rs);
+	while (levels.back().cols > 1) {
+		cv::Mat next;
+		cv::resize(levels.back(), next, cv::Size(levels.back().cols / 2, levels.back().rows / 2), 0, 0, cv::INTER_AREA);
+		levels.push_back(next);
+	}
+
+	WriteCache(path_and_name, levels);
+
+	return true;
+}
+
 
-	int i = textures_storage.size();
+//static
+bool TextureLoader::ReadCache(string path_and_name, vector<cv::Mat>& levels)
+{
+	if (!cache_enabled) return false;
 
+	std::ifstream in(path_and_name + ".texcache", std::ios::binary);
+	if (!in.is_open()) return false;
 
-	(*texture) = (unsigned char*) textures_storage[i - 1].data;
-	(*width) = image_rs.cols;
-	(*height) = image_rs.rows;
-	(*channels) = image_rs.channels();
+	in.seekg(0, std::ios::end);
+	uint64_t file_size = (uint64_t)in.tellg();
+	in.seekg(0, std::ios::beg);
+
+	char m[8];
+	uint32_t v = 0, b = 0;
+	uint64_t hash = 0, cached_hash = 0;
+	int32_t size = 0, channels = 0, num_levels = 0;
+	in.read(m, sizeof(m));
+	in.read((char*)&v, sizeof(v));
+	in.read((char*)&b, sizeof(b));
+	in.read((char*)&cached_hash, sizeof(cached_hash));
+	in.read((char*)&size, sizeof(size));
+	in.read((char*)&channels, sizeof(channels));
+	in.read((char*)&num_levels, sizeof(num_levels));
+	if (!in || memcmp(m, magic, sizeof(m)) != 0 || v != version || b != byte_order ||
+		size < 1 || size > max_size || (size & (size - 1)) != 0 || (channels != 3 && channels != 4) ||
+		!FileUtils::HashFile(path_and_name, hash) || hash != cached_hash) {
+		return false;
+	}
+
+	// the complete chain from size x size down to 1 x 1
+	uint64_t expected = (uint64_t)in.tellg();
+	int n = 0;
+	for (int s = size; s >= 1; s /= 2, n++)
+		expected += (uint64_t)s * s * channels;
+	if (num_levels != n || expected != file_size) return false;
+
+	levels.clear();
+	for (int s = size; s >= 1; s /= 2) {
+		cv::Mat level(s, s, CV_8UC(channels));
+		in.read((char*)level.data, (std::streamsize)s * s * channels);
+		if (!in) return false;
+		levels.push_back(level);
+	}
 
 	return true;
+}
+
+
+//static
+bool TextureLoader::WriteCache(string path_and_name, const vector<cv::Mat>& levels)
+{
+	if (!cache_enabled || levels.empty()) return false;
 
+	uint64_t hash = 0;
+	if (!FileUtils::HashFile(path_and_name, hash)) return false;
+
+	string file = path_and_name + ".texcache";
+	bool ok = FileUtils::WriteAtomic(file, [&](std::ofstream& out) {
+		int32_t size = levels[0].cols;
+		int32_t channels = levels[0].channels();
+		int32_t num_levels = (int32_t)levels.size();
+		out.write(magic, sizeof(magic));
+		out.write((const char*)&version, sizeof(version));
+		out.write((const char*)&byte_order, sizeof(byte_order));
+		out.write((const char*)&hash, sizeof(hash));
+		out.write((const char*)&size, sizeof(size));
+		out.write((const char*)&channels, sizeof(channels));
+		out.write((const char*)&num_levels, sizeof(num_levels));
+		for (auto& l : levels) {
+			cv::Mat c = l.isContinuous() ? l : l.clone();
+			out.write((const char*)c.data, (std::streamsize)c.total() * c.elemSize());
+		}
+	});
+
+	if (!ok) {
+		cout << "[WARNING] - TextureLoader: cannot write the cache file " << file << "." << endl;
+	}
+	return ok;
 }
 
 
-//static 
+//static
 int TextureLoader::FindNextPower2(int size)
 {
 	float l = std::ceil(std::log2f(size));
 	float next = std::pow(2,l);
 	return (int)next;
-}
\ No newline at end of file
+}
@@ -7,6 +7,15 @@ in global namespace.  The class usess OpenCV to load the textures from files. Th
 can load. 
 It replaces the previously used bmp file loader. 
 
+Each file is loaded once. The textures are kept in a cache with the path and file as key and a reference count. 
+Load() and LoadTexture2D() add a reference, Release() and ReleaseTexture2D() remove it. 
+The image data or the texture object gets deleted with the last reference. 
+LoadTexture2D() creates the gl texture with all mipmap levels and does not keep the image data after the upload. 
+
+The preprocessed texture, resized, flipped, and with all mipmap levels, is written into a file next to the image, 
+e.g., texture.png -> texture.png.texcache. The next loads read this file instead of decoding the image. 
+The file is ignored and rewritten if the content hash of the image changes. 
+
 Rafael Radkowski
 Iowa State University
 rafael@iastate.edu
@@ -23,6 +32,12 @@ Dec 10, 2019, RR:
 - Added FileUtils.h to address the deprecation of experimental/filesystem.
 - Prevent macro invocation for std::max by using parentheses.
 
+Oct 19, 2026, RR
+- Added a reference-counted texture cache. Each file is decoded once, also if many meshes or models use it. 
+- Added LoadTexture2D to create gl textures with mipmaps, shared by all users of a file. 
+- Added the texture cache file with the preprocessed mipmap levels. 
+- Gray images are converted to three channels. 
+
 */
 
 // stl include
@@ -63,8 +78,58 @@ public:
 	*/
 	static bool Load(string path_and_name, unsigned char** texture, int* width, int* height, int* channels);
 
+
+	/*!
+	Release the image data of a texture loaded with Load(). The data gets deleted with the last reference.
+	@param path_and_name - string containing the path and the filename of the texture, as passed to Load().
+	*/
+	static void Release(string path_and_name);
+
+
+	/*!
+	Load a texture from a file and create a gl texture with all mipmap levels. 
+	All users of the same file share one texture object. 
+	@param path_and_name - string containing the path and the filename of the texture. 
+	@param tex_id - location to return the texture id.
+	@param wrap_mode - the GL wrapping mode for a new texture object, e.g., GL_REPEAT, GL_CLAMP_TO_BORDER.
+	@return - true if the texture was successfully created, false otherwise. 
+	*/
+	static bool LoadTexture2D(string path_and_name, unsigned int* tex_id, int wrap_mode = GL_CLAMP_TO_BORDER);
+
+
+	/*!
+	Release a texture created with LoadTexture2D(). The texture object gets deleted with the last reference.
+	@param path_and_name - string containing the path and the filename of the texture, as passed to LoadTexture2D().
+	*/
+	static void ReleaseTexture2D(string path_and_name);
+
+
+	/*!
+	Enable or disable the texture cache files. They are enabled by default. 
+	@param enable - true enables the texture cache files.
+	*/
+	static void SetCacheEnabled(bool enable);
+
 private:
 
+	/*!
+	Load the image and create all mipmap levels, from the cache file or from the image file.
+	@param path_and_name - string containing the path and the filename of the texture. 
+	@param levels - location for the mipmap levels, level 0 first. 
+	@return - true if the image was successfully loaded, false otherwise.
+	*/
+	static bool LoadLevels(string path_and_name, vector<cv::Mat>& levels);
+
+
+	/*!
+	Read or write the preprocessed mipmap levels of an image.
+	@param path_and_name - string containing the path and the filename of the image, not of the cache file. 
+	@param levels - the mipmap levels, level 0 first. 
+	@return - true if the cache file is valid and was read, or if it was written.
+	*/
+	static bool ReadCache(string path_and_name, vector<cv::Mat>& levels);
+	static bool WriteCache(string path_and_name, const vector<cv::Mat>& levels);
+
 	/*!
 	Return the next power of two of for the value number.
 	The function is used internally to resize the texture to a 2^n size. 
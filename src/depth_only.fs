@@ -0,0 +1,18 @@
+#version 410 core                                                 
+                                                                 
+// moves the fragments towards the camera, to pass a depth test against image_renderer.fs
+uniform float depth_offset;
+                                                                 
+in vec4 pass_Coordinates;
+                                                                 
+void main(void)                                                   
+{                                                                 
+	// the linear depth of image_renderer.fs; must match the projection
+	const float n = 0.01; // camera z near
+	const float f = 10.0; // camera z far
+
+	float current_depth = pass_Coordinates.z/ pass_Coordinates.w;
+	current_depth  = (2.0 * f  * n) / (f + n - current_depth * (f - n)) ;
+
+	gl_FragDepth =  current_depth - depth_offset;
+}
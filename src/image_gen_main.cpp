@@ -54,7 +54,10 @@ int main(int argc, char** argv)
 	generator->setRenderPath(arg.rendered_images_log_file);
 	generator->setOutputPath(arg.output_path);
 	generator->setFilter(RandomImageGenerator::NOISE, arg.with_noise, arg.noise_sigma, 0.0);
+	generator->setNoiseType((NoiseFilter::NoiseType)arg.noise_type, arg.seed);
 	generator->setFilter(RandomImageGenerator::CHROMATIC, arg.with_chromatic, 0.0, 0.0);
+	generator->setFilter(RandomImageGenerator::HISTOGRAM, arg.with_histmatch, 0.0, 0.0);
+	generator->setBackgroundSampling(arg.bg_samples, arg.crop_scale_min, arg.crop_scale_max);
 
 	int num = generator->process(arg.num_images);
 
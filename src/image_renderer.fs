@@ -9,9 +9,10 @@ in vec3 pass_Normal;
 in vec3 pass_Position;   
 in vec4 pass_Color;   
 in vec4 pass_Coordinates;
+flat in int pass_ID;
 
 // The material parameters
-uniform struct LightSource {
+struct LightSource {
     vec3 position;
 	vec3 direction;
 	vec3 color;
@@ -22,11 +23,16 @@ uniform struct LightSource {
 	float k2;    //attenuation
 	bool used;
 	int  type;  //0:point, 1:spot, 2:directional
-} light[MAX_LIGHTS];
+};
+
+// The lights, one buffer for all programs, see cs557::LightSource
+layout(std140) uniform LightBlock {
+	LightSource light[MAX_LIGHTS];
+};
 
 
 // The material parameters
-uniform struct Material {
+struct Material {
     vec3  diffColor;
  	float diffInt;
  	vec3  ambColor;
@@ -34,10 +40,16 @@ uniform struct Material {
  	vec3  specColor;
  	float specInt;
  	float shininess;
-} mat[1];
+};
+
+// The material, one buffer for all programs, see cs557::Material
+layout(std140) uniform MaterialBlock {
+	Material mat[1];
+};
 
 
-out vec4 color;       
+layout(location = 0) out vec4 color;
+layout(location = 1) out uint out_ID; // the instance id, 0 is the background       
 
 /*
 Per-fragment light. 
@@ -115,6 +127,7 @@ void main(void)
 	}
 
 	color = mixed;      
+	out_ID = uint(pass_ID);
 
 
 	//------------------------------------------------
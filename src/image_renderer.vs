@@ -3,32 +3,38 @@
 uniform mat4 projectionMatrix;                                    
 uniform mat4 viewMatrix;                                           
 uniform mat4 modelMatrix;  
+uniform int object_id; // the id of the model, or of the first instance
 
 //uniform vec3 light_position;
 uniform vec3 light_direction;
 
 in vec3 in_Position;                                                                                                           
 in vec3 in_Normal;         
+in mat4 in_InstanceMatrix; // the pose of the instance, identity if not drawn instanced
                                        
 out vec3 pass_Normal; 
 out vec3 pass_Position;
 out vec4 pass_Color;       
 out vec4 pass_Coordinates;
+flat out int pass_ID;
                                                                 
 void main(void)                                                  
 {            
+	mat4 m = modelMatrix * in_InstanceMatrix;
+	pass_ID = object_id + gl_InstanceID;
+
 	// to calculate the real (linear) depth
-	pass_Coordinates =  projectionMatrix * viewMatrix * modelMatrix * vec4(in_Position, 1.0);    
+	pass_Coordinates =  projectionMatrix * viewMatrix * m * vec4(in_Position, 1.0);    
 
 	// for lighting
-	pass_Position = vec3(  viewMatrix *  modelMatrix  *  vec4(in_Position, 1.0));    
+	pass_Position = vec3(  viewMatrix *  m  *  vec4(in_Position, 1.0));    
 	
-    pass_Normal =   vec3( transpose(inverse(viewMatrix * modelMatrix)) *  vec4(in_Normal, 0.0));   
+    pass_Normal =   vec3( transpose(inverse(viewMatrix * m)) *  vec4(in_Normal, 0.0));   
 	
 	pass_Color = vec4(normalize(in_Normal), 1.0);
 			
 	// pass the position				                       
-	gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(in_Position, 1.0);       
+	gl_Position = projectionMatrix * viewMatrix * m * vec4(in_Position, 1.0);       
 	       
 	gl_PointSize = 4.0;
 }                                                            
\ No newline at end of file
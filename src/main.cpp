@@ -23,6 +23,10 @@ August 8, 2019, RR
 
 May 9, 2020
 - Added a brdf renderer to the command line arguments. 
+
+Oct 19, 2026, RR
+- Added the scene models of the command line arguments to the renderers. 
+- Enables the visibility labels of the renderers. 
 */
 
 #include <iostream>
@@ -119,6 +123,18 @@ void InitWindow(Arguments& opt)
 
 
 
+/*
+Add the scene models and the visibility labels to a renderer. 
+*/
+void InitScene(ModelRenderer* renderer, Arguments& opt)
+{
+	renderer->setVisibilityLabels(opt.visibility_labels);
+	renderer->setSceneParams(opt.scene_instances, opt.scene_radius);
+	for (auto& f : opt.scene_models)
+		renderer->addSceneModel(f);
+}
+
+
 void InitRenderer(Arguments& opt)
 {
 	/* Load the camera parameters from file. */
@@ -138,6 +154,11 @@ void InitRenderer(Arguments& opt)
 	}
 	
 
+	/* Skip the obj parsing, the image decoding, and the shader compilation if valid binary caches exist. */
+	cs557::MeshCache::SetEnabled(opt.mesh_cache);
+	TextureLoader::SetCacheEnabled(opt.mesh_cache);
+	cs557::ShaderProgramUtils::SetBinaryCache(opt.mesh_cache);
+
      //---------------------------------------------------------
     // Create models
 	cam_control = opt.cam;
@@ -146,6 +167,8 @@ void InitRenderer(Arguments& opt)
 		sphere_renderer->setVerbose(opt.verbose); // set first to get all the output info
 		sphere_renderer->setModel(opt.model_path_and_file);
 		sphere_renderer->setOutputPath(opt.output_path);
+		sphere_renderer->setLOD(opt.lod_max_error > 0.0, opt.lod_max_error);
+		InitScene(sphere_renderer, opt);
 		sphere_renderer->setRandomColorsParams(mat.hue_min, mat.hue_max, mat.saturation_min, mat.saturation_max, mat.brightness_value_min, mat.brightness_value_max, mat.with_v);
 		sphere_renderer->setRandomColors(opt.with_random_colors);
 		sphere_renderer->createSphereGeometry(opt.camera_distance, opt.segments, opt.rows);
@@ -157,9 +180,12 @@ void InitRenderer(Arguments& opt)
 		poly_renderer->setVerbose(opt.verbose); // set first to get all the output info
 		poly_renderer->setModel(opt.model_path_and_file);
 		poly_renderer->setOutputPath(opt.output_path);
+		poly_renderer->setLOD(opt.lod_max_error > 0.0, opt.lod_max_error);
+		InitScene(poly_renderer, opt);
 		poly_renderer->setHemisphere(opt.upright);
 		poly_renderer->setRandomColorsParams(mat.hue_min, mat.hue_max, mat.saturation_min, mat.saturation_max, mat.brightness_value_min, mat.brightness_value_max, mat.with_v);
 		poly_renderer->setRandomColors(opt.with_random_colors);
+		poly_renderer->setSymmetryReduction(opt.symmetry);
 		poly_renderer->create(opt.camera_distance, opt.subdivisions);
 		
 	}
@@ -169,8 +195,12 @@ void InitRenderer(Arguments& opt)
 		tree_renderer->setVerbose(opt.verbose); // set first to get all the output info
 		tree_renderer->setModel(opt.model_path_and_file);
 		tree_renderer->setOutputPath(opt.output_path);
+		tree_renderer->setLOD(opt.lod_max_error > 0.0, opt.lod_max_error);
+		InitScene(tree_renderer, opt);
 		tree_renderer->setRandomColorsParams(mat.hue_min, mat.hue_max, mat.saturation_min, mat.saturation_max, mat.brightness_value_min, mat.brightness_value_max, mat.with_v);
 		tree_renderer->setRandomColors(opt.with_random_colors);
+		tree_renderer->setSymmetryReduction(opt.symmetry);
+		tree_renderer->setAdaptive(opt.adaptive_threshold > 0.0, opt.adaptive_threshold);
 		tree_renderer->create(opt.camera_distance, opt.bpt_levels);
 	}
 	else if (opt.cam == POSE)
@@ -182,8 +212,12 @@ void InitRenderer(Arguments& opt)
 		else
 			pose_renderer->setModel(opt.model_path_and_file, brdf0);
 		pose_renderer->setOutputPath(opt.output_path);
+		pose_renderer->setLOD(opt.lod_max_error > 0.0, opt.lod_max_error);
+		InitScene(pose_renderer, opt);
 		pose_renderer->setPoseLimits(opt.lim_nx, opt.lim_px, opt.lim_ny, opt.lim_py, opt.lim_nz, opt.lim_pz);
 		pose_renderer->setHemisphere(opt.upright);
+		pose_renderer->setSampler(opt.sampler == 1 ? RandomPoseViewRenderer::LOW_DISCREPANCY : RandomPoseViewRenderer::RANDOM);
+		pose_renderer->setMinVisibleFraction(opt.min_visible);
 		pose_renderer->setRandomColors(opt.with_random_colors);
 		pose_renderer->setRandomColorsParams(mat.hue_min, mat.hue_max, mat.saturation_min, mat.saturation_max, mat.brightness_value_min, mat.brightness_value_max, mat.with_v);
 		pose_renderer->create(opt.num_images, opt.subdivisions);
@@ -199,6 +233,8 @@ void InitRenderer(Arguments& opt)
 			model_renderer->create(opt.model_path_and_file, brdf0);
 		else
 			model_renderer->create(opt.model_path_and_file);
+		model_renderer->setLOD(opt.lod_max_error > 0.0, opt.lod_max_error);
+		InitScene(model_renderer, opt);
 		cs557::AddKeyboardCallbackPtr(std::bind(&UserViewRenderer::keyboardCallback, model_renderer, _1, _2 ));
 
 	}
@@ -11,7 +11,7 @@ in vec4 pass_Color;
 in vec4 pass_Coordinates;
 
 // The material parameters
-uniform struct LightSource {
+struct LightSource {
     vec3 position;
 	vec3 direction;
 	vec3 color;
@@ -22,11 +22,16 @@ uniform struct LightSource {
 	float k2;    //attenuation
 	bool used;
 	int  type;  //0:point, 1:spot, 2:directional
-} light[MAX_LIGHTS];
+};
+
+// The lights, one buffer for all programs, see cs557::LightSource
+layout(std140) uniform LightBlock {
+	LightSource light[MAX_LIGHTS];
+};
 
 
 // The material parameters
-uniform struct Material {
+struct Material {
     vec3  diffColor;
  	float diffInt;
  	vec3  ambColor;
@@ -34,7 +39,12 @@ uniform struct Material {
  	vec3  specColor;
  	float specInt;
  	float shininess;
-} mat[1];
+};
+
+// The material, one buffer for all programs, see cs557::Material
+layout(std140) uniform MaterialBlock {
+	Material mat[1];
+};
 
 
 out vec4 color;       
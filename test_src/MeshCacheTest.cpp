@@ -0,0 +1,239 @@
+/*
+Test for cs557::MeshCache
+
+The test writes a small obj and mtl file and a cache for them, and checks that
+- the cache returns the written model (round trip),
+- a changed obj or mtl file invalidates the cache (stale hash),
+- a cache file truncated at any byte is rejected,
+- a cache with an out-of-range vertex index, mesh range, or LOD range is rejected.
+MeshCache::Read() must return false for every broken cache, so that the model is parsed again.
+
+Returns 0 if all tests pass.
+
+Rafael Radkowski
+Iowa State University
+rafael@iastate.edu
+MIT License
+---------------------------------
+last edited:
+Oct 19, 2026, RR
+- Created.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+
+// glm
+#include <glm/glm.hpp>
+
+// local
+#include "MeshCache.h"
+
+using namespace std;
+
+
+int num_failed = 0;
+
+
+void Fail(string name, string message)
+{
+	num_failed++;
+	cout << "[ERROR] - " << name << ": " << message << endl;
+}
+
+
+void WriteText(string file, string text)
+{
+	ofstream out(file, std::ios::binary);
+	out << text;
+}
+
+
+string ReadBytes(string file)
+{
+	ifstream in(file, std::ios::binary);
+	ostringstream s;
+	s << in.rdbuf();
+	return s.str();
+}
+
+
+/*
+A model with two meshes and two levels of detail. The content does not need to match the obj file.
+*/
+cs557::MeshCache::MeshData CreateModel(string mtl)
+{
+	cs557::MeshCache::MeshData data;
+	data.points.push_back(make_pair(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec2(0.0f, 0.0f)));
+	data.points.push_back(make_pair(glm::vec3(1.0f, 0.0f, 0.0f), glm::vec2(1.0f, 0.0f)));
+	data.points.push_back(make_pair(glm::vec3(1.0f, 1.0f, 0.0f), glm::vec2(1.0f, 1.0f)));
+	data.points.push_back(make_pair(glm::vec3(0.0f, 1.0f, 0.0f), glm::vec2(0.0f, 1.0f)));
+	data.normals.assign(4, glm::vec3(0.0f, 0.0f, 1.0f));
+	data.indices = { 0, 1, 2, 0, 2, 3, 0, 1, 3 };
+
+	cs557::OBJParser::OBJRange a, b;
+	a.name = "first";
+	a.start = 0;
+	a.count = 6;
+	a.material.name = "red";
+	a.material.Kd = objl::Vector3(1.0f, 0.0f, 0.0f);
+	a.material.map_Kd = "red.bmp";
+	b.name = "second";
+	b.start = 6;
+	b.count = 3;
+	data.meshes = { a, b };
+
+	cs557::MeshSimplifier::LOD l0, l1;
+	l0.start = { 0, 6 };
+	l0.count = { 6, 3 };
+	l1.error = 0.25f;
+	l1.start = { 6, 6 };
+	l1.count = { 3, 0 };
+	data.lods = { l0, l1 };
+
+	data.libraries = { mtl };
+	data.boundingbox = glm::vec3(1.0f, 1.0f, 0.0f);
+	data.centroid = glm::vec3(0.5f, 0.5f, 0.0f);
+	return data;
+}
+
+
+bool Equal(const glm::vec3& a, const glm::vec3& b)
+{
+	return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+
+/*
+Compare the read model with the written model.
+*/
+void CompareModel(string name, const cs557::MeshCache::MeshData& a, const cs557::MeshCache::MeshData& b)
+{
+	bool ok = a.points.size() == b.points.size() && a.normals.size() == b.normals.size() &&
+		a.indices == b.indices && a.meshes.size() == b.meshes.size() && a.lods.size() == b.lods.size() &&
+		a.libraries == b.libraries && Equal(a.boundingbox, b.boundingbox) && Equal(a.centroid, b.centroid);
+
+	for (int i = 0; ok && i < a.points.size(); i++) {
+		ok = Equal(a.points[i].first, b.points[i].first) && a.points[i].second.x == b.points[i].second.x &&
+			a.points[i].second.y == b.points[i].second.y && Equal(a.normals[i], b.normals[i]);
+	}
+	for (int i = 0; ok && i < a.meshes.size(); i++) {
+		const cs557::OBJParser::OBJRange& x = a.meshes[i];
+		const cs557::OBJParser::OBJRange& y = b.meshes[i];
+		ok = x.name == y.name && x.start == y.start && x.count == y.count && x.material.name == y.material.name &&
+			x.material.Kd.X == y.material.Kd.X && x.material.Kd.Y == y.material.Kd.Y && x.material.Kd.Z == y.material.Kd.Z &&
+			x.material.map_Kd == y.material.map_Kd;
+	}
+	for (int i = 0; ok && i < a.lods.size(); i++) {
+		ok = a.lods[i].error == b.lods[i].error && a.lods[i].start == b.lods[i].start && a.lods[i].count == b.lods[i].count;
+	}
+
+	if (!ok) Fail(name, "the read model differs from the written model.");
+}
+
+
+/*
+Write a cache and expect that Read() rejects it.
+*/
+void ExpectRejected(string name, string obj, const cs557::MeshCache::MeshData& data)
+{
+	if (!cs557::MeshCache::Write(obj, data)) {
+		Fail(name, "MeshCache::Write() failed.");
+		return;
+	}
+	cs557::MeshCache::MeshData read;
+	if (cs557::MeshCache::Read(obj, read)) Fail(name, "MeshCache::Read() accepted the cache.");
+}
+
+
+int main(int argc, char** argv)
+{
+	const string obj = "MeshCacheTest.obj";
+	const string mtl = "MeshCacheTest.mtl";
+	const string obj_text = "mtllib MeshCacheTest.mtl\nv 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nusemtl red\nf 1 2 3\nf 1 3 4\n";
+	const string mtl_text = "newmtl red\nKd 1.0 0.0 0.0\nmap_Kd red.bmp\n";
+
+	WriteText(obj, obj_text);
+	WriteText(mtl, mtl_text);
+	std::remove(cs557::MeshCache::CacheFile(obj).c_str());
+
+	cs557::MeshCache::MeshData model = CreateModel(mtl);
+	cs557::MeshCache::MeshData read;
+
+	// no cache
+	if (cs557::MeshCache::Read(obj, read)) Fail("missing cache", "MeshCache::Read() returned a model.");
+
+	// round trip
+	if (!cs557::MeshCache::Write(obj, model)) Fail("round trip", "MeshCache::Write() failed.");
+	read = cs557::MeshCache::MeshData();
+	if (!cs557::MeshCache::Read(obj, read)) Fail("round trip", "MeshCache::Read() failed.");
+	else CompareModel("round trip", model, read);
+
+	// stale hash: a changed obj or mtl file
+	WriteText(obj, obj_text + "f 1 2 4\n");
+	if (cs557::MeshCache::Read(obj, read)) Fail("stale obj", "MeshCache::Read() accepted the cache.");
+	WriteText(obj, obj_text);
+	if (!cs557::MeshCache::Read(obj, read)) Fail("restored obj", "MeshCache::Read() failed.");
+
+	WriteText(mtl, mtl_text + "Ks 1.0 1.0 1.0\n");
+	if (cs557::MeshCache::Read(obj, read)) Fail("stale mtl", "MeshCache::Read() accepted the cache.");
+	WriteText(mtl, mtl_text);
+
+	// truncated at every byte
+	string cache = ReadBytes(cs557::MeshCache::CacheFile(obj));
+	for (size_t n = 0; n < cache.size(); n++) {
+		WriteText(cs557::MeshCache::CacheFile(obj), cache.substr(0, n));
+		if (cs557::MeshCache::Read(obj, read)) {
+			Fail("truncated", "MeshCache::Read() accepted " + to_string(n) + " of " + to_string(cache.size()) + " bytes.");
+			break;
+		}
+	}
+
+	// out-of-range indices and ranges
+	cs557::MeshCache::MeshData broken = model;
+	broken.indices[4] = (int)model.points.size();
+	ExpectRejected("index too large", obj, broken);
+
+	broken = model;
+	broken.indices[4] = -1;
+	ExpectRejected("negative index", obj, broken);
+
+	broken = model;
+	broken.meshes[1].count = 6;
+	ExpectRejected("mesh range", obj, broken);
+
+	broken = model;
+	broken.meshes[0].start = -3;
+	ExpectRejected("negative mesh start", obj, broken);
+
+	broken = model;
+	broken.lods[1].count[0] = 4;
+	ExpectRejected("lod range", obj, broken);
+
+	broken = model;
+	broken.lods[1].start.pop_back();
+	broken.lods[1].count.pop_back();
+	ExpectRejected("lod mesh count", obj, broken);
+
+	broken = model;
+	broken.normals.pop_back();
+	ExpectRejected("normal count", obj, broken);
+
+	// a valid cache is accepted again
+	if (!cs557::MeshCache::Write(obj, model) || !cs557::MeshCache::Read(obj, read)) Fail("rewrite", "MeshCache::Read() failed.");
+
+	std::remove(cs557::MeshCache::CacheFile(obj).c_str());
+	std::remove(obj.c_str());
+	std::remove(mtl.c_str());
+
+	if (num_failed > 0) {
+		cout << "[ERROR] - MeshCacheTest: " << num_failed << " tests failed." << endl;
+		return 1;
+	}
+	cout << "[INFO] - MeshCacheTest: all tests passed." << endl;
+	return 0;
+}
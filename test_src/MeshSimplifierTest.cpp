@@ -0,0 +1,237 @@
+/*
+Test for cs557::MeshSimplifier
+
+The test builds a curved, open grid with two meshes (materials), simplifies it with
+cs557::MeshSimplifier::BuildLODs(), and checks that
+- each level has less triangles than the level before,
+- all vertices of the open border and of the seam between the two meshes stay in each level,
+  and the seam is still the only place where both meshes meet,
+- no triangle of a level flips, its normal points to the side of the vertex normals,
+- the error of a level is not smaller than the error of the level before,
+- all levels use valid indices of the original vertex buffer.
+The two meshes have their own vertices along the seam, as the parser creates them for two materials.
+
+Returns 0 if all tests pass.
+
+Rafael Radkowski
+Iowa State University
+rafael@iastate.edu
+MIT License
+---------------------------------
+last edited:
+Oct 19, 2026, RR
+- Created.
+*/
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <set>
+#include <cmath>
+
+// glm
+#include <glm/glm.hpp>
+
+// local
+#include "MeshSimplifier.h"
+
+using namespace std;
+
+
+int num_failed = 0;
+
+
+void Fail(string name, string message)
+{
+	num_failed++;
+	cout << "[ERROR] - " << name << ": " << message << endl;
+}
+
+
+/*
+The fixture, a height field on a grid of G x G quads. The left half is mesh 0, the right half is mesh 1.
+*/
+typedef struct _Grid {
+	int G;
+	vector<pair<glm::vec3, glm::vec2> >		points;
+	vector<glm::vec3>						normals;
+	vector<int>								indices;
+	vector<cs557::OBJParser::OBJRange>		meshes;
+	set<pair<int, int> >					border; // grid coordinates of the border vertices
+	set<pair<int, int> >					seam; // grid coordinates of the seam vertices
+}Grid;
+
+
+glm::vec3 Position(int i, int j, int G)
+{
+	float x = 2.0f * i / G - 1.0f;
+	float y = 2.0f * j / G - 1.0f;
+	return glm::vec3(x, y, 0.2f * sin(3.0f * x) * cos(2.0f * y));
+}
+
+
+glm::vec3 Normal(int i, int j, int G)
+{
+	float x = 2.0f * i / G - 1.0f;
+	float y = 2.0f * j / G - 1.0f;
+	float dx = 0.6f * cos(3.0f * x) * cos(2.0f * y);
+	float dy = -0.4f * sin(3.0f * x) * sin(2.0f * y);
+	return glm::normalize(glm::vec3(-dx, -dy, 1.0f));
+}
+
+
+Grid CreateGrid(int G)
+{
+	Grid grid;
+	grid.G = G;
+
+	for (int m = 0; m < 2; m++) {
+		int i0 = m == 0 ? 0 : G / 2;
+		int i1 = m == 0 ? G / 2 : G;
+		int first = (int)grid.points.size();
+		int width = i1 - i0 + 1;
+
+		// the vertices of each mesh, the seam column exists in both meshes
+		for (int j = 0; j <= G; j++) {
+			for (int i = i0; i <= i1; i++) {
+				grid.points.push_back(make_pair(Position(i, j, G), glm::vec2(float(i) / G, float(j) / G)));
+				grid.normals.push_back(Normal(i, j, G));
+			}
+		}
+
+		cs557::OBJParser::OBJRange r;
+		r.name = m == 0 ? "left" : "right";
+		r.material.name = m == 0 ? "red" : "blue";
+		r.start = (int)grid.indices.size();
+		for (int j = 0; j < G; j++) {
+			for (int i = 0; i < width - 1; i++) {
+				int a = first + j * width + i;
+				int b = a + 1;
+				int c = a + width + 1;
+				int d = a + width;
+				grid.indices.insert(grid.indices.end(), { a, b, c, a, c, d });
+			}
+		}
+		r.count = (int)grid.indices.size() - r.start;
+		grid.meshes.push_back(r);
+	}
+
+	for (int k = 0; k <= G; k++) {
+		grid.border.insert(make_pair(k, 0));
+		grid.border.insert(make_pair(k, G));
+		grid.border.insert(make_pair(0, k));
+		grid.border.insert(make_pair(G, k));
+		grid.seam.insert(make_pair(G / 2, k));
+	}
+	return grid;
+}
+
+
+/*
+Return the grid coordinates of a vertex.
+*/
+pair<int, int> GridCoordinates(const Grid& grid, int vertex)
+{
+	glm::vec2 t = grid.points[vertex].second;
+	return make_pair((int)std::round(t.x * grid.G), (int)std::round(t.y * grid.G));
+}
+
+
+/*
+Check one level.
+@return - the number of triangles of the level.
+*/
+int CheckLevel(string name, const Grid& grid, const vector<int>& indices, const cs557::MeshSimplifier::LOD& lod)
+{
+	int N = (int)grid.points.size();
+	int triangles = 0;
+	int flipped = 0;
+	set<pair<int, int> > used;
+	set<pair<int, int> > used_by[2];
+
+	if (lod.start.size() != grid.meshes.size() || lod.count.size() != grid.meshes.size()) {
+		Fail(name, "the level has " + to_string(lod.start.size()) + " meshes, expected " + to_string(grid.meshes.size()) + ".");
+		return 0;
+	}
+
+	for (int m = 0; m < (int)grid.meshes.size(); m++) {
+		if (lod.start[m] < 0 || lod.count[m] < 0 || lod.count[m] % 3 != 0 || lod.start[m] + lod.count[m] > (int)indices.size()) {
+			Fail(name, "the range of mesh " + to_string(m) + " is invalid.");
+			return 0;
+		}
+		for (int i = lod.start[m]; i < lod.start[m] + lod.count[m]; i += 3) {
+			int v[3] = { indices[i], indices[i + 1], indices[i + 2] };
+			if (v[0] < 0 || v[0] >= N || v[1] < 0 || v[1] >= N || v[2] < 0 || v[2] >= N) {
+				Fail(name, "index out of range.");
+				return 0;
+			}
+			glm::vec3 a = grid.points[v[0]].first;
+			glm::vec3 b = grid.points[v[1]].first;
+			glm::vec3 c = grid.points[v[2]].first;
+			glm::vec3 n = glm::cross(b - a, c - a);
+			if (glm::dot(n, grid.normals[v[0]] + grid.normals[v[1]] + grid.normals[v[2]]) <= 0.0f) flipped++;
+
+			for (int k = 0; k < 3; k++) {
+				used.insert(GridCoordinates(grid, v[k]));
+				used_by[m].insert(GridCoordinates(grid, v[k]));
+			}
+			triangles++;
+		}
+	}
+
+	if (flipped > 0) Fail(name, to_string(flipped) + " triangles are flipped.");
+
+	int missing = 0;
+	for (auto& p : grid.border) {
+		if (used.find(p) == used.end()) missing++;
+	}
+	if (missing > 0) Fail(name, to_string(missing) + " border vertices were removed.");
+
+	// both meshes meet exactly at the seam
+	set<pair<int, int> > shared;
+	for (auto& p : used_by[0]) {
+		if (used_by[1].find(p) != used_by[1].end()) shared.insert(p);
+	}
+	if (shared != grid.seam) Fail(name, "the meshes share " + to_string(shared.size()) + " vertices, the seam has " + to_string(grid.seam.size()) + ".");
+
+	return triangles;
+}
+
+
+int main(int argc, char** argv)
+{
+	Grid grid = CreateGrid(64);
+	vector<int> indices = grid.indices;
+	vector<cs557::MeshSimplifier::LOD> lods;
+
+	cs557::MeshSimplifier::BuildLODs(grid.points, grid.normals, indices, grid.meshes, lods, 100, 0.25f, 5);
+
+	if (lods.size() < 3) {
+		Fail("levels", "BuildLODs() created " + to_string(lods.size()) + " levels, expected at least 3.");
+	}
+
+	// level 0 is the original mesh
+	int before = 0;
+	for (int k = 0; k < (int)lods.size(); k++) {
+		string name = "level " + to_string(k);
+		int triangles = CheckLevel(name, grid, indices, lods[k]);
+		cout << "[INFO] - " << name << ": " << triangles << " triangles, error " << lods[k].error << "." << endl;
+
+		if (k == 0) {
+			if (triangles != (int)grid.indices.size() / 3) Fail(name, "the original mesh has " + to_string(triangles) + " triangles.");
+			if (lods[k].error != 0.0f) Fail(name, "the error of the original mesh is " + to_string(lods[k].error) + ".");
+		}
+		else {
+			if (triangles >= before) Fail(name, "the level has " + to_string(triangles) + " triangles, the level before has " + to_string(before) + ".");
+			if (lods[k].error < lods[k - 1].error) Fail(name, "the error " + to_string(lods[k].error) + " is smaller than the error of the level before.");
+		}
+		before = triangles;
+	}
+
+	if (num_failed > 0) {
+		cout << "[ERROR] - MeshSimplifierTest: " << num_failed << " tests failed." << endl;
+		return 1;
+	}
+	cout << "[INFO] - MeshSimplifierTest: all tests passed." << endl;
+	return 0;
+}
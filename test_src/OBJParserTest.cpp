@@ -0,0 +1,312 @@
+/*
+Test for cs557::OBJParser
+
+The test writes two fixture files, parses them with cs557::OBJParser, and compares the result
+with objl::Loader (OBJLoader.h), mesh by mesh:
+- the number of triangles and their total area,
+- every corner (position, texture coordinate, normal) of one loader is a corner of the other loader,
+- the material of each mesh.
+objl::Loader computes the normal of a face without vn with the opposite sign and does not normalize it,
+thus, normals are compared by their direction only.
+
+The small fixture has negative indices, a concave quad, faces without vt or vn, and usemtl switches.
+The concave quad has its reflex corner at the second position. A fan from the first corner is wrong,
+but the fixed diagonal of objl::Loader is correct.
+The large fixture is larger than 4 MB, so the parser splits it into two chunks. One face starts before
+and ends after the split position, and a face in the second chunk uses negative indices of
+vertices in the first chunk.
+
+Returns 0 if all tests pass.
+
+Rafael Radkowski
+Iowa State University
+rafael@iastate.edu
+MIT License
+---------------------------------
+last edited:
+Oct 19, 2026, RR
+- Created.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cmath>
+
+// glm
+#include <glm/glm.hpp>
+
+// local
+#include "OBJParser.h"
+#include "OBJLoader.h"
+
+using namespace std;
+
+
+int num_failed = 0;
+
+
+void Fail(string name, string message)
+{
+	num_failed++;
+	cout << "[ERROR] - " << name << ": " << message << endl;
+}
+
+
+/*
+A triangle corner of either loader.
+*/
+typedef struct _Corner {
+	glm::vec3 p;
+	glm::vec2 t;
+	glm::vec3 n;
+}Corner;
+
+
+bool SameCorner(const Corner& a, const Corner& b)
+{
+	const float eps = 1e-5f;
+	if (glm::length(a.p - b.p) > eps) return false;
+	if (std::fabs(a.t.x - b.t.x) > eps || std::fabs(a.t.y - b.t.y) > eps) return false;
+
+	float la = glm::length(a.n);
+	float lb = glm::length(b.n);
+	if (la < eps || lb < eps) return false;
+	return std::fabs(glm::dot(a.n, b.n) / (la * lb)) > 0.999f;
+}
+
+
+float Area(const Corner& a, const Corner& b, const Corner& c)
+{
+	return 0.5f * glm::length(glm::cross(b.p - a.p, c.p - a.p));
+}
+
+
+/*
+Every corner of a must be a corner of b.
+*/
+bool Contains(const vector<Corner>& b, const vector<Corner>& a)
+{
+	for (auto& x : a) {
+		bool found = false;
+		for (auto& y : b) {
+			if (SameCorner(x, y)) { found = true; break; }
+		}
+		if (!found) return false;
+	}
+	return true;
+}
+
+
+/*
+Parse a file with both loaders and compare the meshes.
+@param name - the name of the test case.
+@param file - the obj file.
+@param num_threads - threads for cs557::OBJParser::Parse().
+*/
+void Compare(string name, string file, int num_threads)
+{
+	cs557::OBJParser::OBJData data;
+	if (!cs557::OBJParser::Parse(file, data, num_threads)) {
+		Fail(name, "OBJParser::Parse() failed.");
+		return;
+	}
+
+	objl::Loader loader;
+	if (!loader.LoadFile(file)) {
+		Fail(name, "objl::Loader::LoadFile() failed.");
+		return;
+	}
+
+	if (data.meshes.size() != loader.LoadedMeshes.size()) {
+		Fail(name, "OBJParser has " + to_string(data.meshes.size()) + " meshes, objl::Loader has " + to_string(loader.LoadedMeshes.size()) + ".");
+		return;
+	}
+
+	for (int i = 0; i < data.meshes.size(); i++) {
+		const cs557::OBJParser::OBJRange& r = data.meshes[i];
+		const objl::Mesh& m = loader.LoadedMeshes[i];
+		string mesh_name = name + ", mesh " + to_string(i);
+
+		vector<Corner> a, b;
+		float area_a = 0.0f, area_b = 0.0f;
+		bool winding = true;
+
+		for (int j = r.start; j < r.start + r.count; j++) {
+			int k = data.indices[j];
+			a.push_back({ data.positions[k], data.texcoords[k], data.normals[k] });
+		}
+		for (int j = 0; j + 2 < a.size(); j += 3) {
+			area_a += Area(a[j], a[j + 1], a[j + 2]);
+			// the triangles keep the orientation of the face
+			glm::vec3 n = glm::cross(a[j + 1].p - a[j].p, a[j + 2].p - a[j].p);
+			if (glm::dot(n, a[j].n) <= 0.0f) winding = false;
+		}
+
+		for (auto k : m.Indices) {
+			const objl::Vertex& v = m.Vertices[k];
+			b.push_back({ glm::vec3(v.Position.X, v.Position.Y, v.Position.Z), glm::vec2(v.TextureCoordinate.X, v.TextureCoordinate.Y),
+				glm::vec3(v.Normal.X, v.Normal.Y, v.Normal.Z) });
+		}
+		for (int j = 0; j + 2 < b.size(); j += 3) {
+			area_b += Area(b[j], b[j + 1], b[j + 2]);
+		}
+
+		if (a.size() != b.size()) {
+			Fail(mesh_name, "OBJParser has " + to_string(a.size() / 3) + " triangles, objl::Loader has " + to_string(b.size() / 3) + ".");
+			continue;
+		}
+		if (std::fabs(area_a - area_b) > 1e-4f) {
+			Fail(mesh_name, "the area is " + to_string(area_a) + ", objl::Loader has " + to_string(area_b) + ".");
+		}
+		if (!winding) {
+			Fail(mesh_name, "a triangle is flipped.");
+		}
+		if (!Contains(b, a) || !Contains(a, b)) {
+			Fail(mesh_name, "the corners differ.");
+		}
+		if (r.material.name != m.MeshMaterial.name || r.material.Kd.X != m.MeshMaterial.Kd.X ||
+			r.material.Kd.Y != m.MeshMaterial.Kd.Y || r.material.Kd.Z != m.MeshMaterial.Kd.Z) {
+			Fail(mesh_name, "the material is " + r.material.name + ", objl::Loader has " + m.MeshMaterial.name + ".");
+		}
+	}
+}
+
+
+/*
+Write the small fixture and its material file.
+*/
+void WriteSmall(string file, string mtl)
+{
+	ofstream out(mtl);
+	out << "newmtl red\n"
+		"Kd 1.0 0.0 0.0\n"
+		"newmtl blue\n"
+		"Kd 0.0 0.0 1.0\n";
+	out.close();
+
+	out.open(file);
+	out << "# OBJParserTest fixture\n"
+		"mtllib " << mtl << "\n"
+		"o triangles\n"
+		"usemtl red\n"
+		"v 0 0 0\n"
+		"v 1 0 0\n"
+		"v 1 1 0\n"
+		"v 0 1 0\n"
+		"vt 0 0\n"
+		"vt 1 0\n"
+		"vt 1 1\n"
+		"vt 0 1\n"
+		"vn 0 0 1\n"
+		"f 1/1/1 2/2/1 3/3/1\n"
+		"f -4/-4/-1 -2/-2/-1 -1/-1/-1\n" // negative indices, 1 3 4
+		"usemtl blue\n"
+		"f 1//1 2//1 3//1\n" // no vt
+		"f 1/1 3/3 4/4\n" // no vn
+		"f 1 2 4\n" // no vt and no vn
+		"o concave\n"
+		"usemtl red\n"
+		"v 3 0 0\n"
+		"v 4 1 0\n" // reflex corner
+		"v 5 0 0\n"
+		"v 4 3 0\n"
+		"vt 0 0\n"
+		"vt 0.5 0.3\n"
+		"vt 1 0\n"
+		"vt 0.5 1\n"
+		"f -4/-4/1 -3/-3/1 -2/-2/1 -1/-1/1\n"
+		"f 5/5 6/6 7/7 8/8\n"; // the same quad without vn
+	out.close();
+}
+
+
+/*
+Write the large fixture.
+A face line starts 16 bytes before the middle of the file, where the parser splits a file of this size with one thread.
+@return - the size of the file.
+*/
+size_t WriteLarge(string file)
+{
+	const size_t size = 6 << 20; // two chunks of about 4 MB
+	const string padding = "# padding padding padding padding padding padding padding padding padding\n";
+
+	ostringstream head;
+	head << "o large\n"
+		"v 0 0 0\n"
+		"v 1 0 0\n"
+		"v 1 1 0\n"
+		"v 0 1 0\n"
+		"v 0.5 1.5 0\n"
+		"vt 0 0\n"
+		"vt 1 0\n"
+		"vt 1 1\n"
+		"vt 0 1\n"
+		"vt 0.5 1.5\n"
+		"vn 0 0 1\n"
+		"f 1/1/1 2/2/1 3/3/1\n";
+
+	// the face across the split, negative indices
+	const string face = "f -5/-5/-1 -4/-4/-1 -3/-3/-1 -1/-1/-1 -2/-2/-1\n";
+
+	// the second chunk, a face with negative indices of the first chunk
+	ostringstream tail;
+	tail << "v 2 0 0\n"
+		"v 2 1 0\n"
+		"vt 0 0.5\n"
+		"f -6/-6/1 -1/-1/1 -5/-5/1\n" // 2 7 3
+		"f 6/6/1 7/6/1 3/3/1\n";
+
+	string out = head.str();
+	size_t face_begin = size / 2 - 16;
+	while (out.size() + padding.size() < face_begin) out += padding;
+	out += string(face_begin - out.size() - 1, '#') + "\n";
+	out += face;
+
+	string rest = tail.str();
+	while (out.size() + padding.size() + rest.size() < size) out += padding;
+	out += string(size - out.size() - rest.size() - 1, '#') + "\n";
+	out += rest;
+
+	ofstream f(file, std::ios::binary);
+	f << out;
+	return out.size();
+}
+
+
+int main(int argc, char** argv)
+{
+	WriteSmall("OBJParserTest.obj", "OBJParserTest.mtl");
+	Compare("small", "OBJParserTest.obj", 1);
+
+	// the concave quad has the area 2, a fan would give both quads an area of 8 
+	{
+		cs557::OBJParser::OBJData data;
+		cs557::OBJParser::Parse("OBJParserTest.obj", data, 1);
+		float area = 0.0f;
+		if (data.meshes.size() == 3) {
+			const cs557::OBJParser::OBJRange& r = data.meshes[2];
+			for (int j = r.start; j < r.start + r.count; j += 3) {
+				glm::vec3 a = data.positions[data.indices[j]];
+				glm::vec3 b = data.positions[data.indices[j + 1]];
+				glm::vec3 c = data.positions[data.indices[j + 2]];
+				area += 0.5f * glm::length(glm::cross(b - a, c - a));
+			}
+		}
+		if (std::fabs(area - 4.0f) > 1e-5f) Fail("concave quad", "the area is " + to_string(area) + ", expected 4.");
+	}
+
+	size_t size = WriteLarge("OBJParserTestLarge.obj");
+	if (size != 6 << 20) Fail("large", "the fixture has " + to_string(size) + " bytes.");
+	Compare("large", "OBJParserTestLarge.obj", 1);
+	Compare("large, parallel", "OBJParserTestLarge.obj", 0);
+
+	if (num_failed > 0) {
+		cout << "[ERROR] - OBJParserTest: " << num_failed << " tests failed." << endl;
+		return 1;
+	}
+	cout << "[INFO] - OBJParserTest: all tests passed." << endl;
+	return 0;
+}
@@ -0,0 +1,193 @@
+/*
+Test for RoIDetect::ExtractFromMask()
+
+The test compares the roi of ExtractFromMask() with the bounding box of all object pixels
+and with the roi of the pixel scan RoIDetect::Extract() on the same shapes: an empty image, 
+a one-pixel object, objects that touch the image border, an instance id image (CV_16UC1), 
+and 300 random ellipses.
+ExtractFromMask() must match the bounding box exactly. The scan agrees within one pixel for 
+objects without isolated pixels. It ignores a pixel whose left neighbor is zero when it
+looks for the right and the bottom end, so its roi can be smaller at the tips of an ellipse. 
+
+Returns 0 if all tests pass.
+
+Rafael Radkowski
+Iowa State University
+rafael@iastate.edu
+MIT License
+---------------------------------
+last edited:
+Oct 19, 2026, RR
+- Created.
+*/
+
+#include <iostream>
+#include <string>
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+// opencv
+#include <opencv2/opencv.hpp>
+
+// local
+#include "RoIDetect.h"
+
+using namespace std;
+
+
+int num_failed = 0;
+
+
+/*
+Compare two rois.
+@param name - the name of the test case.
+@param a - the roi of ExtractFromMask().
+@param b - the roi of Extract().
+@param tolerance - max. difference per value in pixels.
+*/
+void Compare(string name, cv::Rect2f a, cv::Rect2f b, float tolerance)
+{
+	bool ok = std::fabs(a.x - b.x) <= tolerance && std::fabs(a.y - b.y) <= tolerance &&
+		std::fabs(a.width - b.width) <= tolerance && std::fabs(a.height - b.height) <= tolerance;
+
+	if (!ok) {
+		num_failed++;
+		cout << "[ERROR] - " << name << ": mask roi (" << a.x << ", " << a.y << ", " << a.width << ", " << a.height <<
+			") != scan roi (" << b.x << ", " << b.y << ", " << b.width << ", " << b.height << ")." << endl;
+	}
+}
+
+
+/*
+The bounding box of all pixels > 0, with the size convention of Extract().
+@param mask - CV_8UC1 mask.
+*/
+cv::Rect2f BoundingBox(const cv::Mat& mask)
+{
+	int x0 = mask.cols, y0 = mask.rows, x1 = -1, y1 = -1;
+	for (int i = 0; i < mask.rows; i++) {
+		for (int j = 0; j < mask.cols; j++) {
+			if (mask.at<unsigned char>(i, j) == 0) continue;
+			x0 = (std::min)(x0, j);
+			y0 = (std::min)(y0, i);
+			x1 = (std::max)(x1, j);
+			y1 = (std::max)(y1, i);
+		}
+	}
+	if (x1 < 0) return cv::Rect2f((float)mask.cols, (float)mask.rows, 1.0f, 1.0f);
+	return cv::Rect2f((float)x0, (float)y0, (float)(std::max)(1, x1 - x0), (float)(std::max)(1, y1 - y0));
+}
+
+
+/*
+Run both functions on a mask and on a color image with the same object pixels.
+@param name - the name of the test case.
+@param mask - CV_8UC1 mask, object pixels > 0.
+@param tolerance - max. difference per value in pixels between both functions.
+@param scan_inside - only check that the scan roi lies inside the mask roi.
+*/
+void Run(string name, const cv::Mat& mask, float tolerance, bool scan_inside = false)
+{
+	cv::Mat color = cv::Mat::zeros(mask.rows, mask.cols, CV_8UC3);
+	color.setTo(cv::Scalar(40, 80, 120), mask);
+
+	cv::Rect2f roi_mask, roi_scan;
+	if (!RoIDetect::ExtractFromMask(mask, roi_mask)) {
+		num_failed++;
+		cout << "[ERROR] - " << name << ": ExtractFromMask() failed." << endl;
+		return;
+	}
+	RoIDetect::Extract(color, roi_scan);
+
+	Compare(name + ", bounding box", roi_mask, BoundingBox(mask), 0.0f);
+
+	if (!scan_inside) {
+		Compare(name, roi_mask, roi_scan, tolerance);
+	}
+	else if (roi_scan.x < roi_mask.x || roi_scan.y < roi_mask.y ||
+		roi_scan.x + roi_scan.width > roi_mask.x + roi_mask.width + tolerance ||
+		roi_scan.y + roi_scan.height > roi_mask.y + roi_mask.height + tolerance) {
+		Compare(name + ", inside", roi_mask, roi_scan, tolerance);
+	}
+}
+
+
+int main(int argc, char** argv)
+{
+	const int rows = 120;
+	const int cols = 160;
+
+	// empty image, the roi is (cols, rows, 1, 1)
+	{
+		cv::Mat mask = cv::Mat::zeros(rows, cols, CV_8UC1);
+		cv::Rect2f roi;
+		RoIDetect::ExtractFromMask(mask, roi);
+		Compare("empty", roi, cv::Rect2f((float)cols, (float)rows, 1.0f, 1.0f), 0.0f);
+		Run("empty scan", mask, 0.0f);
+	}
+
+	// a one-pixel object
+	{
+		cv::Mat mask = cv::Mat::zeros(rows, cols, CV_8UC1);
+		mask.at<unsigned char>(37, 81) = 255;
+		cv::Rect2f roi;
+		RoIDetect::ExtractFromMask(mask, roi);
+		Compare("one pixel", roi, cv::Rect2f(81.0f, 37.0f, 1.0f, 1.0f), 0.0f);
+		Run("one pixel scan", mask, 0.0f);
+	}
+
+	// objects that touch the image border
+	{
+		cv::Mat mask = cv::Mat::zeros(rows, cols, CV_8UC1);
+		mask(cv::Rect(0, 0, 30, 20)) = 255;
+		Run("top left corner", mask, 1.0f);
+
+		mask = cv::Mat::zeros(rows, cols, CV_8UC1);
+		mask(cv::Rect(cols - 25, rows - 15, 25, 15)) = 255;
+		Run("bottom right corner", mask, 1.0f);
+
+		mask = cv::Mat::zeros(rows, cols, CV_8UC1);
+		mask(cv::Rect(0, 50, cols, 10)) = 255;
+		Run("full width", mask, 1.0f);
+
+		cv::Rect2f roi;
+		RoIDetect::ExtractFromMask(mask, roi);
+		Compare("full width exact", roi, cv::Rect2f(0.0f, 50.0f, (float)cols - 1.0f, 9.0f), 0.0f);
+	}
+
+	// an instance id image, the model has the id 1
+	{
+		cv::Mat ids = cv::Mat::zeros(rows, cols, CV_16UC1);
+		ids(cv::Rect(10, 20, 40, 30)) = 1;
+		ids(cv::Rect(100, 60, 30, 40)) = 300;
+
+		cv::Rect2f roi_all, roi_model;
+		RoIDetect::ExtractFromMask(ids, roi_all);
+		RoIDetect::ExtractFromMask(ids == 1, roi_model);
+		Compare("ids, all instances", roi_all, cv::Rect2f(10.0f, 20.0f, 119.0f, 79.0f), 0.0f);
+		Compare("ids, model", roi_model, cv::Rect2f(10.0f, 20.0f, 39.0f, 29.0f), 0.0f);
+
+		cv::Mat mask = ids > 0;
+		Run("ids scan", mask, 1.0f);
+	}
+
+	// random ellipses, the scan misses isolated pixels at the tips
+	{
+		std::mt19937 rng(1);
+		std::uniform_int_distribution<int> cx(0, cols - 1), cy(0, rows - 1), axis(1, 60), angle(0, 179);
+
+		for (int i = 0; i < 300; i++) {
+			cv::Mat mask = cv::Mat::zeros(rows, cols, CV_8UC1);
+			cv::ellipse(mask, cv::Point(cx(rng), cy(rng)), cv::Size(axis(rng), axis(rng)), angle(rng), 0, 360, cv::Scalar(255), -1);
+			Run("ellipse " + to_string(i), mask, 1.0f, true);
+		}
+	}
+
+	if (num_failed > 0) {
+		cout << "[ERROR] - RoIDetectTest: " << num_failed << " tests failed." << endl;
+		return 1;
+	}
+	cout << "[INFO] - RoIDetectTest: all tests passed." << endl;
+	return 0;
+}